@@ -0,0 +1,189 @@
+/**
+ * @file    src/common/bufferedfile.cpp
+ * @brief
+ *
+ * @addtogroup
+ * @{
+ */
+#include "bufferedfile.h"
+
+#include <string.h>
+
+namespace tmb_musicplayer {
+
+BufferedFile::BufferedFile(File* file) :
+        m_file(file) {
+}
+
+bool BufferedFile::Open(const char* path) {
+    InvalidateBuffer();
+    m_position = 0;
+    m_error = false;
+    return m_file->Open(path);
+}
+
+bool BufferedFile::Close() {
+    InvalidateBuffer();
+    return m_file->Close();
+}
+
+bool BufferedFile::Sync() {
+    return m_file->Sync();
+}
+
+bool BufferedFile::Create(const char* path) {
+    InvalidateBuffer();
+    m_position = 0;
+    m_error = false;
+    return m_file->Create(path);
+}
+
+uint32_t BufferedFile::GetString(char* buffer, uint32_t bufferSize) {
+    // same behaviour as f_gets, the line feed is kept
+    uint32_t chars = 0;
+    while ((chars + 1) < bufferSize) {
+        if (FillBuffer() == false) {
+            break;
+        }
+
+        const uint8_t* data = m_buffer + (m_position - m_bufferStart);
+        uint32_t available = m_bufferLength - (m_position - m_bufferStart);
+        if (available > (bufferSize - 1 - chars)) {
+            available = bufferSize - 1 - chars;
+        }
+
+        const uint8_t* lineEnd = (const uint8_t*)memchr(data, '\n', available);
+        if (lineEnd != NULL) {
+            available = lineEnd - data + 1;
+        }
+
+        memcpy(buffer + chars, data, available);
+        chars += available;
+        m_position += available;
+        if (lineEnd != NULL) {
+            break;
+        }
+    }
+
+    if (bufferSize > 0) {
+        buffer[chars] = 0;
+    }
+    return chars;
+}
+
+int32_t BufferedFile::WriteString(const char* str) {
+    InvalidateBuffer();
+    if (m_file->Seek(m_position) == false) {
+        return -1;
+    }
+    int32_t written = m_file->WriteString(str);
+    m_position = m_file->Tell();
+    return written;
+}
+
+int32_t BufferedFile::Read(void* buffer, uint32_t size) {
+    uint8_t* target = (uint8_t*)buffer;
+    uint32_t bytesRead = 0;
+    while (bytesRead < size) {
+        if (FillBuffer() == false) {
+            break;
+        }
+
+        uint32_t offset = m_position - m_bufferStart;
+        uint32_t available = m_bufferLength - offset;
+        if (available > (size - bytesRead)) {
+            available = size - bytesRead;
+        }
+        memcpy(target + bytesRead, m_buffer + offset, available);
+        bytesRead += available;
+        m_position += available;
+    }
+
+    if (m_error == true) {
+        return -1;
+    }
+    return bytesRead;
+}
+
+int32_t BufferedFile::Write(const void* data, uint32_t size) {
+    InvalidateBuffer();
+    if (m_file->Seek(m_position) == false) {
+        return -1;
+    }
+    int32_t written = m_file->Write(data, size);
+    if (written > 0) {
+        m_position += written;
+    }
+    return written;
+}
+
+int32_t BufferedFile::Tell() {
+    return m_position;
+}
+
+bool BufferedFile::Seek(int32_t pos) {
+    if ((pos < 0) || (pos > m_file->Size())) {
+        return false;
+    }
+    // the buffer stays valid, it is reloaded once the position leaves it
+    m_position = pos;
+    return true;
+}
+
+bool BufferedFile::Truncate() {
+    InvalidateBuffer();
+    return m_file->Seek(m_position) && m_file->Truncate();
+}
+
+int32_t BufferedFile::Size() {
+    return m_file->Size();
+}
+
+bool BufferedFile::Error() {
+    return m_error || m_file->Error();
+}
+
+bool BufferedFile::IsEOF() {
+    return m_position >= m_file->Size();
+}
+
+uint32_t BufferedFile::Timestamp() {
+    return m_file->Timestamp();
+}
+
+bool BufferedFile::FillBuffer() {
+    if ((m_position >= m_bufferStart) && ((uint32_t)(m_position - m_bufferStart) < m_bufferLength)) {
+        return true;
+    }
+
+    if (m_position >= m_file->Size()) {
+        return false;
+    }
+
+    // load the complete block containing the position
+    int32_t blockStart = m_position - (m_position % BlockSize);
+    InvalidateBuffer();
+    if (m_file->Seek(blockStart) == false) {
+        m_error = true;
+        return false;
+    }
+
+    int32_t bytesRead = m_file->Read(m_buffer, BlockSize);
+    if (bytesRead < 0) {
+        m_error = true;
+        return false;
+    }
+
+    m_bufferStart = blockStart;
+    m_bufferLength = bytesRead;
+    return (uint32_t)(m_position - m_bufferStart) < m_bufferLength;
+}
+
+void BufferedFile::InvalidateBuffer() {
+    m_bufferStart = 0;
+    m_bufferLength = 0;
+}
+
+}  // namespace tmb_musicplayer
+
+/** @} */
@@ -0,0 +1,63 @@
+/**
+ * @file    src/common/bufferedfile.h
+ *
+ * @brief Read buffer decorator for File
+ *
+ * @addtogroup
+ * @{
+ */
+
+#ifndef _BUFFEREDFILE_H_
+#define _BUFFEREDFILE_H_
+
+#include "file.h"
+#include <stdint.h>
+
+namespace tmb_musicplayer
+{
+
+/*
+ * Reads the decorated file in sector aligned blocks and serves GetString,
+ * Read, Tell and Seek from the block buffer. The buffer is only reloaded
+ * when the position leaves the buffered block. Writes go to the decorated
+ * file directly and drop the buffer.
+ */
+class BufferedFile : public File
+{
+public:
+    static const uint32_t BlockSize = 512;
+
+    explicit BufferedFile(File* file);
+
+    virtual bool Open(const char* path);
+    virtual bool Close();
+    virtual bool Sync();
+    virtual bool Create(const char* path);
+    virtual uint32_t GetString(char* buffer, uint32_t bufferSize);
+    virtual int32_t WriteString(const char* str);
+    virtual int32_t Read(void* buffer, uint32_t size);
+    virtual int32_t Write(const void* data, uint32_t size);
+    virtual int32_t Tell();
+    virtual bool Seek(int32_t pos);
+    virtual bool Truncate();
+    virtual int32_t Size();
+    virtual bool Error();
+    virtual bool IsEOF();
+    virtual uint32_t Timestamp();
+
+private:
+    bool FillBuffer();
+    void InvalidateBuffer();
+
+    File* m_file;
+    int32_t m_position = 0;
+    int32_t m_bufferStart = 0;
+    uint32_t m_bufferLength = 0;
+    bool m_error = false;
+    uint8_t m_buffer[BlockSize];
+};
+}
+
+#endif /* _BUFFEREDFILE_H_ */
+
+/** @} */
@@ -0,0 +1,132 @@
+/**
+ * @file    src/common/cardsensor.cpp
+ * @brief
+ *
+ * @addtogroup
+ * @{
+ */
+#include "cardsensor.h"
+
+#include <string.h>
+
+namespace tmb_musicplayer {
+
+CardSensor::CardSensor(MFRC522Port* port) :
+        m_port(port) {
+}
+
+void CardSensor::Init() {
+    m_port->WriteRegister(DivIEnReg, IRQPushPull);
+}
+
+bool CardSensor::RequestCard() {
+    uint8_t reqa = PICC_REQA;
+    uint8_t atqa[2];
+    // several cards answering at once end in a collision, but there is a
+    // card in any case
+    if (Transceive(&reqa, 1, ShortFrameBits, atqa, sizeof(atqa)) == 0) {
+        return false;
+    }
+
+    // a READY card ignores the REQA of the driver, HLTA sends it back to
+    // IDLE so the driver reads it with its first request
+    HaltCard();
+    return true;
+}
+
+void CardSensor::HaltCard() {
+    // HLTA with its CRC_A, the card does not answer
+    static const uint8_t hlta[] = {PICC_HLTA, 0x00, 0x57, 0xCD};
+    Transmit(hlta, sizeof(hlta));
+}
+
+bool CardSensor::CheckPresence(const uint8_t* uid, uint8_t size) {
+    uint8_t wupa = PICC_WUPA;
+    uint8_t atqa[2];
+    if (Transceive(&wupa, 1, ShortFrameBits, atqa, sizeof(atqa)) == 0) {
+        return false;
+    }
+
+    // the card is READY now, the first cascade level is enough to tell it
+    // apart from a card put on the reader in between
+    static const uint8_t anticoll[] = {PICC_ANTICOLL_CL1, 0x20};
+    uint8_t answer[5];
+    if (Transceive(anticoll, sizeof(anticoll), 0, answer, sizeof(answer)) != sizeof(answer)) {
+        return false;
+    }
+
+    uint8_t bcc = answer[0] ^ answer[1] ^ answer[2] ^ answer[3];
+    if (bcc != answer[4]) {
+        return false;
+    }
+
+    bool same;
+    if (size > 4) {
+        same = (answer[0] == CascadeTag) && (memcmp(&answer[1], uid, 3) == 0);
+    } else {
+        same = (size == 4) && (memcmp(answer, uid, 4) == 0);
+    }
+
+    // a READY card drops back to IDLE on HLTA, a different card is found
+    // by the next REQA
+    HaltCard();
+    return same;
+}
+
+uint8_t CardSensor::Transceive(const uint8_t* tx, uint8_t length, uint8_t bits,
+        uint8_t* rx, uint8_t rxSize) {
+    StartCommand(PCD_Transceive, RxIRq | TimerIRq, tx, length, bits);
+
+    m_port->WaitIRQ(RequestTimeout);
+
+    uint8_t received = 0;
+    if ((m_port->ReadRegister(ComIrqReg) & RxIRq) != 0) {
+        received = m_port->ReadRegister(FIFOLevelReg);
+        // anything answering counts, even if it does not fit
+        uint8_t count = (received < rxSize) ? received : rxSize;
+        for (uint8_t i = 0; i < count; ++i) {
+            rx[i] = m_port->ReadRegister(FIFODataReg);
+        }
+        if (received == 0) {
+            received = 1;
+        }
+    }
+
+    StopCommand();
+    return received;
+}
+
+void CardSensor::Transmit(const uint8_t* tx, uint8_t length) {
+    StartCommand(PCD_Transmit, IdleIRq, tx, length, 0);
+    m_port->WaitIRQ(RequestTimeout);
+    StopCommand();
+}
+
+void CardSensor::StartCommand(uint8_t command, uint8_t irqs, const uint8_t* tx,
+        uint8_t length, uint8_t bits) {
+    m_port->WriteRegister(CommandReg, PCD_Idle);
+    // the driver enables its own interrupts for every transceive, only
+    // wake up for the end of this command
+    m_port->WriteRegister(ComIEnReg, IRqInv | irqs);
+    m_port->WriteRegister(ComIrqReg, 0x7F);
+    m_port->WriteRegister(FIFOLevelReg, FlushBuffer);
+    for (uint8_t i = 0; i < length; ++i) {
+        m_port->WriteRegister(FIFODataReg, tx[i]);
+    }
+    m_port->WriteRegister(BitFramingReg, bits);
+
+    m_port->ClearIRQ();
+    m_port->WriteRegister(CommandReg, command);
+    if (command == PCD_Transceive) {
+        m_port->WriteRegister(BitFramingReg, StartSend | bits);
+    }
+}
+
+void CardSensor::StopCommand() {
+    m_port->WriteRegister(BitFramingReg, 0);
+    m_port->WriteRegister(CommandReg, PCD_Idle);
+    m_port->WriteRegister(ComIrqReg, 0x7F);
+}
+
+}
+/** @} */
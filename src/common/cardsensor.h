@@ -0,0 +1,141 @@
+/**
+ * @file    src/common/cardsensor.h
+ *
+ * @brief Cheap card presence requests on the MFRC522
+ *
+ * @addtogroup
+ * @{
+ */
+
+#ifndef _CARDSENSOR_H_
+#define _CARDSENSOR_H_
+
+#include <stdint.h>
+
+namespace tmb_musicplayer
+{
+
+/**
+ * @brief   Register access to the MFRC522 and its IRQ line.
+ */
+class MFRC522Port
+{
+public:
+    virtual ~MFRC522Port() {}
+
+    virtual void WriteRegister(uint8_t addr, uint8_t val) = 0;
+    virtual uint8_t ReadRegister(uint8_t addr) = 0;
+
+    /*
+     * Forgets IRQ edges signaled before a command is started.
+     */
+    virtual void ClearIRQ() = 0;
+
+    /*
+     * Blocks until the IRQ line is asserted or timeout milliseconds have
+     * passed, returns false on timeout.
+     */
+    virtual bool WaitIRQ(uint32_t timeout) = 0;
+};
+
+/**
+ * @brief   Cheap card requests below the full UID read of the driver.
+ * @details Every frame sleeps on the IRQ line until the card answers or
+ *          the wait times out, instead of polling ComIrqReg over SPI.
+ *          RequestCard() looks for a new card in the field. A card whose
+ *          UID was read is halted with HaltCard() and CheckPresence()
+ *          wakes it with a WUPA and compares the first cascade level of
+ *          its UID. The unselected card drops back to IDLE on the HLTA
+ *          that ends the check, so it is woken by the next WUPA but must
+ *          not be asked with REQA in between. A card which is new in the
+ *          field still has to be selected by the driver.
+ */
+class CardSensor
+{
+public:
+    enum Registers
+    {
+        CommandReg = 0x01,
+        ComIEnReg = 0x02,
+        DivIEnReg = 0x03,
+        ComIrqReg = 0x04,
+        FIFODataReg = 0x09,
+        FIFOLevelReg = 0x0A,
+        BitFramingReg = 0x0D,
+    };
+
+    enum Commands
+    {
+        PCD_Idle = 0x00,
+        PCD_Transmit = 0x04,
+        PCD_Transceive = 0x0C,
+    };
+
+    enum IrqBits
+    {
+        IRqInv = 0x80,
+        RxIRq = 0x20,
+        IdleIRq = 0x10,
+        ErrIRq = 0x02,
+        TimerIRq = 0x01,
+    };
+
+    static const uint8_t IRQPushPull = 0x80;
+    static const uint8_t FlushBuffer = 0x80;
+    static const uint8_t StartSend = 0x80;
+
+    static const uint8_t PICC_REQA = 0x26;
+    static const uint8_t PICC_WUPA = 0x52;
+    static const uint8_t PICC_ANTICOLL_CL1 = 0x93;
+    static const uint8_t PICC_HLTA = 0x50;
+    /* First byte of cascade level 1 for UIDs longer than 4 bytes.*/
+    static const uint8_t CascadeTag = 0x88;
+    /* Only seven bits of REQA and WUPA are sent.*/
+    static const uint8_t ShortFrameBits = 0x07;
+
+    /* The answer of a card follows within 100us, the MFRC522 timer set up
+     * by the driver would only expire after 25ms.*/
+    static const uint32_t RequestTimeout = 5;
+
+    explicit CardSensor(MFRC522Port* port);
+
+    /*
+     * Switches the IRQ pin to push pull, it is active low.
+     */
+    void Init();
+
+    /*
+     * Returns true if a card in the field answered a REQA, halted cards
+     * do not answer. The card is left IDLE for the driver.
+     */
+    bool RequestCard();
+
+    /*
+     * Sends HLTA to the card, it only answers a WUPA afterwards.
+     */
+    void HaltCard();
+
+    /*
+     * Returns true if the card with the given UID is still in the field.
+     */
+    bool CheckPresence(const uint8_t* uid, uint8_t size);
+
+private:
+    /*
+     * Sends length bytes, the last one with bits valid bits (0 for all),
+     * and returns the number of bytes answered, at most rxSize are read.
+     */
+    uint8_t Transceive(const uint8_t* tx, uint8_t length, uint8_t bits,
+            uint8_t* rx, uint8_t rxSize);
+    void Transmit(const uint8_t* tx, uint8_t length);
+    void StartCommand(uint8_t command, uint8_t irqs, const uint8_t* tx,
+            uint8_t length, uint8_t bits);
+    void StopCommand();
+
+    MFRC522Port* m_port;
+};
+}
+
+#endif /* _CARDSENSOR_H_ */
+
+/** @} */
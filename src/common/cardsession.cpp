@@ -0,0 +1,90 @@
+/**
+ * @file    src/common/cardsession.cpp
+ * @brief
+ *
+ * @addtogroup
+ * @{
+ */
+#include "cardsession.h"
+
+#include <string.h>
+
+namespace tmb_musicplayer {
+
+CardSession::CardSession() :
+        m_gracePeriod(0),
+        m_active(false),
+        m_lost(false),
+        m_lostAt(0) {
+    m_uid[0] = 0;
+}
+
+void CardSession::SetGracePeriod(uint32_t ticks) {
+    m_gracePeriod = ticks;
+}
+
+CardSession::Action CardSession::CardDetected(const char* uid, uint32_t now) {
+    (void)now;
+    bool same = m_active && (strncmp(m_uid, uid, sizeof(m_uid)) == 0);
+
+    m_lost = false;
+    if (same) {
+        return Continue;
+    }
+
+    m_active = true;
+    strncpy(m_uid, uid, sizeof(m_uid) - 1);
+    m_uid[sizeof(m_uid) - 1] = 0;
+    return Start;
+}
+
+CardSession::Action CardSession::CardLost(uint32_t now) {
+    if (m_active == false || m_lost == true) {
+        return None;
+    }
+
+    if (m_gracePeriod == 0) {
+        Reset();
+        return Stop;
+    }
+
+    m_lost = true;
+    m_lostAt = now;
+    return None;
+}
+
+CardSession::Action CardSession::Update(uint32_t now) {
+    if (m_lost == false) {
+        return None;
+    }
+
+    if ((now - m_lostAt) < m_gracePeriod) {
+        return None;
+    }
+
+    Reset();
+    return Stop;
+}
+
+uint32_t CardSession::TimeUntilStop(uint32_t now, uint32_t max) const {
+    if (m_lost == false) {
+        return max;
+    }
+
+    uint32_t elapsed = now - m_lostAt;
+    if (elapsed >= m_gracePeriod) {
+        return 0;
+    }
+
+    uint32_t remaining = m_gracePeriod - elapsed;
+    return (remaining < max) ? remaining : max;
+}
+
+void CardSession::Reset() {
+    m_active = false;
+    m_lost = false;
+    m_uid[0] = 0;
+}
+
+}
+/** @} */
@@ -0,0 +1,83 @@
+/**
+ * @file    src/common/cardsession.h
+ *
+ * @brief Playback session of the card on the reader
+ *
+ * @addtogroup
+ * @{
+ */
+
+#ifndef _CARDSESSION_H_
+#define _CARDSESSION_H_
+
+#include <stdint.h>
+
+namespace tmb_musicplayer
+{
+
+/**
+ * @brief   Decides what a detected or lost card means for playback.
+ * @details A lost card does not end the session at once, it is kept for
+ *          a grace period to ride out RF dropouts of a wobbly card. If
+ *          the same UID shows up again in time the session continues,
+ *          otherwise Update() asks to stop once the period is over.
+ *          Times are system ticks, wrap around is handled.
+ */
+class CardSession
+{
+public:
+    static const uint32_t MaxUIDLength = 32;
+
+    enum Action
+    {
+        None,
+        /* A new card, load its playlist.*/
+        Start,
+        /* The lost card is back, nothing to load.*/
+        Continue,
+        /* The card is gone for good, stop playback.*/
+        Stop,
+    };
+
+    CardSession();
+
+    void SetGracePeriod(uint32_t ticks);
+
+    Action CardDetected(const char* uid, uint32_t now);
+    Action CardLost(uint32_t now);
+
+    /*
+     * Returns Stop once when the grace period of a lost card is over.
+     */
+    Action Update(uint32_t now);
+
+    /*
+     * Ticks until Update() stops the session, max if no card is lost.
+     */
+    uint32_t TimeUntilStop(uint32_t now, uint32_t max) const;
+
+    /*
+     * Forgets the session without a Stop, the next card starts again.
+     */
+    void Reset();
+
+    bool IsActive() const {
+        return m_active;
+    }
+
+    bool IsLost() const {
+        return m_lost;
+    }
+
+private:
+    uint32_t m_gracePeriod;
+    bool m_active;
+    bool m_lost;
+    uint32_t m_lostAt;
+    char m_uid[MaxUIDLength];
+};
+}
+
+#endif /* _CARDSESSION_H_ */
+
+/** @} */
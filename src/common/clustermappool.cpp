@@ -0,0 +1,103 @@
+/**
+ * @file    src/common/clustermappool.cpp
+ * @brief
+ *
+ * @addtogroup
+ * @{
+ */
+#include "clustermappool.h"
+
+#include <stddef.h>
+
+namespace tmb_musicplayer {
+
+ClusterMapPool::ClusterMapPool(uint32_t* words, uint32_t size) :
+        m_words(words),
+        m_size(size) {
+}
+
+uint32_t* ClusterMapPool::Allocate(uint32_t size) {
+    uint32_t index;
+    if ((size == 0) || (m_blockCount >= MaxBlocks)) {
+        return NULL;
+    }
+
+    /* First fit, the gap before block index starts at offset.*/
+    uint32_t offset = 0;
+    for (index = 0; index <= m_blockCount; index++) {
+        uint32_t end = (index < m_blockCount) ? m_blocks[index].offset : m_size;
+        if ((end - offset) >= size) {
+            break;
+        }
+        if (index < m_blockCount) {
+            offset = m_blocks[index].offset + m_blocks[index].size;
+        }
+    }
+    if (index > m_blockCount) {
+        return NULL;
+    }
+
+    for (uint32_t i = m_blockCount; i > index; i--) {
+        m_blocks[i] = m_blocks[i - 1];
+    }
+    m_blocks[index].offset = offset;
+    m_blocks[index].size = size;
+    m_blockCount++;
+    return &m_words[offset];
+}
+
+uint32_t* ClusterMapPool::AllocateLargest(uint32_t& size) {
+    size = LargestFree();
+    return Allocate(size);
+}
+
+void ClusterMapPool::Shrink(uint32_t* block, uint32_t size) {
+    int32_t index = FindBlock(block);
+    if ((index >= 0) && (size > 0) && (size < m_blocks[index].size)) {
+        m_blocks[index].size = size;
+    }
+}
+
+void ClusterMapPool::Release(uint32_t* block) {
+    int32_t index = FindBlock(block);
+    if (index < 0) {
+        return;
+    }
+
+    m_blockCount--;
+    for (uint32_t i = index; i < m_blockCount; i++) {
+        m_blocks[i] = m_blocks[i + 1];
+    }
+}
+
+uint32_t ClusterMapPool::LargestFree() const {
+    if (m_blockCount >= MaxBlocks) {
+        return 0;
+    }
+
+    uint32_t largest = 0;
+    uint32_t offset = 0;
+    for (uint32_t index = 0; index <= m_blockCount; index++) {
+        uint32_t end = (index < m_blockCount) ? m_blocks[index].offset : m_size;
+        if ((end - offset) > largest) {
+            largest = end - offset;
+        }
+        if (index < m_blockCount) {
+            offset = m_blocks[index].offset + m_blocks[index].size;
+        }
+    }
+    return largest;
+}
+
+int32_t ClusterMapPool::FindBlock(const uint32_t* block) const {
+    for (uint32_t index = 0; index < m_blockCount; index++) {
+        if (&m_words[m_blocks[index].offset] == block) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+}
+
+/** @} */
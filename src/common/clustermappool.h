@@ -0,0 +1,62 @@
+/**
+ * @file    src/common/clustermappool.h
+ *
+ * @brief Static pool for FatFs cluster link map tables
+ *
+ * @addtogroup
+ * @{
+ */
+
+#ifndef _CLUSTERMAPPOOL_H_
+#define _CLUSTERMAPPOOL_H_
+
+#include <stdint.h>
+
+namespace tmb_musicplayer
+{
+
+/**
+ * @brief   Hands out word blocks of a static buffer for the fast seek
+ *          cluster link map of open files.
+ * @details The size a map needs is only known after it was built, so a
+ *          file gets the largest free block first and gives back the unused
+ *          tail with Shrink(). Only a few files are open at a time, blocks
+ *          are kept in a short list sorted by their position in the buffer.
+ */
+class ClusterMapPool
+{
+public:
+    static const uint32_t MaxBlocks = 4;
+
+    ClusterMapPool(uint32_t* words, uint32_t size);
+
+    uint32_t* Allocate(uint32_t size);
+    uint32_t* AllocateLargest(uint32_t& size);
+    void Shrink(uint32_t* block, uint32_t size);
+    void Release(uint32_t* block);
+
+    uint32_t LargestFree() const;
+    uint32_t BlockCount() const {
+        return m_blockCount;
+    }
+
+private:
+    struct Block
+    {
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    int32_t FindBlock(const uint32_t* block) const;
+
+    uint32_t* m_words;
+    uint32_t m_size;
+    Block m_blocks[MaxBlocks];
+    uint32_t m_blockCount = 0;
+};
+
+}
+
+#endif /* _CLUSTERMAPPOOL_H_ */
+
+/** @} */
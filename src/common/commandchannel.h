@@ -0,0 +1,142 @@
+/**
+ * @file    src/common/commandchannel.h
+ *
+ * @brief Coalescing command channel between a controller and the player
+ *
+ * @addtogroup
+ * @{
+ */
+
+#ifndef _COMMANDCHANNEL_H_
+#define _COMMANDCHANNEL_H_
+
+#include <stdint.h>
+
+namespace tmb_musicplayer
+{
+
+/*
+ * A title is referenced by the handle of the playlist it belongs to and its
+ * index in there, the path is only looked up when the title is started.
+ */
+struct PlayTarget {
+    uint32_t playlist;
+    int32_t index;
+    uint32_t offset;
+    uint16_t decodeTime;
+};
+
+/*
+ * Translates a play target into a path, fails if the playlist is not the
+ * loaded one anymore.
+ */
+class TitleResolver
+{
+public:
+    virtual bool ResolveTitle(uint32_t playlist, int32_t index, char* buffer, uint32_t bufferSize) = 0;
+
+protected:
+    ~TitleResolver() {
+    }
+};
+
+struct CommandStats {
+    uint32_t posted;
+    uint32_t coalesced;
+    uint32_t dropped;
+};
+
+/**
+ * @brief   One slot per command class, the latest command of a class wins.
+ * @details Posting never blocks and never fails, a command that was not
+ *          fetched yet is replaced and counted as coalesced. Starting a
+ *          title also discards a pending queued title, which belonged to
+ *          the replaced one. Commands the consumer can not execute are
+ *          reported with Drop(). Lock has to provide lock() and unlock().
+ */
+template <typename Lock>
+class CommandChannel
+{
+public:
+    enum Commands
+    {
+        CommandPlay = 1 << 0,
+        CommandNext = 1 << 1,
+        CommandVolume = 1 << 2,
+    };
+
+    CommandChannel() {
+    }
+
+    void PostPlay(const PlayTarget& target) {
+        m_lock.lock();
+        Replace(CommandPlay);
+        if (m_pending & CommandNext) {
+            m_pending &= ~CommandNext;
+            m_stats.coalesced++;
+        }
+        m_play = target;
+        m_lock.unlock();
+    }
+
+    /* A negative index removes the queued title.*/
+    void PostNext(const PlayTarget& target) {
+        m_lock.lock();
+        Replace(CommandNext);
+        m_next = target;
+        m_lock.unlock();
+    }
+
+    void PostVolume(uint8_t volume) {
+        m_lock.lock();
+        Replace(CommandVolume);
+        m_volume = volume;
+        m_lock.unlock();
+    }
+
+    /* Takes all pending commands, returns their Commands mask.*/
+    uint32_t Fetch(PlayTarget& play, PlayTarget& next, uint8_t& volume) {
+        m_lock.lock();
+        uint32_t pending = m_pending;
+        m_pending = 0;
+        play = m_play;
+        next = m_next;
+        volume = m_volume;
+        m_lock.unlock();
+        return pending;
+    }
+
+    void Drop() {
+        m_lock.lock();
+        m_stats.dropped++;
+        m_lock.unlock();
+    }
+
+    void ReadStats(CommandStats& stats) {
+        m_lock.lock();
+        stats = m_stats;
+        m_lock.unlock();
+    }
+
+private:
+    void Replace(uint32_t command) {
+        if (m_pending & command) {
+            m_stats.coalesced++;
+        }
+        m_pending |= command;
+        m_stats.posted++;
+    }
+
+    Lock m_lock;
+    uint32_t m_pending = 0;
+    PlayTarget m_play = {0, -1, 0, 0};
+    PlayTarget m_next = {0, -1, 0, 0};
+    uint8_t m_volume = 0;
+    CommandStats m_stats = {0, 0, 0};
+};
+
+}
+
+#endif /* _COMMANDCHANNEL_H_ */
+
+/** @} */
@@ -0,0 +1,59 @@
+/**
+ * @file    src/common/dreqwait.h
+ *
+ * @brief Waiting for the data request line of the codec
+ *
+ * @addtogroup
+ * @{
+ */
+
+#ifndef _DREQWAIT_H_
+#define _DREQWAIT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Shared by the C codec driver and the unit tests, which run it on a
+ * virtual clock. All times are in system ticks.
+ */
+struct dreq_port
+{
+    /* Returns the level of DREQ.*/
+    bool (*read)(void* arg);
+    /*
+     * Blocks for at most timeout ticks, until the rising edge of DREQ wakes
+     * the caller or just for the next poll. Returns false on timeout.
+     */
+    bool (*block)(void* arg, uint32_t timeout);
+    uint32_t (*now)(void* arg);
+    void* arg;
+};
+
+/*
+ * Blocks until DREQ is high or timeout ticks have passed and returns the
+ * level of DREQ. Wakeups finding DREQ low again, e.g. after another
+ * writer took the FIFO space, do not restart the timeout. The port
+ * functions are called from the same system state as dreq_wait().
+ */
+static inline bool dreq_wait(const struct dreq_port* port, uint32_t timeout)
+{
+    uint32_t start = port->now(port->arg);
+    while (port->read(port->arg) == false)
+    {
+        uint32_t elapsed = port->now(port->arg) - start;
+        if (elapsed >= timeout)
+        {
+            return false;
+        }
+        if (port->block(port->arg, timeout - elapsed) == false)
+        {
+            return port->read(port->arg);
+        }
+    }
+    return true;
+}
+
+#endif /* _DREQWAIT_H_ */
+
+/** @} */
@@ -27,11 +27,16 @@ public:
     virtual bool Create(const char* path) = 0;
     virtual uint32_t GetString(char* buffer, uint32_t bufferSize) = 0;
     virtual int32_t WriteString(const char* str) = 0;
+    virtual int32_t Read(void* buffer, uint32_t size) = 0;
+    virtual int32_t Write(const void* data, uint32_t size) = 0;
     virtual int32_t Tell() = 0;
     virtual bool Seek(int32_t pos) = 0;
+    /* Cuts the file off at the current position.*/
+    virtual bool Truncate() = 0;
     virtual int32_t Size() = 0;
     virtual bool Error() = 0;
     virtual bool IsEOF() = 0;
+    virtual uint32_t Timestamp() = 0;
 };
 }
 
@@ -14,11 +14,22 @@ namespace tmb_musicplayer {
 
 bool FFile::Open(const char* path) {
     FRESULT err = f_open(&m_ff, path, FA_READ);
+    if (err == FR_OK) {
+        FILINFO fileInfo;
+#if _USE_LFN
+        fileInfo.lfname = NULL;
+        fileInfo.lfsize = 0;
+#endif
+        m_timestamp = 0;
+        if (f_stat(path, &fileInfo) == FR_OK) {
+            m_timestamp = ((uint32_t)fileInfo.fdate << 16) | fileInfo.ftime;
+        }
+    }
     return err == FR_OK;
 }
 
 bool FFile::Create(const char* path) {
-    FRESULT err = f_open(&m_ff, path, FA_OPEN_ALWAYS | FA_WRITE);
+    FRESULT err = f_open(&m_ff, path, FA_OPEN_ALWAYS | FA_READ | FA_WRITE);
     return err == FR_OK;
 }
 
@@ -41,6 +52,22 @@ int32_t FFile::WriteString(const char* str) {
     return f_puts(str, &m_ff);
 }
 
+int32_t FFile::Read(void* buffer, uint32_t size) {
+    UINT bytesRead = 0;
+    if (f_read(&m_ff, buffer, size, &bytesRead) != FR_OK) {
+        return -1;
+    }
+    return bytesRead;
+}
+
+int32_t FFile::Write(const void* data, uint32_t size) {
+    UINT bytesWritten = 0;
+    if (f_write(&m_ff, data, size, &bytesWritten) != FR_OK) {
+        return -1;
+    }
+    return bytesWritten;
+}
+
 int32_t FFile::Tell() {
     return f_tell(&m_ff);
 }
@@ -49,6 +76,10 @@ bool FFile::Seek(int32_t pos) {
     return f_lseek(&m_ff, pos) == FR_OK;
 }
 
+bool FFile::Truncate() {
+    return f_truncate(&m_ff) == FR_OK;
+}
+
 int32_t FFile::Size() {
     return f_size(&m_ff);
 }
@@ -61,6 +92,10 @@ bool FFile::IsEOF() {
     return f_eof(&m_ff);
 }
 
+uint32_t FFile::Timestamp() {
+    return m_timestamp;
+}
+
 }  // namespace tmb_musicplayer
 
 /** @} */
@@ -29,13 +29,18 @@ public:
     virtual bool Create(const char* path);
     virtual uint32_t GetString(char* buffer, uint32_t bufferSize);
     virtual int32_t WriteString(const char* str);
+    virtual int32_t Read(void* buffer, uint32_t size);
+    virtual int32_t Write(const void* data, uint32_t size);
     virtual int32_t Tell();
     virtual bool Seek(int32_t pos);
+    virtual bool Truncate();
     virtual int32_t Size();
     virtual bool Error();
     virtual bool IsEOF();
+    virtual uint32_t Timestamp();
 private:
     FIL m_ff;
+    uint32_t m_timestamp = 0;
 };
 }
 
@@ -0,0 +1,29 @@
+/**
+ * @file    src/common/nvmresumestorage.cpp
+ *
+ * @brief Resume table storage on a NVM device
+ *
+ * @addtogroup
+ * @{
+ */
+
+#include "nvmresumestorage.h"
+
+namespace tmb_musicplayer {
+
+NVMResumeStorage::NVMResumeStorage(BaseNVMDevice* device, uint32_t base) :
+        m_device(device),
+        m_base(base) {
+}
+
+bool NVMResumeStorage::Read(uint32_t offset, void* data, uint32_t size) {
+    return nvmRead(m_device, m_base + offset, size, (uint8_t*)data) == HAL_SUCCESS;
+}
+
+bool NVMResumeStorage::Write(uint32_t offset, const void* data, uint32_t size) {
+    return nvmWrite(m_device, m_base + offset, size, (const uint8_t*)data) == HAL_SUCCESS;
+}
+
+}  // namespace tmb_musicplayer
+
+/** @} */
@@ -0,0 +1,36 @@
+/**
+ * @file    src/common/nvmresumestorage.h
+ *
+ * @brief Resume table storage on a NVM device
+ *
+ * @addtogroup
+ * @{
+ */
+
+#ifndef _NVMRESUMESTORAGE_H_
+#define _NVMRESUMESTORAGE_H_
+
+#include <stdint.h>
+#include "qhal.h"
+
+#include "resumetable.h"
+
+namespace tmb_musicplayer
+{
+
+class NVMResumeStorage : public ResumeStorage
+{
+public:
+    NVMResumeStorage(BaseNVMDevice* device, uint32_t base);
+
+    virtual bool Read(uint32_t offset, void* data, uint32_t size);
+    virtual bool Write(uint32_t offset, const void* data, uint32_t size);
+private:
+    BaseNVMDevice* m_device;
+    uint32_t m_base;
+};
+}
+
+#endif /* _NVMRESUMESTORAGE_H_ */
+
+/** @} */
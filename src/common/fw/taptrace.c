@@ -0,0 +1,173 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "taptrace.h"
+
+#include "target_cfg.h"
+#include "chprintf.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/* A tap which does not reach the codec within this time is dropped. */
+#define TAPTRACE_TIMEOUT S2ST(10)
+
+/* Upper bounds of the histogram buckets in ms, the last bucket is open. */
+static const uint16_t bucket_limits[] = {10, 20, 50, 100, 200, 500, 1000};
+#define TAPTRACE_BUCKETS ((sizeof(bucket_limits) / sizeof(bucket_limits[0])) + 1)
+
+struct stage_stats
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t sum;
+    uint32_t buckets[TAPTRACE_BUCKETS];
+};
+
+static const char* const stage_names[TAPTRACE_POINT_COUNT] =
+{
+    "total",
+    "directory",
+    "playlist",
+    "command",
+    "open",
+    "first byte",
+};
+
+static systime_t marks[TAPTRACE_POINT_COUNT];
+static uint8_t marked;
+static bool active;
+static bool pending_report;
+static uint32_t tap_count;
+/* Stage i is the time from the previous marked point to point i, stage 0
+ * holds the total time from detection to the first byte. */
+static struct stage_stats stats[TAPTRACE_POINT_COUNT];
+static uint32_t last[TAPTRACE_POINT_COUNT];
+
+static void update_stats(struct stage_stats* s, uint32_t ms)
+{
+    if ((s->count == 0) || (ms < s->min))
+    {
+        s->min = ms;
+    }
+    if (ms > s->max)
+    {
+        s->max = ms;
+    }
+    s->sum += ms;
+    s->count++;
+
+    uint32_t i;
+    for (i = 0; i < (TAPTRACE_BUCKETS - 1); i++)
+    {
+        if (ms < bucket_limits[i])
+        {
+            break;
+        }
+    }
+    s->buckets[i]++;
+}
+
+static void complete_tap(void)
+{
+    int i;
+    int previous = TAPTRACE_CARD_DETECTED;
+    for (i = 1; i < TAPTRACE_POINT_COUNT; i++)
+    {
+        last[i] = 0;
+        if (marked & (1 << i))
+        {
+            last[i] = ST2MS(marks[i] - marks[previous]);
+            update_stats(&stats[i], last[i]);
+            previous = i;
+        }
+    }
+    last[0] = ST2MS(marks[TAPTRACE_FIRST_BYTE] - marks[TAPTRACE_CARD_DETECTED]);
+    update_stats(&stats[0], last[0]);
+    tap_count++;
+    pending_report = true;
+}
+
+void taptrace_mark(enum taptrace_point point)
+{
+    systime_t now = chVTGetSystemTimeX();
+
+    chSysLock();
+    if (point == TAPTRACE_CARD_DETECTED)
+    {
+        marks[point] = now;
+        marked = 1 << point;
+        active = true;
+    }
+    else if (active == true)
+    {
+        if ((now - marks[TAPTRACE_CARD_DETECTED]) > TAPTRACE_TIMEOUT)
+        {
+            active = false;
+        }
+        else if ((marked & (1 << point)) == 0)
+        {
+            marks[point] = now;
+            marked |= 1 << point;
+            if (point == TAPTRACE_FIRST_BYTE)
+            {
+                active = false;
+                complete_tap();
+            }
+        }
+    }
+    chSysUnlock();
+}
+
+void taptrace_report(BaseSequentialStream* chp)
+{
+    uint32_t tap_last[TAPTRACE_POINT_COUNT];
+    struct stage_stats tap_stats[TAPTRACE_POINT_COUNT];
+    uint32_t count;
+
+    chSysLock();
+    if (pending_report == false)
+    {
+        chSysUnlock();
+        return;
+    }
+    pending_report = false;
+    memcpy(tap_last, last, sizeof(tap_last));
+    memcpy(tap_stats, stats, sizeof(tap_stats));
+    count = tap_count;
+    chSysUnlock();
+
+    chprintf(chp, "Tap latency #%d:\r\n", count);
+    int i;
+    for (i = 1; i <= TAPTRACE_POINT_COUNT; i++)
+    {
+        /* print the stages first and the total last */
+        int stage = i % TAPTRACE_POINT_COUNT;
+        const struct stage_stats* s = &tap_stats[stage];
+        if (s->count == 0)
+        {
+            continue;
+        }
+
+        chprintf(chp, "  %-10s %5d ms  min %5d avg %5d max %5d  [",
+                stage_names[stage], tap_last[stage], s->min, s->sum / s->count, s->max);
+        uint32_t b;
+        for (b = 0; b < TAPTRACE_BUCKETS; b++)
+        {
+            chprintf(chp, b == 0 ? "%d" : " %d", s->buckets[b]);
+        }
+        chprintf(chp, "]\r\n");
+    }
+}
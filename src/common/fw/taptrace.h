@@ -0,0 +1,50 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef TAPTRACE_H_
+#define TAPTRACE_H_
+
+#include "hal.h"
+
+/*
+ * Trace points on the way from a card tap to the first byte sent to the
+ * codec, in the order they are passed.
+ */
+enum taptrace_point
+{
+    TAPTRACE_CARD_DETECTED,
+    TAPTRACE_DIRECTORY_FOUND,
+    TAPTRACE_PLAYLIST_LOADED,
+    TAPTRACE_PLAY_COMMAND,
+    TAPTRACE_FILE_OPENED,
+    TAPTRACE_FIRST_BYTE,
+    TAPTRACE_POINT_COUNT,
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void taptrace_mark(enum taptrace_point point);
+/*
+ * Prints the statistics after a completed tap, several lines which are
+ * left to the trace thread instead of the threads handling a tap.
+ */
+void taptrace_report(BaseSequentialStream* chp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TAPTRACE_H_ */
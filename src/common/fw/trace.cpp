@@ -0,0 +1,76 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "trace.h"
+
+#include "ch.h"
+#include "chprintf.h"
+
+#include "tracering.h"
+
+using tmb_musicplayer::TraceRecord;
+using tmb_musicplayer::TraceRing;
+
+static TraceRing<TRACE_RING_SIZE> trace_ring;
+
+#if TRACE_USE_FORMATS
+#define TRACE_EVENT_FORMAT(id, format) format,
+
+static const char* const trace_formats[TRACE_EVENT_COUNT] =
+{
+    TRACE_EVENTS(TRACE_EVENT_FORMAT)
+};
+#endif /* TRACE_USE_FORMATS */
+
+static void trace_print(BaseSequentialStream* chp, const TraceRecord& record)
+{
+    uint32_t ms = (uint32_t)(((uint64_t)record.time * 1000) / CH_CFG_ST_FREQUENCY);
+#if TRACE_USE_FORMATS
+    if (record.event < TRACE_EVENT_COUNT)
+    {
+        chprintf(chp, "%d ", ms);
+        chprintf(chp, trace_formats[record.event], record.arg0, record.arg1);
+        chprintf(chp, "\r\n");
+        return;
+    }
+#endif /* TRACE_USE_FORMATS */
+    chprintf(chp, "T %d %d %d %d\r\n", ms, record.event, record.arg0, record.arg1);
+}
+
+void trace_event(enum trace_event event, uint32_t arg0, uint32_t arg1)
+{
+    trace_ring.Write(chVTGetSystemTimeX(), event, arg0, arg1);
+}
+
+void trace_drain(BaseSequentialStream* chp)
+{
+    static uint32_t reported_drops;
+
+    TraceRecord record;
+    while (trace_ring.Read(record))
+    {
+        trace_print(chp, record);
+    }
+
+    uint32_t dropped = trace_ring.Dropped();
+    if (dropped != reported_drops)
+    {
+        record.time = chVTGetSystemTimeX();
+        record.event = TRACE_DROPPED;
+        record.arg0 = dropped - reported_drops;
+        record.arg1 = 0;
+        reported_drops = dropped;
+        trace_print(chp, record);
+    }
+}
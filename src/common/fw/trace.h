@@ -0,0 +1,66 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include "hal.h"
+#include "traceevents.h"
+
+/*
+ * Number of records the ring holds until the drain catches up, must be a
+ * power of two.
+ */
+#ifndef TRACE_RING_SIZE
+#define TRACE_RING_SIZE 64
+#endif
+
+/*
+ * Without formats the records are emitted as numbers, see traceevents.h.
+ */
+#ifndef TRACE_USE_FORMATS
+#if defined(NDEBUG)
+#define TRACE_USE_FORMATS FALSE
+#else
+#define TRACE_USE_FORMATS TRUE
+#endif
+#endif
+
+#define TRACE_EVENT_ID(id, format) id,
+
+enum trace_event
+{
+    TRACE_EVENTS(TRACE_EVENT_ID)
+    TRACE_EVENT_COUNT,
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Records an event with the current system time, never blocks and may be
+ * called from any thread or interrupt handler.
+ */
+void trace_event(enum trace_event event, uint32_t arg0, uint32_t arg1);
+/*
+ * Emits all pending records, only one thread may drain.
+ */
+void trace_drain(BaseSequentialStream* chp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRACE_H_ */
@@ -0,0 +1,64 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef TRACEEVENTS_H_
+#define TRACEEVENTS_H_
+
+/*
+ * Trace events with the format of their two arguments. New events are
+ * appended, the ids of a build without formats are their position here.
+ */
+#define TRACE_EVENTS(X) \
+    X(TRACE_DROPPED,                    "trace: %d records dropped.") \
+    X(TRACE_PLAYER_PLAY,                "ModulePlayer: play title %d of playlist %d.") \
+    X(TRACE_PLAYER_PLAY_AGAIN,          "ModulePlayer: play the last title again.") \
+    X(TRACE_PLAYER_PLAY_NEXT,           "ModulePlayer: play next title %d of playlist %d.") \
+    X(TRACE_PLAYER_DROP,                "ModulePlayer: drop title %d of playlist %d.") \
+    X(TRACE_PLAYER_VOLUME,              "ModulePlayer: set volume %d.") \
+    X(TRACE_PLAYER_SKIP_METADATA,       "ModulePlayer: skip %d bytes of metadata.") \
+    X(TRACE_PLAYER_NO_CLUSTER_MAP,      "ModulePlayer: no cluster map, seeking slowly.") \
+    X(TRACE_PLAYER_TITLE_BYTES,         "ModulePlayer: title %d bytes in %d ms.") \
+    X(TRACE_PLAYER_TITLE_RATE,          "ModulePlayer: title %d bytes/s, %d underruns.") \
+    X(TRACE_PLAYER_TITLE_STALL,         "ModulePlayer: codec stalled %d ms, waited %d ms at most.") \
+    X(TRACE_PLAYER_TITLE_READS,         "ModulePlayer: card %d reads, %d us on average.") \
+    X(TRACE_PLAYER_TITLE_READ_MAX,      "ModulePlayer: card read %d ms at most.") \
+    X(TRACE_MUSICBOX_GRACE_OVER,        "ModuleMusicbox: RFID grace period over.") \
+    X(TRACE_MUSICBOX_PLAY_BUTTON,       "ModuleMusicbox: Play button up event.") \
+    X(TRACE_MUSICBOX_NEXT_BUTTON,       "ModuleMusicbox: Next button pressed event.") \
+    X(TRACE_MUSICBOX_PREV_BUTTON,       "ModuleMusicbox: Prev button pressed event.") \
+    X(TRACE_MUSICBOX_VOLUP_BUTTON,      "ModuleMusicbox: VolUp button pressed event.") \
+    X(TRACE_MUSICBOX_VOLDOWN_BUTTON,    "ModuleMusicbox: VolDown button pressed event.") \
+    X(TRACE_MUSICBOX_SCRUB,             "ModuleMusicbox: Scrub %d s.") \
+    X(TRACE_MUSICBOX_CARD_LOST,         "ModuleMusicbox: RFID lost.") \
+    X(TRACE_MUSICBOX_CARD_BACK,         "ModuleMusicbox: RFID back: %08X%08X.") \
+    X(TRACE_MUSICBOX_CARD_DETECTED,     "ModuleMusicbox: RFID detected: %08X%08X.") \
+    X(TRACE_MUSICBOX_PLAYER_NEXT,       "ModuleMusicbox: player Next.") \
+    X(TRACE_MUSICBOX_PLAYER_PLAY,       "ModuleMusicbox: player Play.") \
+    X(TRACE_MUSICBOX_PLAYER_STOP,       "ModuleMusicbox: player Stop.") \
+    X(TRACE_MUSICBOX_PLAYER_PAUSE,      "ModuleMusicbox: player Pause.") \
+    X(TRACE_MUSICBOX_DIRECTORY_CREATED, "ModuleMusicbox: Create directory: %08X%08X.") \
+    X(TRACE_MUSICBOX_DIRECTORY_FOUND,   "ModuleMusicbox: Found directory: %08X%08X.") \
+    X(TRACE_MUSICBOX_PLAYLIST_FOUND,    "ModuleMusicbox: Found playlist.") \
+    X(TRACE_MUSICBOX_PLAYLIST_CREATED,  "ModuleMusicbox: Create playlist with %d files.") \
+    X(TRACE_MUSICBOX_RESUME,            "ModuleMusicbox: Resume title %d at %d s.") \
+    X(TRACE_CARDREADER_REMOVED,         "ModuleCardreader: Memory card removed.") \
+    X(TRACE_CARDREADER_INSERTED,        "ModuleCardreader: Memory card inserted.") \
+    X(TRACE_CARDREADER_CONNECT_FAILED,  "ModuleCardreader: Failed to connect sdc card.") \
+    X(TRACE_CARDREADER_MOUNTED,         "ModuleCardreader: FS: f_mount() succeeded") \
+    X(TRACE_CARDREADER_MOUNT_FAILED,    "ModuleCardreader: FS: f_mount() failed with %d. Is the SD card inserted?") \
+    X(TRACE_CARDREADER_UNMOUNTED,       "ModuleCardreader: FS: f_mount() unmount succeeded") \
+    X(TRACE_CARDREADER_UNMOUNT_FAILED,  "ModuleCardreader: FS: f_mount() unmount failed with %d") \
+    X(TRACE_CARDREADER_UID_INDEX,       "ModuleCardreader: UID index with %d directories, complete %d.")
+
+#endif /* TRACEEVENTS_H_ */
@@ -0,0 +1,117 @@
+/**
+ * @file    src/common/loadmeter.h
+ *
+ * @brief CPU share and stack headroom of the threads
+ *
+ * @addtogroup
+ * @{
+ */
+
+#ifndef _LOADMETER_H_
+#define _LOADMETER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace tmb_musicplayer
+{
+
+/**
+ * @brief   Turns the run time counters of the threads into their share of
+ *          an interval.
+ * @details The counters are sampled once per interval between Begin() and
+ *          End(). A thread counts from its first sample on, a thread not
+ *          sampled in an interval has exited and its slot is reused.
+ *          Threads beyond MaxThreads are not measured.
+ */
+template <uint32_t MaxThreads>
+class LoadMeter
+{
+public:
+    LoadMeter() {
+    }
+
+    void Begin(uint32_t now) {
+        m_interval = now - m_lastBegin;
+        m_lastBegin = now;
+        for (uint32_t i = 0; i < MaxThreads; i++) {
+            m_entries[i].seen = false;
+        }
+    }
+
+    /* Returns the per mille of the interval the thread ran.*/
+    uint32_t Sample(const void* thread, uint32_t runTime) {
+        Entry* entry = Find(thread);
+        if (entry == NULL) {
+            entry = Find(NULL);
+            if (entry == NULL) {
+                return 0;
+            }
+            entry->thread = thread;
+            entry->runTime = runTime;
+        }
+
+        uint32_t ran = runTime - entry->runTime;
+        if (runTime < entry->runTime) {
+            /* A new thread in the place of an exited one.*/
+            ran = runTime;
+        }
+        entry->runTime = runTime;
+        entry->seen = true;
+        return PerMille(ran, m_interval);
+    }
+
+    void End() {
+        for (uint32_t i = 0; i < MaxThreads; i++) {
+            if (m_entries[i].seen == false) {
+                m_entries[i].thread = NULL;
+            }
+        }
+    }
+
+    static uint32_t PerMille(uint32_t part, uint32_t whole) {
+        if (whole == 0) {
+            return 0;
+        }
+        uint32_t result = (uint32_t)(((uint64_t)part * 1000) / whole);
+        return (result > 1000) ? 1000 : result;
+    }
+
+    /*
+     * Counts the bytes above the bottom of a stack which still hold the
+     * fill value. The context saved at the top of the stack ends the scan.
+     */
+    static uint32_t UnusedStack(const uint8_t* bottom, uint8_t fill) {
+        const uint8_t* p = bottom;
+        while (*p == fill) {
+            p++;
+        }
+        return (uint32_t)(p - bottom);
+    }
+
+private:
+    struct Entry {
+        const void* thread;
+        uint32_t runTime;
+        bool seen;
+    };
+
+    Entry* Find(const void* thread) {
+        for (uint32_t i = 0; i < MaxThreads; i++) {
+            if (m_entries[i].thread == thread) {
+                return &m_entries[i];
+            }
+        }
+        return NULL;
+    }
+
+    Entry m_entries[MaxThreads] = {};
+    uint32_t m_interval = 0;
+    uint32_t m_lastBegin = 0;
+};
+
+}
+
+#endif /* _LOADMETER_H_ */
+
+/** @} */
@@ -0,0 +1,81 @@
+/**
+ * @file    src/common/metadatatags.cpp
+ * @brief
+ *
+ * @addtogroup
+ * @{
+ */
+#include "metadatatags.h"
+
+#include <string.h>
+
+namespace tmb_musicplayer {
+
+uint32_t MetadataTags::ID3v2TagSize(const uint8_t* header, uint32_t length) {
+    if (length < ID3v2HeaderSize) {
+        return 0;
+    }
+
+    if (memcmp(header, "ID3", 3) != 0) {
+        return 0;
+    }
+
+    // version 2.2 to 2.4, the revision is never 0xFF
+    if ((header[3] < 2) || (header[3] > 4) || (header[4] == 0xFF)) {
+        return 0;
+    }
+
+    // the size is a 28 bit synchsafe integer in every version, it does not
+    // change with the unsynchronisation flag
+    uint32_t size = 0;
+    for (uint32_t i = 6; i < ID3v2HeaderSize; i++) {
+        if (header[i] & 0x80) {
+            return 0;
+        }
+        size = (size << 7) | header[i];
+    }
+    size += ID3v2HeaderSize;
+
+    // v2.4 footer present
+    if ((header[3] == 4) && (header[5] & 0x10)) {
+        size += ID3v2HeaderSize;
+    }
+    return size;
+}
+
+uint32_t MetadataTags::TrailingTagSize(const uint8_t* tail, uint32_t length) {
+    uint32_t size = 0;
+
+    // ID3v1 is always the very last tag
+    if ((length >= ID3v1TagSize) && (memcmp(tail + length - ID3v1TagSize, "TAG", 3) == 0)) {
+        size += ID3v1TagSize;
+    }
+
+    // an APE tag ends with its footer, either at the end or in front of ID3v1
+    if (length >= (size + APEFooterSize)) {
+        size += APETagSize(tail + length - size - APEFooterSize);
+    }
+    return size;
+}
+
+uint32_t MetadataTags::APETagSize(const uint8_t* footer) {
+    if (memcmp(footer, "APETAGEX", 8) != 0) {
+        return 0;
+    }
+
+    // little endian, size includes the items and the footer
+    uint32_t size = footer[12] | (footer[13] << 8) | (footer[14] << 16) | ((uint32_t)footer[15] << 24);
+    uint32_t flags = footer[20] | (footer[21] << 8) | (footer[22] << 16) | ((uint32_t)footer[23] << 24);
+    if (size < APEFooterSize) {
+        return 0;
+    }
+
+    // bit 31 indicates an additional header in front of the items
+    if (flags & 0x80000000) {
+        size += APEFooterSize;
+    }
+    return size;
+}
+
+}
+/** @} */
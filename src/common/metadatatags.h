@@ -0,0 +1,47 @@
+/**
+ * @file    src/common/metadatatags.h
+ *
+ * @brief Detection of ID3 and APE metadata tags in audio files
+ *
+ * @addtogroup
+ * @{
+ */
+
+#ifndef _METADATATAGS_H_
+#define _METADATATAGS_H_
+
+#include <stdint.h>
+
+namespace tmb_musicplayer
+{
+
+class MetadataTags
+{
+public:
+    /* Bytes needed to detect a leading ID3v2 tag.*/
+    static const uint32_t ID3v2HeaderSize = 10;
+    static const uint32_t ID3v1TagSize = 128;
+    static const uint32_t APEFooterSize = 32;
+    /* Bytes from the end of the file needed to detect all trailing tags.*/
+    static const uint32_t TrailerSize = ID3v1TagSize + APEFooterSize;
+
+    /*
+     * Returns the complete size of the ID3v2 tag starting at header,
+     * including header and footer, or 0 if there is no valid tag.
+     */
+    static uint32_t ID3v2TagSize(const uint8_t* header, uint32_t length);
+
+    /*
+     * Returns the number of bytes of ID3v1 and APE tags at the end of a
+     * file, tail holds the last length bytes of the file.
+     */
+    static uint32_t TrailingTagSize(const uint8_t* tail, uint32_t length);
+
+private:
+    static uint32_t APETagSize(const uint8_t* footer);
+};
+}
+
+#endif /* _METADATATAGS_H_ */
+
+/** @} */
@@ -0,0 +1,128 @@
+/**
+ * @file    src/common/playbackhealth.h
+ *
+ * @brief Counters telling a slow card from a slow codec interface
+ *
+ * @addtogroup
+ * @{
+ */
+
+#ifndef _PLAYBACKHEALTH_H_
+#define _PLAYBACKHEALTH_H_
+
+#include <stdint.h>
+
+namespace tmb_musicplayer
+{
+
+/*
+ * All times are in system ticks.
+ */
+struct PlaybackCounters {
+    uint32_t bytes;
+    uint32_t duration;
+    /* Bursts sent to the codec and how long it requested data before.*/
+    uint32_t sends;
+    uint32_t hungryTotal;
+    uint32_t hungryMax;
+    /* Bursts which found the codec FIFO empty and the time it was empty.*/
+    uint32_t underruns;
+    uint32_t stallTotal;
+    /* File system reads and the time they took.*/
+    uint32_t reads;
+    uint32_t readTotal;
+    uint32_t readMax;
+};
+
+struct PlaybackStats {
+    PlaybackCounters current;
+    PlaybackCounters last;
+    PlaybackCounters total;
+    uint32_t titles;
+};
+
+/**
+ * @brief   Collects the stream health of the current title.
+ * @details A burst which found the codec requesting data for longer than
+ *          a full FIFO lasts at the stream byte rate is an underrun, the
+ *          time beyond is the least time the decoder stalled. Underruns
+ *          are not counted before the byte rate of a title is known. The
+ *          counters are not synchronized, they belong to the pump.
+ */
+class PlaybackHealth
+{
+public:
+    PlaybackHealth() {
+    }
+
+    void StartTrack(uint32_t now) {
+        m_stats.current = PlaybackCounters();
+        m_trackStart = now;
+    }
+
+    /* fifoTime is the time a full codec FIFO plays, 0 if unknown.*/
+    void Sent(uint32_t bytes, uint32_t hungry, uint32_t fifoTime) {
+        uint32_t stall = 0;
+        if ((fifoTime > 0) && (hungry > fifoTime)) {
+            stall = hungry - fifoTime;
+        }
+        AddSend(m_stats.current, bytes, hungry, stall);
+        AddSend(m_stats.total, bytes, hungry, stall);
+    }
+
+    void ReadDone(uint32_t latency) {
+        AddRead(m_stats.current, latency);
+        AddRead(m_stats.total, latency);
+    }
+
+    void EndTrack(uint32_t now) {
+        m_stats.current.duration = now - m_trackStart;
+        m_stats.total.duration += m_stats.current.duration;
+        m_stats.last = m_stats.current;
+        m_stats.titles++;
+        StartTrack(now);
+    }
+
+    const PlaybackStats& Update(uint32_t now) {
+        m_stats.current.duration = now - m_trackStart;
+        return m_stats;
+    }
+
+    static uint32_t BytesPerSecond(const PlaybackCounters& counters, uint32_t ticksPerSecond) {
+        if (counters.duration == 0) {
+            return 0;
+        }
+        return (uint32_t)(((uint64_t)counters.bytes * ticksPerSecond) / counters.duration);
+    }
+
+private:
+    static void AddSend(PlaybackCounters& counters, uint32_t bytes, uint32_t hungry, uint32_t stall) {
+        counters.bytes += bytes;
+        counters.sends++;
+        counters.hungryTotal += hungry;
+        if (hungry > counters.hungryMax) {
+            counters.hungryMax = hungry;
+        }
+        if (stall > 0) {
+            counters.underruns++;
+            counters.stallTotal += stall;
+        }
+    }
+
+    static void AddRead(PlaybackCounters& counters, uint32_t latency) {
+        counters.reads++;
+        counters.readTotal += latency;
+        if (latency > counters.readMax) {
+            counters.readMax = latency;
+        }
+    }
+
+    PlaybackStats m_stats = {};
+    uint32_t m_trackStart = 0;
+};
+
+}
+
+#endif /* _PLAYBACKHEALTH_H_ */
+
+/** @} */
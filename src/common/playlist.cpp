@@ -18,37 +18,183 @@ Playlist::~Playlist() {
 }
 
 bool Playlist::LoadFromFile(File* file) {
+    Init(file);
+    ScanFile(NULL);
+    return m_titleCount > 0;
+}
+
+bool Playlist::LoadFromFile(File* file, File* indexFile, const char* indexPath) {
+    Init(file);
+    if (OpenIndex(indexFile, indexPath) == true) {
+        return m_titleCount > 0;
+    }
+
+    // index is missing or stale, parse the playlist and store a new one
+    Init(file);
+    if (indexFile->Create(indexPath) == true) {
+        bool written = ScanFile(indexFile);
+        indexFile->Sync();
+        indexFile->Close();
+        if (written && indexFile->Open(indexPath)) {
+            m_indexFile = indexFile;
+        }
+    } else {
+        ScanFile(NULL);
+    }
+    return m_titleCount > 0;
+}
+
+void Playlist::Init(File* file) {
+    if (m_indexFile != NULL) {
+        m_indexFile->Close();
+        m_indexFile = NULL;
+    }
     m_file = file;
     m_titleCount = 0;
     m_currentReadIndex = -1;
+    m_pageStart = 0;
+    m_pageCount = 0;
+    m_checkpointCount = 0;
+    m_checkpointStride = PageSize;
+}
+
+bool Playlist::NextTitle(IndexEntry& entry) {
     while (true) {
-        auto readPos = file->Tell();
+        auto readPos = m_file->Tell();
         auto pszBuffer = &m_buffer.front();
-        if (file->GetString(pszBuffer, m_buffer.size())) {
-            // filter spaces in front of the text and comments
-
-            auto iter = m_buffer.begin();
-            for (; iter != m_buffer.end(); ++iter) {
-                char c = *iter;
-                if (c == '#') {
-                    iter = m_buffer.end();
-                    break;
-                } else if (c != ' ') {
-                    break;
-                }
-            }
+        uint32_t chars = m_file->GetString(pszBuffer, m_buffer.size());
+        if (chars == 0) {
+            return false;
+        }
+
+        // line terminators are not part of the title
+        while ((chars > 0) && ((pszBuffer[chars - 1] == '\n') || (pszBuffer[chars - 1] == '\r'))) {
+            chars--;
+        }
+
+        // filter spaces in front of the text and comments
+        uint32_t i = 0;
+        while ((i < chars) && ((pszBuffer[i] == ' ') || (pszBuffer[i] == '\t'))) {
+            i++;
+        }
+
+        if ((i < chars) && (pszBuffer[i] != '#')) {
+            entry.offset = readPos;
+            entry.length = chars;
+            return true;
+        }
+    }
+}
+
+bool Playlist::ScanFile(File* indexFile) {
+    IndexHeader header;
+    header.magic = IndexMagic;
+    header.version = IndexVersion;
+    header.playlistSize = m_file->Size();
+    header.playlistTimestamp = m_file->Timestamp();
+    header.titleCount = 0;
+
+    bool writeIndex = false;
+    if (indexFile != NULL) {
+        // the magic is written last, an interrupted write is never valid
+        header.magic = 0;
+        writeIndex = (indexFile->Write(&header, sizeof(header)) == sizeof(header));
+    }
+
+    m_file->Seek(0);
+    IndexEntry entry;
+    while (NextTitle(entry) == true) {
+        AddCheckpoint(m_titleCount, entry.offset);
+        if (writeIndex == true) {
+            writeIndex = (indexFile->Write(&entry, sizeof(entry)) == sizeof(entry));
+        }
+        m_titleCount++;
+    }
+
+    // the file is reused, entries of a longer playlist are cut off
+    if (writeIndex == true) {
+        writeIndex = indexFile->Truncate();
+    }
+
+    if (writeIndex == true) {
+        header.magic = IndexMagic;
+        header.titleCount = m_titleCount;
+        writeIndex = indexFile->Seek(0)
+                && (indexFile->Write(&header, sizeof(header)) == sizeof(header));
+    }
+    return writeIndex;
+}
+
+bool Playlist::OpenIndex(File* indexFile, const char* indexPath) {
+    if (indexFile->Open(indexPath) == false) {
+        return false;
+    }
+
+    IndexHeader header;
+    if (indexFile->Read(&header, sizeof(header)) == sizeof(header)) {
+        if ((header.magic == IndexMagic) && (header.version == IndexVersion)
+                && (header.playlistSize == (uint32_t)m_file->Size())
+                && (header.playlistTimestamp == m_file->Timestamp())
+                && ((uint32_t)indexFile->Size() == sizeof(header) + header.titleCount * sizeof(IndexEntry))) {
+            m_indexFile = indexFile;
+            m_titleCount = header.titleCount;
+            return true;
+        }
+    }
+
+    indexFile->Close();
+    return false;
+}
 
-            if (iter != m_buffer.end()) {
-                m_readPositions[m_titleCount++] = readPos;
-                if (m_titleCount == MaxTitleCount) {
-                    break;
+void Playlist::AddCheckpoint(int32_t titleIndex, int32_t offset) {
+    if ((titleIndex % m_checkpointStride) != 0) {
+        return;
+    }
+
+    if (m_checkpointCount == CheckpointCount) {
+        // out of checkpoints, keep every second one and double the distance
+        for (int32_t i = 0; i < CheckpointCount / 2; i++) {
+            m_checkpoints[i] = m_checkpoints[2 * i];
+        }
+        m_checkpointCount = CheckpointCount / 2;
+        m_checkpointStride *= 2;
+        if ((titleIndex % m_checkpointStride) != 0) {
+            return;
+        }
+    }
+    m_checkpoints[m_checkpointCount++] = offset;
+}
+
+bool Playlist::LoadPage(int32_t index) {
+    int32_t pageStart = index - (index % PageSize);
+    int32_t count = m_titleCount - pageStart;
+    if (count > PageSize) {
+        count = PageSize;
+    }
+    m_pageStart = pageStart;
+    m_pageCount = 0;
+
+    if (m_indexFile != NULL) {
+        int32_t bytes = count * sizeof(IndexEntry);
+        if (m_indexFile->Seek(sizeof(IndexHeader) + pageStart * sizeof(IndexEntry))
+                && (m_indexFile->Read(m_page, bytes) == bytes)) {
+            m_pageCount = count;
+        }
+    } else {
+        // parse forward from the checkpoint in front of the page
+        int32_t checkpoint = pageStart / m_checkpointStride;
+        int32_t titleIndex = checkpoint * m_checkpointStride;
+        if ((checkpoint < m_checkpointCount) && m_file->Seek(m_checkpoints[checkpoint])) {
+            IndexEntry entry;
+            while ((m_pageCount < count) && NextTitle(entry)) {
+                if (titleIndex >= pageStart) {
+                    m_page[m_pageCount++] = entry;
                 }
+                titleIndex++;
             }
-        } else {
-            break;
         }
     }
-    return m_titleCount > 0;
+    return m_pageCount == count;
 }
 
 void Playlist::Reset()
@@ -56,32 +202,79 @@ void Playlist::Reset()
     m_currentReadIndex = -1;
 }
 
-uint32_t Playlist::QueryNext(char* buffer, uint32_t bufferSize) {
+bool Playlist::SelectNext() {
     m_currentReadIndex++;
     if (m_currentReadIndex < m_titleCount) {
-        return QueryString(buffer, bufferSize);
+        return true;
     }
     m_currentReadIndex = m_titleCount;
 
-    return 0;
+    return false;
 }
 
-uint32_t Playlist::QueryPrev(char* buffer, uint32_t bufferSize) {
+bool Playlist::SelectPrev() {
     if (m_currentReadIndex > 0) {
         m_currentReadIndex--;
-        if (m_currentReadIndex < m_titleCount) {
-            return QueryString(buffer, bufferSize);
-        }
+        return m_currentReadIndex < m_titleCount;
+    }
+    return false;
+}
+
+bool Playlist::Select(int32_t index) {
+    if ((index >= 0) && (index < m_titleCount)) {
+        m_currentReadIndex = index;
+        return true;
+    }
+    return false;
+}
+
+uint32_t Playlist::QueryNext(char* buffer, uint32_t bufferSize) {
+    if (SelectNext()) {
+        return QueryString(m_currentReadIndex, buffer, bufferSize);
+    }
+    return 0;
+}
+
+uint32_t Playlist::QueryPrev(char* buffer, uint32_t bufferSize) {
+    if (SelectPrev()) {
+        return QueryString(m_currentReadIndex, buffer, bufferSize);
+    }
+    return 0;
+}
+
+uint32_t Playlist::PeekNext(char* buffer, uint32_t bufferSize) {
+    return QueryTitle(m_currentReadIndex + 1, buffer, bufferSize);
+}
+
+uint32_t Playlist::Query(int32_t index, char* buffer, uint32_t bufferSize) {
+    if (Select(index)) {
+        return QueryString(index, buffer, bufferSize);
+    }
+    return 0;
+}
+
+uint32_t Playlist::QueryTitle(int32_t index, char* buffer, uint32_t bufferSize) {
+    if ((index >= 0) && (index < m_titleCount)) {
+        return QueryString(index, buffer, bufferSize);
     }
     return 0;
 }
 
-uint32_t Playlist::QueryString(char* buffer, uint32_t bufferSize) {
-    if (m_file->Seek(m_readPositions[m_currentReadIndex])) {
-        uint32_t chars = m_file->GetString(&(m_buffer.front()), m_buffer.size());
+uint32_t Playlist::QueryString(int32_t index, char* buffer, uint32_t bufferSize) {
+    if ((index < m_pageStart) || (index >= (m_pageStart + m_pageCount))) {
+        if (LoadPage(index) == false) {
+            return 0;
+        }
+    }
+
+    const IndexEntry& entry = m_page[index - m_pageStart];
+    if (m_file->Seek(entry.offset)) {
+        // the length is known, read the title in one go
+        uint32_t chars = entry.length;
         if (chars > 0 && (chars < bufferSize)) {
-            std::copy(m_buffer.begin(), m_buffer.begin() + chars, buffer);
-            return chars;
+            if (m_file->Read(buffer, chars) == (int32_t)chars) {
+                return chars;
+            }
         }
     }
     return 0;
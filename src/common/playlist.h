@@ -18,33 +18,89 @@
 namespace tmb_musicplayer
 {
 
+/*
+ * The title offsets are not held in RAM completely. A page of offsets is
+ * loaded on demand, either from the binary index stored next to the
+ * playlist or by parsing the playlist from the nearest checkpoint.
+ */
 class Playlist
 {
 public:
-    static const int32_t MaxTitleCount = 100;
+    static const int32_t PageSize = 32;
+    static const int32_t CheckpointCount = 128;
 
     Playlist();
     ~Playlist();
 
     bool LoadFromFile(File* file);
+    bool LoadFromFile(File* file, File* indexFile, const char* indexPath);
 
     void Reset();
     uint32_t QueryNext(char* buffer, uint32_t bufferSize);
     uint32_t QueryPrev(char* buffer, uint32_t bufferSize);
+    uint32_t PeekNext(char* buffer, uint32_t bufferSize);
+    uint32_t Query(int32_t index, char* buffer, uint32_t bufferSize);
+
+    /* Move the current title without reading it.*/
+    bool SelectNext();
+    bool SelectPrev();
+    bool Select(int32_t index);
+
+    /* Reads any title, the current one stays.*/
+    uint32_t QueryTitle(int32_t index, char* buffer, uint32_t bufferSize);
 
     int32_t GetTitleCount() const {
         return m_titleCount;
     }
+
+    int32_t GetCurrentIndex() const {
+        return m_currentReadIndex;
+    }
 private:
-    uint32_t QueryString(char* buffer, uint32_t bufferSize);
+    /*
+     * Binary index stored next to the playlist, holds the offset and length
+     * of every title so loading does not need to parse the playlist.
+     */
+    static const uint32_t IndexMagic = 0x58444950; // "PIDX"
+    static const uint32_t IndexVersion = 1;
+
+    struct IndexHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t playlistSize;
+        uint32_t playlistTimestamp;
+        uint32_t titleCount;
+    };
+
+    struct IndexEntry {
+        int32_t offset;
+        uint32_t length;
+    };
+
+    void Init(File* file);
+    bool NextTitle(IndexEntry& entry);
+    bool ScanFile(File* indexFile);
+    bool OpenIndex(File* indexFile, const char* indexPath);
+    void AddCheckpoint(int32_t titleIndex, int32_t offset);
+    bool LoadPage(int32_t index);
+    uint32_t QueryString(int32_t index, char* buffer, uint32_t bufferSize);
 
     File* m_file = NULL;
+    File* m_indexFile = NULL;
 
     std::array<char, 256> m_buffer;
 
     int32_t m_titleCount = 0;
     int32_t m_currentReadIndex = 0;
-    int32_t m_readPositions[MaxTitleCount];
+
+    IndexEntry m_page[PageSize];
+    int32_t m_pageStart = 0;
+    int32_t m_pageCount = 0;
+
+    /* playlist offset of every m_checkpointStride-th title*/
+    int32_t m_checkpoints[CheckpointCount];
+    int32_t m_checkpointCount = 0;
+    int32_t m_checkpointStride = PageSize;
 };
 }
 
@@ -0,0 +1,225 @@
+/**
+ * @file    src/common/resumetable.cpp
+ * @brief
+ *
+ * @addtogroup
+ * @{
+ */
+#include "resumetable.h"
+
+#include <stddef.h>
+#include <string.h>
+
+namespace tmb_musicplayer {
+
+static_assert(sizeof(ResumeTable::Entry) == 32, "Entry layout changed");
+
+ResumeTable::ResumeTable(ResumeStorage* storage, uint32_t capacity) :
+        m_storage(storage),
+        m_capacity(capacity) {
+}
+
+bool ResumeTable::Init() {
+    Header header;
+    if (m_storage->Read(0, &header, sizeof(header)) == false) {
+        return false;
+    }
+
+    if ((header.magic != Magic) || (header.version != Version)
+            || (header.capacity != m_capacity)) {
+        Format();
+        return true;
+    }
+
+    m_useCounter = header.useCounter;
+    return true;
+}
+
+void ResumeTable::SetSpillFile(File* file) {
+    m_spillFile = file;
+}
+
+bool ResumeTable::Find(const uint8_t* uid, uint8_t uidSize, ResumePosition& position) {
+    Entry entry;
+    int32_t slot = FindSlot(uid, uidSize, entry);
+    if (slot < 0) {
+        slot = Promote(uid, uidSize, entry);
+        if (slot < 0) {
+            return false;
+        }
+    }
+
+    entry.lastUse = NextUse();
+    WriteEntry(slot, entry);
+
+    position.playlistStamp = entry.playlistStamp;
+    position.titleIndex = entry.titleIndex;
+    position.offset = entry.offset;
+    position.decodeTime = entry.decodeTime;
+    return true;
+}
+
+bool ResumeTable::Store(const uint8_t* uid, uint8_t uidSize, const ResumePosition& position) {
+    if ((uidSize == 0) || (uidSize > MaxUIDSize)) {
+        return false;
+    }
+
+    Entry entry;
+    bool promoted = false;
+    int32_t slot = FindSlot(uid, uidSize, entry);
+    if (slot < 0) {
+        slot = Promote(uid, uidSize, entry);
+        promoted = (slot >= 0);
+    }
+
+    if (slot < 0) {
+        slot = AllocateSlot();
+        memset(&entry, 0, sizeof(entry));
+        memcpy(entry.uid, uid, uidSize);
+        entry.uidSize = uidSize;
+        entry.lastUse = NextUse();
+    } else if ((promoted == false)
+            && (entry.playlistStamp == position.playlistStamp)
+            && (entry.titleIndex == position.titleIndex)
+            && (entry.offset == position.offset)
+            && (entry.decodeTime == position.decodeTime)) {
+        // nothing changed, save the write
+        return true;
+    }
+
+    entry.playlistStamp = position.playlistStamp;
+    entry.titleIndex = position.titleIndex;
+    entry.offset = position.offset;
+    entry.decodeTime = position.decodeTime;
+    return WriteEntry(slot, entry);
+}
+
+void ResumeTable::Remove(const uint8_t* uid, uint8_t uidSize) {
+    Entry entry;
+    int32_t slot = FindSlot(uid, uidSize, entry);
+    if (slot >= 0) {
+        memset(&entry, 0, sizeof(entry));
+        WriteEntry(slot, entry);
+    }
+}
+
+bool ResumeTable::IsEntry(const Entry& entry, const uint8_t* uid, uint8_t uidSize) {
+    return (entry.uidSize != 0) && (entry.uidSize == uidSize)
+            && (memcmp(entry.uid, uid, uidSize) == 0);
+}
+
+void ResumeTable::Format() {
+    Entry entry;
+    memset(&entry, 0, sizeof(entry));
+    for (uint32_t slot = 0; slot < m_capacity; ++slot) {
+        WriteEntry(slot, entry);
+    }
+
+    m_useCounter = 0;
+    Header header = {Magic, Version, m_capacity, m_useCounter};
+    m_storage->Write(0, &header, sizeof(header));
+}
+
+int32_t ResumeTable::FindSlot(const uint8_t* uid, uint8_t uidSize, Entry& entry) {
+    for (uint32_t slot = 0; slot < m_capacity; ++slot) {
+        if (ReadEntry(slot, entry) && IsEntry(entry, uid, uidSize)) {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+uint32_t ResumeTable::ChooseSlot(Entry& victim) {
+    // a free entry or the least recently used one
+    uint32_t victimSlot = 0;
+    uint32_t oldest = 0;
+    Entry entry;
+    for (uint32_t slot = 0; slot < m_capacity; ++slot) {
+        if (ReadEntry(slot, entry) == false) {
+            continue;
+        }
+        if (entry.uidSize == 0) {
+            victim = entry;
+            return slot;
+        }
+        uint32_t age = m_useCounter - entry.lastUse;
+        if ((slot == 0) || (age > oldest)) {
+            oldest = age;
+            victimSlot = slot;
+            victim = entry;
+        }
+    }
+    return victimSlot;
+}
+
+int32_t ResumeTable::AllocateSlot() {
+    Entry victim;
+    uint32_t slot = ChooseSlot(victim);
+    if (victim.uidSize != 0) {
+        Spill(victim);
+    }
+    return slot;
+}
+
+int32_t ResumeTable::Promote(const uint8_t* uid, uint8_t uidSize, Entry& entry) {
+    if (m_spillFile == NULL) {
+        return -1;
+    }
+
+    int32_t pos = 0;
+    while (m_spillFile->Seek(pos)
+            && (m_spillFile->Read(&entry, sizeof(entry)) == sizeof(entry))) {
+        if (IsEntry(entry, uid, uidSize)) {
+            // swap with the entry leaving the table, a free one leaves a hole
+            Entry victim;
+            uint32_t slot = ChooseSlot(victim);
+            if (m_spillFile->Seek(pos)) {
+                m_spillFile->Write(&victim, sizeof(victim));
+                m_spillFile->Sync();
+            }
+            return slot;
+        }
+        pos += sizeof(entry);
+    }
+    return -1;
+}
+
+bool ResumeTable::Spill(const Entry& entry) {
+    if (m_spillFile == NULL) {
+        return false;
+    }
+
+    // reuse a hole, append otherwise
+    int32_t pos = 0;
+    Entry spilled;
+    while (m_spillFile->Seek(pos)
+            && (m_spillFile->Read(&spilled, sizeof(spilled)) == sizeof(spilled))) {
+        if (spilled.uidSize == 0) {
+            break;
+        }
+        pos += sizeof(spilled);
+    }
+
+    if ((m_spillFile->Seek(pos) == false)
+            || (m_spillFile->Write(&entry, sizeof(entry)) != sizeof(entry))) {
+        return false;
+    }
+    return m_spillFile->Sync();
+}
+
+uint32_t ResumeTable::NextUse() {
+    ++m_useCounter;
+    m_storage->Write(offsetof(Header, useCounter), &m_useCounter, sizeof(m_useCounter));
+    return m_useCounter;
+}
+
+bool ResumeTable::ReadEntry(uint32_t slot, Entry& entry) {
+    return m_storage->Read(sizeof(Header) + slot * sizeof(Entry), &entry, sizeof(entry));
+}
+
+bool ResumeTable::WriteEntry(uint32_t slot, const Entry& entry) {
+    return m_storage->Write(sizeof(Header) + slot * sizeof(Entry), &entry, sizeof(entry));
+}
+
+}
+/** @} */
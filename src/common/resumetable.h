@@ -0,0 +1,125 @@
+/**
+ * @file    src/common/resumetable.h
+ *
+ * @brief Persistent resume positions per card
+ *
+ * @addtogroup
+ * @{
+ */
+
+#ifndef _RESUMETABLE_H_
+#define _RESUMETABLE_H_
+
+#include <stdint.h>
+
+#include "file.h"
+
+namespace tmb_musicplayer
+{
+
+/**
+ * @brief   Small byte addressed non volatile memory, e.g. backup SRAM.
+ */
+class ResumeStorage
+{
+public:
+    virtual ~ResumeStorage() {}
+
+    virtual bool Read(uint32_t offset, void* data, uint32_t size) = 0;
+    virtual bool Write(uint32_t offset, const void* data, uint32_t size) = 0;
+};
+
+struct ResumePosition
+{
+    /* Timestamp of the playlist the title index belongs to.*/
+    uint32_t playlistStamp;
+    int32_t titleIndex;
+    /* File offset of the first byte not yet sent to the codec.*/
+    uint32_t offset;
+    /* Decode time of the codec in seconds.*/
+    uint32_t decodeTime;
+};
+
+/**
+ * @brief   Maps card UIDs to the position playback stopped at.
+ * @details The table lives in the storage and is never copied to RAM, a
+ *          lookup reads the entries one by one and an update only writes
+ *          the single entry that changed. If the table is full the least
+ *          recently used entry is moved to the spill file on the SD card,
+ *          a lookup that misses the table moves the entry back and the
+ *          evicted one into its place.
+ */
+class ResumeTable
+{
+public:
+    static const uint32_t MaxUIDSize = 10;
+    static const uint32_t Magic = 0x454D5352; // "RSME"
+    static const uint32_t Version = 1;
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t capacity;
+        uint32_t useCounter;
+    };
+
+    struct Entry
+    {
+        uint8_t uid[MaxUIDSize];
+        /* 0 marks a free entry.*/
+        uint8_t uidSize;
+        uint8_t reserved;
+        uint32_t playlistStamp;
+        int32_t titleIndex;
+        uint32_t offset;
+        uint32_t decodeTime;
+        uint32_t lastUse;
+    };
+
+    ResumeTable(ResumeStorage* storage, uint32_t capacity);
+
+    /*
+     * Loads the header, the table is cleared if it is not valid.
+     */
+    bool Init();
+
+    /*
+     * The spill file has to be open for reading and writing, NULL drops
+     * entries which do not fit the table.
+     */
+    void SetSpillFile(File* file);
+
+    bool Find(const uint8_t* uid, uint8_t uidSize, ResumePosition& position);
+    bool Store(const uint8_t* uid, uint8_t uidSize, const ResumePosition& position);
+    void Remove(const uint8_t* uid, uint8_t uidSize);
+
+    /* Size of the table in the storage.*/
+    static uint32_t StorageSize(uint32_t capacity) {
+        return sizeof(Header) + capacity * sizeof(Entry);
+    }
+
+private:
+    static bool IsEntry(const Entry& entry, const uint8_t* uid, uint8_t uidSize);
+
+    void Format();
+    int32_t FindSlot(const uint8_t* uid, uint8_t uidSize, Entry& entry);
+    uint32_t ChooseSlot(Entry& victim);
+    int32_t AllocateSlot();
+    int32_t Promote(const uint8_t* uid, uint8_t uidSize, Entry& entry);
+    bool Spill(const Entry& entry);
+    uint32_t NextUse();
+
+    bool ReadEntry(uint32_t slot, Entry& entry);
+    bool WriteEntry(uint32_t slot, const Entry& entry);
+
+    ResumeStorage* m_storage;
+    File* m_spillFile = NULL;
+    uint32_t m_capacity;
+    uint32_t m_useCounter = 0;
+};
+}
+
+#endif /* _RESUMETABLE_H_ */
+
+/** @} */
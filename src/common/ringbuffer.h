@@ -0,0 +1,83 @@
+/**
+ * @file    src/common/ringbuffer.h
+ *
+ * @brief Single producer / single consumer byte ring buffer
+ *
+ * @addtogroup
+ * @{
+ */
+
+#ifndef _RINGBUFFER_H_
+#define _RINGBUFFER_H_
+
+#include <stdint.h>
+
+namespace tmb_musicplayer
+{
+
+/**
+ * @brief   Byte ring buffer with free running read and write indices.
+ * @details The producer can fill the buffer in place via WritePointer()
+ *          and Commit(), the consumer drains it via ReadPointer() and
+ *          Consume(). Both sides only get the contiguous part up to the
+ *          end of the underlying storage.
+ */
+template <uint32_t Size>
+class RingBuffer
+{
+public:
+    static_assert((Size > 0) && ((Size & (Size - 1)) == 0), "Size must be a power of two");
+
+    RingBuffer() {
+    }
+
+    void Reset() {
+        m_readIndex = 0;
+        m_writeIndex = 0;
+    }
+
+    uint32_t Level() const {
+        return m_writeIndex - m_readIndex;
+    }
+
+    uint32_t Free() const {
+        return Size - Level();
+    }
+
+    uint8_t* WritePointer(uint32_t& contiguous) {
+        uint32_t offset = m_writeIndex & (Size - 1);
+        contiguous = Size - offset;
+        if (contiguous > Free()) {
+            contiguous = Free();
+        }
+        return &m_buffer[offset];
+    }
+
+    void Commit(uint32_t bytes) {
+        m_writeIndex += bytes;
+    }
+
+    const uint8_t* ReadPointer(uint32_t& contiguous) const {
+        uint32_t offset = m_readIndex & (Size - 1);
+        contiguous = Size - offset;
+        if (contiguous > Level()) {
+            contiguous = Level();
+        }
+        return &m_buffer[offset];
+    }
+
+    void Consume(uint32_t bytes) {
+        m_readIndex += bytes;
+    }
+
+private:
+    uint8_t m_buffer[Size];
+    volatile uint32_t m_readIndex = 0;
+    volatile uint32_t m_writeIndex = 0;
+};
+
+}
+
+#endif /* _RINGBUFFER_H_ */
+
+/** @} */
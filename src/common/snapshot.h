@@ -0,0 +1,66 @@
+/**
+ * @file    src/common/snapshot.h
+ *
+ * @brief Single writer snapshot readable without locking
+ *
+ * @addtogroup
+ * @{
+ */
+
+#ifndef _SNAPSHOT_H_
+#define _SNAPSHOT_H_
+
+#include <stdint.h>
+
+namespace tmb_musicplayer
+{
+
+/**
+ * @brief   Double buffered value with a sequence counter.
+ * @details The writer fills the buffer readers are not pointed to and then
+ *          publishes it by incrementing the sequence. A reader copies the
+ *          published buffer and retries if the sequence changed meanwhile,
+ *          which only happens if the writer ran in between. A reader never
+ *          waits for an interrupted writer, so neither side has to disable
+ *          interrupts. There must only be a single writer.
+ */
+template <typename T>
+class Snapshot
+{
+public:
+    Snapshot() {
+    }
+
+    void Publish(const T& value) {
+        uint32_t next = m_sequence + 1;
+        m_buffers[next & 1] = value;
+        __atomic_store_n(&m_sequence, next, __ATOMIC_RELEASE);
+    }
+
+    void Read(T& value) const {
+        uint32_t sequence = __atomic_load_n(&m_sequence, __ATOMIC_ACQUIRE);
+        while (true) {
+            value = m_buffers[sequence & 1];
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            uint32_t current = __atomic_load_n(&m_sequence, __ATOMIC_ACQUIRE);
+            if (current == sequence) {
+                break;
+            }
+            sequence = current;
+        }
+    }
+
+    uint32_t Sequence() const {
+        return __atomic_load_n(&m_sequence, __ATOMIC_ACQUIRE);
+    }
+
+private:
+    T m_buffers[2] = {};
+    uint32_t m_sequence = 0;
+};
+
+}
+
+#endif /* _SNAPSHOT_H_ */
+
+/** @} */
@@ -0,0 +1,108 @@
+/**
+ * @file    src/common/tracering.h
+ *
+ * @brief Lock-free ring of binary trace records
+ *
+ * @addtogroup
+ * @{
+ */
+
+#ifndef _TRACERING_H_
+#define _TRACERING_H_
+
+#include <stdint.h>
+
+namespace tmb_musicplayer
+{
+
+struct TraceRecord {
+    uint32_t time;
+    uint32_t event;
+    uint32_t arg0;
+    uint32_t arg1;
+};
+
+/**
+ * @brief   Bounded ring with many writers and a single reader.
+ * @details A writer claims a slot by advancing the head with a compare and
+ *          swap, fills it and hands it to the reader through the sequence
+ *          number of the slot. Nothing ever waits, so threads and
+ *          interrupt handlers can write. A full ring drops the record and
+ *          counts it. A claimed slot which is not filled yet holds the
+ *          reader back until its writer continues. Size has to be a power
+ *          of two.
+ */
+template <uint32_t Size>
+class TraceRing
+{
+    static_assert((Size & (Size - 1)) == 0, "Size must be a power of two");
+
+public:
+    TraceRing() {
+        for (uint32_t i = 0; i < Size; i++) {
+            m_slots[i].sequence = i;
+        }
+    }
+
+    bool Write(uint32_t time, uint32_t event, uint32_t arg0, uint32_t arg1) {
+        uint32_t position = __atomic_load_n(&m_head, __ATOMIC_RELAXED);
+        Slot* slot;
+        while (true) {
+            slot = &m_slots[position & (Size - 1)];
+            uint32_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+            int32_t lag = (int32_t)(sequence - position);
+            if (lag == 0) {
+                if (__atomic_compare_exchange_n(&m_head, &position, position + 1,
+                        true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                    break;
+                }
+            } else if (lag < 0) {
+                __atomic_fetch_add(&m_dropped, 1, __ATOMIC_RELAXED);
+                return false;
+            } else {
+                position = __atomic_load_n(&m_head, __ATOMIC_RELAXED);
+            }
+        }
+
+        slot->record.time = time;
+        slot->record.event = event;
+        slot->record.arg0 = arg0;
+        slot->record.arg1 = arg1;
+        __atomic_store_n(&slot->sequence, position + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    /* Only one thread may read.*/
+    bool Read(TraceRecord& record) {
+        Slot* slot = &m_slots[m_tail & (Size - 1)];
+        uint32_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        if (sequence != (m_tail + 1)) {
+            return false;
+        }
+        record = slot->record;
+        __atomic_store_n(&slot->sequence, m_tail + Size, __ATOMIC_RELEASE);
+        m_tail++;
+        return true;
+    }
+
+    uint32_t Dropped() const {
+        return __atomic_load_n(&m_dropped, __ATOMIC_RELAXED);
+    }
+
+private:
+    struct Slot {
+        uint32_t sequence;
+        TraceRecord record;
+    };
+
+    Slot m_slots[Size];
+    uint32_t m_head = 0;
+    uint32_t m_tail = 0;
+    uint32_t m_dropped = 0;
+};
+
+}
+
+#endif /* _TRACERING_H_ */
+
+/** @} */
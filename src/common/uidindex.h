@@ -0,0 +1,148 @@
+/**
+ * @file    src/common/uidindex.h
+ *
+ * @brief Sorted index of card UID directory names
+ *
+ * @addtogroup
+ * @{
+ */
+
+#ifndef _UIDINDEX_H_
+#define _UIDINDEX_H_
+
+#include <stdint.h>
+#include <string.h>
+
+namespace tmb_musicplayer
+{
+
+/**
+ * @brief   Maps card UIDs to the short name of their directory.
+ * @details Directory names are the UID as hex string, they are stored
+ *          binary and sorted so a lookup is a binary search. Names which
+ *          are no UID are ignored. If more directories are added than the
+ *          index can hold it is marked incomplete.
+ */
+template <uint32_t Capacity>
+class UIDIndex
+{
+public:
+    static const uint32_t MaxUIDSize = 10;
+    static const uint32_t ShortNameSize = 13;
+
+    UIDIndex() {
+    }
+
+    void Clear() {
+        m_count = 0;
+        m_complete = true;
+    }
+
+    uint32_t Count() const {
+        return m_count;
+    }
+
+    bool IsComplete() const {
+        return m_complete;
+    }
+
+    bool Add(const char* name, const char* shortName) {
+        Entry entry;
+        if ((ParseUID(name, entry) == false) || (strlen(shortName) >= ShortNameSize)) {
+            return false;
+        }
+
+        if (m_count == Capacity) {
+            m_complete = false;
+            return false;
+        }
+
+        // insert sorted, duplicates keep the first directory
+        uint32_t pos = LowerBound(entry);
+        if ((pos < m_count) && (Compare(m_entries[pos], entry) == 0)) {
+            return false;
+        }
+        memmove(&m_entries[pos + 1], &m_entries[pos], (m_count - pos) * sizeof(Entry));
+        strcpy(entry.shortName, shortName);
+        m_entries[pos] = entry;
+        m_count++;
+        return true;
+    }
+
+    const char* Find(const char* name) const {
+        Entry entry;
+        if (ParseUID(name, entry) == false) {
+            return NULL;
+        }
+
+        uint32_t pos = LowerBound(entry);
+        if ((pos < m_count) && (Compare(m_entries[pos], entry) == 0)) {
+            return m_entries[pos].shortName;
+        }
+        return NULL;
+    }
+
+private:
+    struct Entry
+    {
+        uint8_t uid[MaxUIDSize];
+        uint8_t uidSize;
+        char shortName[ShortNameSize];
+    };
+
+    static bool ParseUID(const char* name, Entry& entry) {
+        uint32_t length = strlen(name);
+        if ((length == 0) || (length > (2 * MaxUIDSize)) || (length & 1)) {
+            return false;
+        }
+
+        memset(&entry, 0, sizeof(entry));
+        for (uint32_t i = 0; i < length; i++) {
+            char c = name[i];
+            uint8_t nibble;
+            if ((c >= '0') && (c <= '9')) {
+                nibble = c - '0';
+            } else if ((c >= 'A') && (c <= 'F')) {
+                nibble = c - 'A' + 10;
+            } else if ((c >= 'a') && (c <= 'f')) {
+                nibble = c - 'a' + 10;
+            } else {
+                return false;
+            }
+            entry.uid[i / 2] = (entry.uid[i / 2] << 4) | nibble;
+        }
+        entry.uidSize = length / 2;
+        return true;
+    }
+
+    static int Compare(const Entry& a, const Entry& b) {
+        if (a.uidSize != b.uidSize) {
+            return (a.uidSize < b.uidSize) ? -1 : 1;
+        }
+        return memcmp(a.uid, b.uid, a.uidSize);
+    }
+
+    uint32_t LowerBound(const Entry& entry) const {
+        uint32_t first = 0;
+        uint32_t last = m_count;
+        while (first < last) {
+            uint32_t middle = first + (last - first) / 2;
+            if (Compare(m_entries[middle], entry) < 0) {
+                first = middle + 1;
+            } else {
+                last = middle;
+            }
+        }
+        return first;
+    }
+
+    Entry m_entries[Capacity];
+    uint32_t m_count = 0;
+    bool m_complete = true;
+};
+
+}
+
+#endif /* _UIDINDEX_H_ */
+
+/** @} */
@@ -0,0 +1,336 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef _FAKEMFRC522_H_
+#define _FAKEMFRC522_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include "common/cardsensor.h"
+
+/*
+ * Register level stand in for the MFRC522 running on a virtual clock in
+ * milliseconds. A script of time windows decides when which card is in
+ * the field. The card follows the ISO 14443-3 states for REQA, WUPA,
+ * anticollision and HLTA and starts IDLE every time it is placed. The IRQ
+ * line follows ComIrqReg and ComIEnReg like on the chip.
+ */
+class FakeMFRC522 : public tmb_musicplayer::MFRC522Port {
+ public:
+    typedef tmb_musicplayer::CardSensor CS;
+
+    /* Time from StartSend to the end of the ATQA.*/
+    static const uint32_t AnswerTime = 1;
+    /* TPrescaler and TReload as set up by the driver.*/
+    static const uint32_t TimerPeriod = 25;
+
+    /* Only used by the full UID read of the driver.*/
+    static const uint8_t DivIrqReg = 0x05;
+    static const uint8_t CRCResultRegH = 0x21;
+    static const uint8_t CRCResultRegL = 0x22;
+    static const uint8_t PCD_CalcCRC = 0x03;
+    static const uint8_t CRCIRq = 0x04;
+    static const uint8_t PICC_ANTICOLL_CL2 = 0x95;
+    static const uint8_t PICC_SELECT = 0x70;
+    /* SAK of a MIFARE Classic 1K and of an incomplete UID.*/
+    static const uint8_t SakComplete = 0x08;
+    static const uint8_t SakCascade = 0x04;
+
+    FakeMFRC522() {
+        memset(regs, 0, sizeof(regs));
+    }
+
+    enum CardState {
+        Idle,
+        Ready,
+        Active,
+        Halt,
+    };
+
+    /* The card is in the field from start until end, end excluded.*/
+    void PlaceCard(uint32_t start, uint32_t end,
+            std::vector<uint8_t> uid = std::vector<uint8_t>{0x04, 0xA1, 0xB2, 0xC3}) {
+        m_windows.push_back(Window{start, end, uid});
+    }
+
+    bool CardPresent(uint32_t time) const {
+        return FindWindow(time) >= 0;
+    }
+
+    /* Stands in for the full UID read of the driver.*/
+    bool SelectCard() {
+        Update();
+        if (m_window < 0 || m_state == Halt) {
+            return false;
+        }
+        m_state = Active;
+        return true;
+    }
+
+    /* State of the card in the field now, Idle if there is none.*/
+    CardState State() {
+        Update();
+        return m_state;
+    }
+
+    uint32_t Now() const {
+        return m_now;
+    }
+
+    void Advance(uint32_t ms) {
+        m_now += ms;
+        Update();
+    }
+
+    bool IRQAsserted() const {
+        return (regs[CS::ComIrqReg] & regs[CS::ComIEnReg] & 0x7F) != 0;
+    }
+
+    virtual void WriteRegister(uint8_t addr, uint8_t val) {
+        ++registerAccesses;
+        addr &= 0x3F;
+        switch (addr) {
+        case CS::ComIrqReg:
+            if (val & 0x80) {
+                regs[addr] |= val & 0x7F;
+            } else {
+                regs[addr] &= ~val;
+            }
+            break;
+        case DivIrqReg:
+            if (val & 0x80) {
+                regs[addr] |= val & 0x7F;
+            } else {
+                regs[addr] &= ~val;
+            }
+            break;
+        case CS::FIFOLevelReg:
+            if (val & CS::FlushBuffer) {
+                m_fifo.clear();
+            }
+            break;
+        case CS::FIFODataReg:
+            m_fifo.push_back(val);
+            break;
+        case CS::CommandReg:
+            regs[addr] = val;
+            if (val == CS::PCD_Idle) {
+                m_pending = false;
+            } else if (val == PCD_CalcCRC) {
+                uint16_t crc = CRC(m_fifo);
+                m_fifo.clear();
+                regs[CRCResultRegL] = crc & 0xFF;
+                regs[CRCResultRegH] = crc >> 8;
+                regs[DivIrqReg] |= CRCIRq;
+            } else if (val == CS::PCD_Transmit) {
+                Transceive();
+            }
+            break;
+        case CS::BitFramingReg:
+            regs[addr] = val;
+            if ((val & CS::StartSend) && regs[CS::CommandReg] == CS::PCD_Transceive) {
+                Transceive();
+            }
+            break;
+        default:
+            regs[addr] = val;
+            break;
+        }
+    }
+
+    virtual uint8_t ReadRegister(uint8_t addr) {
+        ++registerAccesses;
+        addr &= 0x3F;
+        Update();
+        if (addr == CS::FIFOLevelReg) {
+            return static_cast<uint8_t>(m_fifo.size());
+        }
+        if (addr == CS::FIFODataReg) {
+            if (m_fifo.empty()) {
+                return 0;
+            }
+            uint8_t val = m_fifo.front();
+            m_fifo.erase(m_fifo.begin());
+            return val;
+        }
+        return regs[addr];
+    }
+
+    virtual void ClearIRQ() {
+    }
+
+    virtual bool WaitIRQ(uint32_t timeout) {
+        ++waits;
+        if (IRQAsserted()) {
+            return true;
+        }
+        if (m_pending && m_pendingAt <= m_now + timeout) {
+            m_now = m_pendingAt;
+            Update();
+            return IRQAsserted();
+        }
+        m_now += timeout;
+        Update();
+        return IRQAsserted();
+    }
+
+    uint8_t regs[0x40];
+    uint32_t registerAccesses = 0;
+    uint32_t waits = 0;
+    uint32_t requests = 0;
+
+ private:
+    struct Window {
+        uint32_t start;
+        uint32_t end;
+        std::vector<uint8_t> uid;
+    };
+
+    int FindWindow(uint32_t time) const {
+        for (size_t i = 0; i < m_windows.size(); ++i) {
+            if (time >= m_windows[i].start && time < m_windows[i].end) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    void Transceive() {
+        ++requests;
+        Update();
+        std::vector<uint8_t> frame;
+        frame.swap(m_fifo);
+        m_pending = true;
+        m_pendingAnswer.clear();
+        if (m_window >= 0) {
+            m_pendingAnswer = Answer(frame, regs[CS::BitFramingReg] & 0x07);
+        }
+        if (regs[CS::CommandReg] == CS::PCD_Transmit) {
+            m_pendingAt = m_now + AnswerTime;
+            m_pendingIrq = CS::IdleIRq;
+        } else if (!m_pendingAnswer.empty()) {
+            m_pendingAt = m_now + AnswerTime;
+            m_pendingIrq = CS::RxIRq;
+        } else {
+            m_pendingAt = m_now + TimerPeriod;
+            m_pendingIrq = CS::TimerIRq;
+        }
+    }
+
+    std::vector<uint8_t> Answer(const std::vector<uint8_t>& frame, uint8_t bits) {
+        // ATQA of a MIFARE Classic 1K
+        static const std::vector<uint8_t> atqa{0x04, 0x00};
+        const std::vector<uint8_t>& uid = m_windows[m_window].uid;
+
+        if (bits == CS::ShortFrameBits && frame.size() == 1) {
+            if (frame[0] == CS::PICC_REQA && m_state == Idle) {
+                m_state = Ready;
+                return atqa;
+            }
+            if (frame[0] == CS::PICC_WUPA && (m_state == Idle || m_state == Halt)) {
+                m_state = Ready;
+                return atqa;
+            }
+        } else if (frame.size() == 2 && frame[1] == 0x20 && m_state == Ready &&
+                (frame[0] == CS::PICC_ANTICOLL_CL1 || frame[0] == PICC_ANTICOLL_CL2)) {
+            std::vector<uint8_t> answer = CascadeLevel(frame[0]);
+            if (!answer.empty()) {
+                answer.push_back(answer[0] ^ answer[1] ^ answer[2] ^ answer[3]);
+                return answer;
+            }
+        } else if (frame.size() == 9 && frame[1] == PICC_SELECT && m_state == Ready &&
+                (frame[0] == CS::PICC_ANTICOLL_CL1 || frame[0] == PICC_ANTICOLL_CL2)) {
+            std::vector<uint8_t> level = CascadeLevel(frame[0]);
+            if (!level.empty() && std::equal(level.begin(), level.end(), frame.begin() + 2)) {
+                bool complete = (frame[0] == PICC_ANTICOLL_CL2) || (uid.size() <= 4);
+                if (complete) {
+                    m_state = Active;
+                }
+                std::vector<uint8_t> sak{complete ? SakComplete : SakCascade};
+                uint16_t crc = CRC(sak);
+                sak.push_back(crc & 0xFF);
+                sak.push_back(crc >> 8);
+                return sak;
+            }
+        } else if (frame.size() == 4 && frame[0] == CS::PICC_HLTA && m_state == Active) {
+            m_state = Halt;
+            return std::vector<uint8_t>();
+        }
+
+        // anything unexpected sends READY and ACTIVE cards back to IDLE
+        if (m_state == Ready || m_state == Active) {
+            m_state = Idle;
+        }
+        return std::vector<uint8_t>();
+    }
+
+    /* The four UID bytes a cascade level reports, empty if there is none.*/
+    std::vector<uint8_t> CascadeLevel(uint8_t level) const {
+        const std::vector<uint8_t>& uid = m_windows[m_window].uid;
+        std::vector<uint8_t> bytes;
+        if (level == CS::PICC_ANTICOLL_CL1) {
+            if (uid.size() > 4) {
+                bytes.push_back(uint8_t(CS::CascadeTag));
+                bytes.insert(bytes.end(), uid.begin(), uid.begin() + 3);
+            } else {
+                bytes = uid;
+            }
+        } else if (uid.size() > 4) {
+            bytes.assign(uid.begin() + 3, uid.end());
+        }
+        return bytes;
+    }
+
+    /* CRC_A of ISO 14443-3 as the coprocessor computes it.*/
+    static uint16_t CRC(const std::vector<uint8_t>& data) {
+        uint16_t crc = 0x6363;
+        for (size_t i = 0; i < data.size(); ++i) {
+            uint8_t b = data[i] ^ (crc & 0xFF);
+            b ^= b << 4;
+            crc = (crc >> 8) ^ (uint16_t(b) << 8) ^ (uint16_t(b) << 3) ^ (b >> 4);
+        }
+        return crc;
+    }
+
+    void Update() {
+        int window = FindWindow(m_now);
+        if (window != m_window) {
+            // a card put on the reader powers up IDLE
+            m_window = window;
+            m_state = Idle;
+        }
+        if (m_pending && m_now >= m_pendingAt) {
+            m_pending = false;
+            regs[CS::ComIrqReg] |= m_pendingIrq;
+            if (m_pendingIrq == CS::RxIRq) {
+                m_fifo = m_pendingAnswer;
+            }
+        }
+    }
+
+    std::vector<Window> m_windows;
+    std::vector<uint8_t> m_fifo;
+    std::vector<uint8_t> m_pendingAnswer;
+    int m_window = -1;
+    CardState m_state = Idle;
+    uint32_t m_now = 0;
+    bool m_pending = false;
+    uint32_t m_pendingAt = 0;
+    uint8_t m_pendingIrq = 0;
+};
+
+#endif /* _FAKEMFRC522_H_ */
@@ -0,0 +1,149 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef _TESTFILE_H_
+#define _TESTFILE_H_
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+
+#include "common/file.h"
+
+/*
+ * tmb_musicplayer::File backed by a std::fstream, stands in for FFile in
+ * host tests. Like FFile, Create opens an existing file without truncating
+ * it.
+ */
+class TestFile : public tmb_musicplayer::File {
+ public:
+    TestFile() {
+    }
+
+    virtual bool Open(const char* path) {
+        m_file.open(path, std::ios::in | std::ios::binary);
+        if (m_file.fail()) {
+            return false;
+        }
+        m_path = path;
+        ReadSize();
+        return true;
+    }
+    virtual bool Close() {
+        m_file.close();
+        return true;
+    }
+    virtual bool Sync() {
+        return true;
+    }
+    virtual bool Create(const char* path) {
+        m_file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+        if (m_file.fail()) {
+            m_file.clear();
+            m_file.open(path, std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+            if (m_file.fail()) {
+                return false;
+            }
+        }
+        m_path = path;
+        ReadSize();
+        return true;
+    }
+
+    virtual uint32_t GetString(char* buffer, uint32_t bufferSize) {
+        if (IsEOF()) {
+            return false;
+        }
+        std::string line;
+        getStringCalls++;
+        if (std::getline(m_file, line)) {
+            if (line.size() < bufferSize) {
+                std::copy(line.begin(), line.end(), buffer);
+                return line.size();
+            }
+        }
+        return 0;
+    }
+
+    virtual int32_t WriteString(const char* str) {
+        return 0;
+    }
+
+    virtual int32_t Read(void* buffer, uint32_t size) {
+        m_file.read(static_cast<char*>(buffer), size);
+        return m_file.gcount();
+    }
+
+    virtual int32_t Write(const void* data, uint32_t size) {
+        m_file.write(static_cast<const char*>(data), size);
+        if (m_file.fail()) {
+            return -1;
+        }
+        m_size = std::max(m_size, (int32_t)m_file.tellp());
+        return size;
+    }
+
+    virtual int32_t Tell() {
+        return m_file.tellg();
+    }
+
+    virtual bool Seek(int32_t pos) {
+        m_file.clear();
+        return m_file.seekg(pos, std::ios::beg) ? true : false;
+    }
+
+    virtual bool Truncate() {
+        int32_t pos = m_file.tellp();
+        m_file.flush();
+        if ((pos < 0) || (truncate(m_path.c_str(), pos) != 0)) {
+            return false;
+        }
+        m_size = pos;
+        return true;
+    }
+
+    virtual int32_t Size() {
+        return m_size;
+    }
+
+    virtual bool Error() {
+        return m_file.fail();
+    }
+
+    virtual bool IsEOF() {
+        return  m_file.eof();
+    }
+
+    virtual uint32_t Timestamp() {
+        return timestamp;
+    }
+
+    uint32_t timestamp = 0x4A8B6000;
+    uint32_t getStringCalls = 0;
+
+ private:
+    void ReadSize() {
+        m_file.seekg(0, std::ios::end);
+        m_size = m_file.tellg();
+        m_file.seekg(0, std::ios::beg);
+    }
+
+    std::fstream m_file;
+    std::string m_path;
+    int32_t m_size = 0;
+};
+
+#endif /* _TESTFILE_H_ */
@@ -16,6 +16,7 @@
 
 #include "ch_tools.h"
 #include "chprintf.h"
+#include "trace.h"
 
 #include "qhal.h"
 #include "module_init_cpp.h"
@@ -112,8 +113,9 @@ void ModuleCardreader::ThreadMain()
 
 void ModuleCardreader::OnCardRemoved()
 {
-    chprintf(DEBUG_CANNEL, "ModuleCardreader: Memory card removed.\r\n");
+    trace_event(TRACE_CARDREADER_REMOVED, 0, 0);
 
+    InvalidateUIDIndex();
     UnmountFilesystem();
 
     m_evtSource.broadcastFlags(FilesystemUnmounted);
@@ -123,10 +125,11 @@ void ModuleCardreader::OnCardRemoved()
 
 void ModuleCardreader::OnCardInserted()
 {
-    chprintf(DEBUG_CANNEL, "ModuleCardreader: Memory card inserted.\r\n");
+    trace_event(TRACE_CARDREADER_INSERTED, 0, 0);
 
     if (MountFilesystem() == true)
     {
+        BuildUIDIndex();
         m_evtSource.broadcastFlags(FilesystemMounted);
         SetCardDetectLed(true);
     }
@@ -139,15 +142,14 @@ bool ModuleCardreader::MountFilesystem()
         FRESULT err;
         err = f_mount(&m_filesystem, "/mount/", 1);
         if (err != FR_OK) {
-            chprintf(DEBUG_CANNEL, "ModuleCardreader: FS: f_mount() failed. Is the SD card inserted?\r\n");
-            PrintFilesystemError(DEBUG_CANNEL, err);
+            trace_event(TRACE_CARDREADER_MOUNT_FAILED, err, 0);
             return false;
         }
-        chprintf(DEBUG_CANNEL, "ModuleCardreader: FS: f_mount() succeeded\r\n");
+        trace_event(TRACE_CARDREADER_MOUNTED, 0, 0);
 
         return true;
     }
-    chprintf(DEBUG_CANNEL, "ModuleCardreader: Failed to connect sdc card.\r\n");
+    trace_event(TRACE_CARDREADER_CONNECT_FAILED, 0, 0);
 
     return false;
 }
@@ -160,12 +162,11 @@ bool ModuleCardreader::UnmountFilesystem()
 
     sdcDisconnect(&SDCD1);
     if (err != FR_OK) {
-        chprintf(DEBUG_CANNEL, "ModuleCardreader: FS: f_mount() unmount failed\r\n");
-        PrintFilesystemError(DEBUG_CANNEL, err);
+        trace_event(TRACE_CARDREADER_UNMOUNT_FAILED, err, 0);
         return false;
     }
 
-    chprintf(DEBUG_CANNEL, "ModuleCardreader: FS: f_mount() unmount succeeded\r\n");
+    trace_event(TRACE_CARDREADER_UNMOUNTED, 0, 0);
     return true;
 }
 
@@ -211,6 +212,124 @@ bool ModuleCardreader::CommandFind(DIR* dp, FILINFO* fno, const char* path, cons
     return false;
 }
 
+bool ModuleCardreader::FindUIDDirectory(const char* uid, char* path, uint32_t pathSize)
+{
+    bool found = false;
+
+    m_uidIndexMutex.lock();
+    if (m_uidIndexValid == false)
+    {
+        FillUIDIndex();
+    }
+
+    const char* shortName = m_uidIndex.Find(uid);
+    if (shortName != NULL)
+    {
+        found = (snprintf(path, pathSize, "%s/%s", MOD_CARDREADER_UID_DIRECTORY, shortName) < (int)pathSize);
+    }
+    else if ((m_uidIndexValid == false) || (m_uidIndex.IsComplete() == false))
+    {
+        /* the index could not hold all directories, search the directory*/
+        DIR directory;
+        FILINFO fileInfo;
+#if _USE_LFN
+        fileInfo.lfname = m_lfnBuffer;
+        fileInfo.lfsize = sizeof(m_lfnBuffer);
+#endif
+        if ((f_findfirst(&directory, &fileInfo, MOD_CARDREADER_UID_DIRECTORY, uid) == FR_OK)
+                && (fileInfo.fname[0] != 0))
+        {
+            found = (snprintf(path, pathSize, "%s/%s", MOD_CARDREADER_UID_DIRECTORY, fileInfo.fname) < (int)pathSize);
+        }
+    }
+    m_uidIndexMutex.unlock();
+
+    return found;
+}
+
+void ModuleCardreader::InvalidateUIDIndex()
+{
+    m_uidIndexMutex.lock();
+    m_uidIndexValid = false;
+    m_uidIndex.Clear();
+    m_uidIndexMutex.unlock();
+}
+
+void ModuleCardreader::AddUIDDirectory(const char* uid)
+{
+    char path[sizeof(MOD_CARDREADER_UID_DIRECTORY) + 2 * UIDIndex<MOD_CARDREADER_UID_INDEX_SIZE>::MaxUIDSize + 1];
+    FILINFO fno;
+#if _USE_LFN
+    fno.lfname = NULL;
+    fno.lfsize = 0;
+#endif
+
+    m_uidIndexMutex.lock();
+    if (m_uidIndexValid == true)
+    {
+        bool found = (snprintf(path, sizeof(path), "%s/%s", MOD_CARDREADER_UID_DIRECTORY, uid) < (int)sizeof(path))
+                && (f_stat(path, &fno) == FR_OK);
+        if ((found == false)
+                || ((m_uidIndex.Add(uid, fno.fname) == false) && (m_uidIndex.IsComplete() == false)))
+        {
+            /* rebuilt by the next lookup*/
+            m_uidIndexValid = false;
+            m_uidIndex.Clear();
+        }
+    }
+    m_uidIndexMutex.unlock();
+}
+
+void ModuleCardreader::BuildUIDIndex()
+{
+    m_uidIndexMutex.lock();
+    FillUIDIndex();
+    m_uidIndexMutex.unlock();
+}
+
+void ModuleCardreader::FillUIDIndex()
+{
+    m_uidIndex.Clear();
+
+    DIR dir;
+    FILINFO fno;
+#if _USE_LFN
+    fno.lfname = m_lfnBuffer;
+    fno.lfsize = sizeof(m_lfnBuffer);
+#endif
+    FRESULT res = f_opendir(&dir, MOD_CARDREADER_UID_DIRECTORY);
+    m_uidIndexValid = (res == FR_OK);
+    if (res != FR_OK)
+    {
+        return;
+    }
+
+    while (true)
+    {
+        res = f_readdir(&dir, &fno);
+        if ((res != FR_OK) || (fno.fname[0] == 0))
+        {
+            m_uidIndexValid = (res == FR_OK);
+            break;
+        }
+
+        if (fno.fattrib & AM_DIR)
+        {
+            const char* name = fno.fname;
+#if _USE_LFN
+            if (fno.lfname[0] != 0)
+            {
+                name = fno.lfname;
+            }
+#endif
+            m_uidIndex.Add(name, fno.fname);
+        }
+    }
+    f_closedir(&dir);
+
+    trace_event(TRACE_CARDREADER_UID_INDEX, m_uidIndex.Count(), m_uidIndex.IsComplete() ? 1 : 0);
+}
+
 void ModuleCardreader::PrintFilesystemError(BaseSequentialStream* chp, FRESULT err)
 {
     chprintf(chp, "ModuleCardreader: \t%s.\r\n", FilesystemResultToString(err));
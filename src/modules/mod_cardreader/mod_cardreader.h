@@ -16,18 +16,31 @@
 #if MOD_CARDREADER
 
 #include "ff.h"
+#include "uidindex.h"
 
 /*===========================================================================*/
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 #ifndef MOD_CARDREADER_THREADSIZE
-#define MOD_CARDREADER_THREADSIZE 512
+#define MOD_CARDREADER_THREADSIZE 1536
 #endif
 
 #ifndef MOD_CARDREADER_THREADPRIO
 #define MOD_CARDREADER_THREADPRIO LOWPRIO
 #endif
 
+/*
+ * Number of card directories held by the UID index, further directories
+ * are found by searching the directory.
+ */
+#ifndef MOD_CARDREADER_UID_INDEX_SIZE
+#define MOD_CARDREADER_UID_INDEX_SIZE 256
+#endif
+
+#ifndef MOD_CARDREADER_UID_DIRECTORY
+#define MOD_CARDREADER_UID_DIRECTORY "/music"
+#endif
+
 namespace tmb_musicplayer
 {
 
@@ -55,6 +68,12 @@ public:
     bool CommandCD(const char* path);
     bool CommandFind(DIR* dp, FILINFO* fno, const char* path, const char* pattern);
 
+    bool FindUIDDirectory(const char* uid, char* path, uint32_t pathSize);
+    void InvalidateUIDIndex();
+    /* Adds a directory created for the UID, the index is only rebuilt if
+     * it is full or the directory is not found.*/
+    void AddUIDDirectory(const char* uid);
+
 protected:
     typedef qos::ThreadedModule<MOD_CARDREADER_THREADSIZE> BaseClass;
 
@@ -72,11 +91,19 @@ private:
 
     void SetCardDetectLed(bool on);
 
+    void BuildUIDIndex();
+    void FillUIDIndex();
+
     static void PrintFilesystemError(BaseSequentialStream *chp, FRESULT err);
     static const char* FilesystemResultToString(FRESULT stat);
 
     chibios_rt::EvtSource m_evtSource;
     FATFS m_filesystem;
+
+    UIDIndex<MOD_CARDREADER_UID_INDEX_SIZE> m_uidIndex;
+    chibios_rt::Mutex m_uidIndexMutex;
+    bool m_uidIndexValid = false;
+    char m_lfnBuffer[_MAX_LFN + 1];
 };
 typedef qos::Singleton<ModuleCardreader> ModuleCardreaderSingelton;
 }
@@ -81,8 +81,13 @@ void ModuleEffects::SetSpectrum(int8_t* current, int8_t* peak, int8_t bands)
     {
         msg->mode = ModeSpectrumResult;
 
-        memcpy(msg->spectrumCurrent, current, sizeof(msg->spectrumCurrent));
-        memcpy(msg->spectrumPeak, peak, sizeof(msg->spectrumPeak));
+        if (bands > Mood::MaxSpectrumBands)
+        {
+            bands = Mood::MaxSpectrumBands;
+        }
+        memcpy(msg->spectrumCurrent, current, bands);
+        memcpy(msg->spectrumPeak, peak, bands);
+        msg->spectrumBands = bands;
 
         if (m_Mailbox.post(msg, MS2ST(1)) != MSG_OK)
         {
@@ -123,7 +128,7 @@ void ModuleEffects::ThreadMain()
        {
            if (msg->mode == ModeSpectrumResult)
            {
-               currentMood->SetSpectrum(msg->spectrumCurrent, msg->spectrumPeak, sizeof(msg->spectrumPeak));
+               currentMood->SetSpectrum(msg->spectrumCurrent, msg->spectrumPeak, msg->spectrumBands);
            }
            else if (msg->mode == ModeBrightness)
            {
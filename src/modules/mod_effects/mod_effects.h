@@ -101,10 +101,9 @@ private:
     {
     public:
         PlayModes mode;
-        int8_t spectrumCurrent[5];
-        int8_t spectrumPeak[5];
-        uint8_t spare2;
-        uint8_t spare3;
+        int8_t spectrumCurrent[Mood::MaxSpectrumBands];
+        int8_t spectrumPeak[Mood::MaxSpectrumBands];
+        int8_t spectrumBands;
         float brightness;
     };
 
@@ -23,8 +23,13 @@ void MoodDefault::SwitchMode(uint8_t mode) {
 
 void MoodDefault::SetSpectrum(int8_t* current, int8_t* peak, int8_t bands)
 {
-    memcpy(m_spectrumCurrent, current, sizeof(m_spectrumCurrent));
-    memcpy(m_spectrumPeak, peak, sizeof(m_spectrumPeak));
+    if (bands > MaxSpectrumBands)
+    {
+        bands = MaxSpectrumBands;
+    }
+    memcpy(m_spectrumCurrent, current, bands);
+    memcpy(m_spectrumPeak, peak, bands);
+    m_spectrumBands = bands;
 }
 
 void MoodDefault::Draw(systime_t sysTime, DisplayBuffer* display) {
@@ -115,7 +120,8 @@ void MoodDefault::DrawSpectrum(systime_t sysTime, DisplayBuffer* display) {
                 {0xE4,0xAA,0x38},
         };
 
-    for (uint32_t i = 0; i < sizeof(m_spectrumCurrent); i++)
+    /* Bands which do not fit the display are not shown.*/
+    for (int32_t i = 0; (i < m_spectrumBands) && (i < display->width); i++)
     {
         DisplayDraw(i, 0, &m_spectrumColors[m_spectrumCurrent[i]],display);
     }
@@ -39,8 +39,9 @@ private:
     systime_t m_modeChangedTime;
     float brightness = 1.0f;
 
-    int8_t m_spectrumCurrent[5];
-    int8_t m_spectrumPeak[5];
+    int8_t m_spectrumCurrent[MaxSpectrumBands];
+    int8_t m_spectrumPeak[MaxSpectrumBands];
+    int8_t m_spectrumBands = 0;
 
     bool m_showButtons = true;
 
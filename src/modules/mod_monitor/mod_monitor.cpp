@@ -0,0 +1,162 @@
+/**
+ * @file    src/mod_monitor.c
+ * @brief
+ *
+ * @addtogroup
+ * @{
+ */
+
+#include "mod_monitor.h"
+
+#if MOD_MONITOR
+
+#include "module_init_cpp.h"
+
+#include "chprintf.h"
+
+namespace tmb_musicplayer
+{
+template <>
+ModuleMonitor ModuleMonitorSingelton::instance = tmb_musicplayer::ModuleMonitor();
+
+/**
+ * @brief
+ */
+
+ModuleMonitor::ModuleMonitor()
+{
+
+}
+
+ModuleMonitor::~ModuleMonitor()
+{
+
+}
+
+void ModuleMonitor::Init()
+{
+}
+
+void ModuleMonitor::Start()
+{
+    BaseClass::Start();
+}
+
+void ModuleMonitor::Shutdown()
+{
+    BaseClass::Shutdown();
+}
+
+void ModuleMonitor::ReadStats(MonitorStats& stats)
+{
+    m_published.Read(stats);
+}
+
+void ModuleMonitor::ThreadMain()
+{
+    chRegSetThreadName("monitor");
+
+    /* The first walk only takes the counters the loads start from.*/
+    Measure();
+    while (!chThdShouldTerminateX())
+    {
+        chThdSleep(MOD_MONITOR_INTERVAL);
+        Measure();
+        m_published.Publish(m_stats);
+#if MOD_MONITOR_REPORT
+        __atomic_store_n(&m_reportPending, true, __ATOMIC_RELEASE);
+#if !MOD_TRACE
+        Report(DEBUG_CANNEL);
+#endif
+#endif
+    }
+}
+
+void ModuleMonitor::Measure()
+{
+    m_meter.Begin(chVTGetSystemTimeX());
+    m_stats.count = 0;
+    m_stats.idle = 0;
+
+    thread_t* tp = chRegFirstThread();
+    while (tp != NULL)
+    {
+        uint32_t load = 0;
+#if CH_DBG_THREADS_PROFILING
+        /* Sampled by the system tick, a thread running shorter than a
+         * tick at a time may be missed or counted a whole tick.*/
+        load = m_meter.Sample(tp, tp->p_time);
+#endif
+        if (tp == chSysGetIdleThreadX())
+        {
+            m_stats.idle = load;
+        }
+
+        if (m_stats.count < MOD_MONITOR_MAX_THREADS)
+        {
+            ThreadStats& thread = m_stats.threads[m_stats.count++];
+            thread.name = chRegGetThreadNameX(tp);
+            thread.prio = tp->p_prio;
+            thread.load = load;
+            thread.stackFree = StackUnknown;
+#if CH_DBG_FILL_THREADS
+            /* A static thread has its descriptor at the bottom of the
+             * working area and the stack right above, the main thread
+             * runs on the startup stack.*/
+            if (tp != &ch.mainthread)
+            {
+                thread.stackFree = m_meter.UnusedStack((const uint8_t*)(tp + 1),
+                        CH_DBG_STACK_FILL_VALUE);
+            }
+#endif
+        }
+        tp = chRegNextThread(tp);
+    }
+    m_meter.End();
+
+#if CH_DBG_STATISTICS
+    uint32_t contextSwitches = ch.kernel_stats.n_ctxswc;
+    uint32_t interrupts = ch.kernel_stats.n_irq;
+    m_stats.contextSwitches = contextSwitches - m_contextSwitches;
+    m_stats.interrupts = interrupts - m_interrupts;
+    m_contextSwitches = contextSwitches;
+    m_interrupts = interrupts;
+#endif
+}
+
+void ModuleMonitor::Report(BaseSequentialStream* chp)
+{
+    if (__atomic_exchange_n(&m_reportPending, false, __ATOMIC_ACQUIRE) == false)
+    {
+        return;
+    }
+    ReadStats(m_report);
+
+    chprintf(chp, "ModuleMonitor: idle %d.%d%%, %d context switches, %d interrupts.\r\n",
+            m_report.idle / 10, m_report.idle % 10,
+            m_report.contextSwitches, m_report.interrupts);
+    for (uint32_t i = 0; i < m_report.count; i++)
+    {
+        const ThreadStats& thread = m_report.threads[i];
+        if (thread.stackFree == StackUnknown)
+        {
+            chprintf(chp, "ModuleMonitor: %-16s prio %3d load %3d.%d%%\r\n",
+                    thread.name, thread.prio, thread.load / 10, thread.load % 10);
+        }
+        else
+        {
+            chprintf(chp, "ModuleMonitor: %-16s prio %3d load %3d.%d%% stack free %d\r\n",
+                    thread.name, thread.prio, thread.load / 10, thread.load % 10,
+                    thread.stackFree);
+        }
+    }
+}
+
+}
+
+MODULE_INITCALL(7, qos::ModuleInit<tmb_musicplayer::ModuleMonitorSingelton>::Init,
+        qos::ModuleInit<tmb_musicplayer::ModuleMonitorSingelton>::Start,
+        qos::ModuleInit<tmb_musicplayer::ModuleMonitorSingelton>::Shutdown)
+
+#endif
+/** @} */
@@ -0,0 +1,124 @@
+/**
+ * @file    src/mod_monitor.h
+ * @brief
+ *
+ * @addtogroup
+ * @{
+ */
+
+#ifndef _MOD_MONITOR_H_
+#define _MOD_MONITOR_H_
+
+#include "target_cfg.h"
+#include "threadedmodule.h"
+#include "singleton.h"
+#include "snapshot.h"
+#include "loadmeter.h"
+
+#if MOD_MONITOR
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+#ifndef MOD_MONITOR_THREADSIZE
+#define MOD_MONITOR_THREADSIZE 512
+#endif
+
+#ifndef MOD_MONITOR_THREADPRIO
+#define MOD_MONITOR_THREADPRIO LOWPRIO
+#endif
+
+/* Time between two walks of the registry, the loads are averaged over it.*/
+#ifndef MOD_MONITOR_INTERVAL
+#define MOD_MONITOR_INTERVAL S2ST(5)
+#endif
+
+#ifndef MOD_MONITOR_MAX_THREADS
+#define MOD_MONITOR_MAX_THREADS 16
+#endif
+
+/* Print every walk to the debug channel, from the trace thread if there
+ * is one.*/
+#ifndef MOD_MONITOR_REPORT
+#define MOD_MONITOR_REPORT TRUE
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+#if !CH_CFG_USE_REGISTRY
+#error "MOD_MONITOR requires CH_CFG_USE_REGISTRY"
+#endif
+
+namespace tmb_musicplayer
+{
+
+/*
+ * Loads are only measured with CH_DBG_THREADS_PROFILING, stacks only with
+ * CH_DBG_FILL_THREADS.
+ */
+struct ThreadStats {
+    const char* name;
+    tprio_t prio;
+    /* Per mille of the last interval the thread ran.*/
+    uint32_t load;
+    /* Bytes of the stack never used, StackUnknown for the main thread.*/
+    uint32_t stackFree;
+};
+
+struct MonitorStats {
+    ThreadStats threads[MOD_MONITOR_MAX_THREADS];
+    uint32_t count;
+    /* Per mille of the last interval spent in the idle thread.*/
+    uint32_t idle;
+    /* Counted in the last interval with CH_DBG_STATISTICS.*/
+    uint32_t contextSwitches;
+    uint32_t interrupts;
+};
+
+/**
+ * @brief   Measures the CPU share and stack headroom of all threads.
+ */
+
+class ModuleMonitor : public qos::ThreadedModule<MOD_MONITOR_THREADSIZE>
+{
+public:
+    static const uint32_t StackUnknown = 0xFFFFFFFF;
+
+    ModuleMonitor();
+    ~ModuleMonitor();
+
+    virtual void Init();
+    virtual void Start();
+    virtual void Shutdown();
+
+    /* The result of the last interval, may be called from any thread.*/
+    void ReadStats(MonitorStats& stats);
+    /* Prints the last interval once, only one thread may report.*/
+    void Report(BaseSequentialStream* chp);
+
+protected:
+    typedef qos::ThreadedModule<MOD_MONITOR_THREADSIZE> BaseClass;
+
+    virtual void ThreadMain();
+    virtual tprio_t GetThreadPrio() const {return MOD_MONITOR_THREADPRIO;}
+
+private:
+    void Measure();
+
+    LoadMeter<MOD_MONITOR_MAX_THREADS> m_meter;
+    MonitorStats m_stats;
+    Snapshot<MonitorStats> m_published;
+    /* Copy of the reporting thread, too large for its stack.*/
+    MonitorStats m_report;
+    bool m_reportPending = false;
+    uint32_t m_contextSwitches = 0;
+    uint32_t m_interrupts = 0;
+};
+typedef qos::Singleton<ModuleMonitor> ModuleMonitorSingelton;
+
+}
+#endif /* MOD_MONITOR */
+#endif /* _MOD_MONITOR_H_ */
+
+/** @} */
@@ -22,6 +22,8 @@
 
 #include "ff.h"
 #include "minIni.h"
+#include "taptrace.h"
+#include "trace.h"
 
 #include "board_buttons.h"
 #include "mod_rfid.h"
@@ -43,7 +45,19 @@ namespace tmb_musicplayer {
 template <>
 ModuleMusicbox ModuleMusicboxSingelton::instance = tmb_musicplayer::ModuleMusicbox();
 
-ModuleMusicbox::ModuleMusicbox() {
+/* The first eight UID bytes, most significant first.*/
+static void TraceUID(enum trace_event event, const MifareUID& uid) {
+    uint32_t words[2] = {0, 0};
+    for (int i = 0; (i < uid.size) && (i < 8); i++) {
+        words[i / 4] |= (uint32_t)uid.bytes[i] << (24 - 8 * (i % 4));
+    }
+    trace_event(event, words[0], words[1]);
+}
+
+ModuleMusicbox::ModuleMusicbox() :
+        m_bufferedPlaylistFile(&m_playlistFile),
+        m_resumeStorage(RESUME_STORAGE, MOD_MUSICBOX_RESUME_BASE),
+        m_resumeTable(&m_resumeStorage, MOD_MUSICBOX_RESUME_ENTRIES) {
     buttons[0].button = &BoardButtons::BtnPlay;
     buttons[Play].handler = &ModuleMusicbox::OnPlayButton;
     buttons[Play].evtMask = EVENTMASK_BTN_PLAY;
@@ -73,6 +87,8 @@ void ModuleMusicbox::Init() {
     m_modCardreader = ModuleCardreaderSingelton::GetInstance();
     m_modPlayer = ModulePlayerSingelton::GetInstance();
     m_modEffects = ModuleEffectsSingelton::GetInstance();
+    m_cardSession.SetGracePeriod(MS2ST(cardGracePeriod));
+    m_modPlayer->SetTitleResolver(this);
 }
 
 void ModuleMusicbox::Start() {
@@ -110,6 +126,11 @@ void ModuleMusicbox::ThreadMain() {
 
     RegisterButtonEvents();
 
+    if (m_resumeTable.Init() == false)
+    {
+        chprintf(DEBUG_CANNEL, "ModuleMusicbox: Resume table not available.\r\n");
+    }
+
     /*
      * Set external output to notify ready state
      */
@@ -119,7 +140,8 @@ void ModuleMusicbox::ThreadMain() {
     GoStateStop();
     while (!chThdShouldTerminateX())
     {
-        eventmask_t evt = chEvtWaitAnyTimeout(ALL_EVENTS, MS2ST(500));
+        systime_t timeout = m_cardSession.TimeUntilStop(chVTGetSystemTimeX(), MS2ST(500));
+        eventmask_t evt = chEvtWaitAnyTimeout(ALL_EVENTS, timeout);
         if (evt & EVENTMASK_RFID)
         {
             eventflags_t flags = rfidEvtListener.getAndClearFlags();
@@ -150,6 +172,17 @@ void ModuleMusicbox::ThreadMain() {
             }
         }
 
+        if ((stopped == false) && ((chVTGetSystemTimeX() - lastResumeSave) >= MOD_MUSICBOX_RESUME_SAVE_INTERVAL))
+        {
+            SaveResumePosition();
+        }
+
+        if (m_cardSession.Update(chVTGetSystemTimeX()) == CardSession::Stop)
+        {
+            trace_event(TRACE_MUSICBOX_GRACE_OVER, 0, 0);
+            StopCardSession();
+        }
+
         /*
          * Delay for external output is 2 * 500ms
          */
@@ -217,40 +250,83 @@ void ModuleMusicbox::OnPlayButton(Button* btn, eventflags_t flags)
     (void)btn;
     if (flags & Button::Up)
     {
-        chprintf(DEBUG_CANNEL, "ModuleMusicbox: Play button up event.\r\n");
+        trace_event(TRACE_MUSICBOX_PLAY_BUTTON, 0, 0);
         m_modPlayer->Toggle();
     }
 }
 void ModuleMusicbox::OnNextButton(Button* btn, eventflags_t flags)
 {
     (void)btn;
+    if (flags & Button::Down)
+    {
+        scrubRepeats = 0;
+    }
     if (flags & Button::Pressed)
     {
-        chprintf(DEBUG_CANNEL, "ModuleMusicbox: Next button pressed event.\r\n");
-        DoAutoNext();
+        /* While held down the button repeats Pressed, that scrubs forward.*/
+        if ((flags & Button::Up) == 0)
+        {
+            Scrub(1);
+        }
+        else if (scrubRepeats == 0)
+        {
+            trace_event(TRACE_MUSICBOX_NEXT_BUTTON, 0, 0);
+            DoAutoNext();
+        }
     }
 }
 
 void ModuleMusicbox::OnPrevButton(Button* btn, eventflags_t flags)
 {
     (void)btn;
+    if (flags & Button::Down)
+    {
+        scrubRepeats = 0;
+    }
     if (flags & Button::Pressed)
     {
-        chprintf(DEBUG_CANNEL, "ModuleMusicbox: Prev button pressed event.\r\n");
-        memset(absoluteFileNameBuffer, 0, sizeof(absoluteFileNameBuffer));
-        uint32_t pathChars = m_activePlaylist.QueryPrev(absoluteFileNameBuffer, sizeof(absoluteFileNameBuffer));
-        if (pathChars > 0) {
-            m_modPlayer->Play(absoluteFileNameBuffer);
+        if ((flags & Button::Up) == 0)
+        {
+            Scrub(-1);
+        }
+        else if (scrubRepeats == 0)
+        {
+            trace_event(TRACE_MUSICBOX_PREV_BUTTON, 0, 0);
+            if (m_activePlaylist.SelectPrev()) {
+                m_modPlayer->Play(m_playlistHandle, m_activePlaylist.GetCurrentIndex());
+                QueueNextTitle();
+            }
         }
     }
 }
 
+void ModuleMusicbox::Scrub(int32_t direction)
+{
+    int32_t step = MOD_MUSICBOX_SCRUB_STEP;
+    for (uint32_t i = scrubRepeats / MOD_MUSICBOX_SCRUB_ACCELERATION;
+            (i > 0) && (step < MOD_MUSICBOX_SCRUB_MAX_STEP); i--)
+    {
+        step *= 2;
+    }
+    if (step > MOD_MUSICBOX_SCRUB_MAX_STEP)
+    {
+        step = MOD_MUSICBOX_SCRUB_MAX_STEP;
+    }
+    scrubRepeats++;
+
+    if (stopped == false)
+    {
+        trace_event(TRACE_MUSICBOX_SCRUB, direction * step, 0);
+        m_modPlayer->Scrub(direction * step);
+    }
+}
+
 void ModuleMusicbox::OnVolUpButton(Button* btn, eventflags_t flags)
 {
     (void)btn;
     if (flags & Button::Pressed)
     {
-        chprintf(DEBUG_CANNEL, "ModuleMusicbox: VolUp button pressed event.\r\n");
+        trace_event(TRACE_MUSICBOX_VOLUP_BUTTON, 0, 0);
         SetVolume(volume - 10);
     }
 }
@@ -260,13 +336,24 @@ void ModuleMusicbox::OnVolDownButton(Button* btn, eventflags_t flags)
     (void)btn;
     if (flags & Button::Pressed)
     {
-        chprintf(DEBUG_CANNEL, "ModuleMusicbox: VolDown button pressed event.\r\n");
+        trace_event(TRACE_MUSICBOX_VOLDOWN_BUTTON, 0, 0);
         SetVolume(volume + 10);
     }
 }
 
 void ModuleMusicbox::OnRFIDEvent(eventflags_t flags)
 {
+    /* Lost is handled first, both flags together mean the card is back.*/
+    if (flags & ModuleRFID::CardLost)
+    {
+        trace_event(TRACE_MUSICBOX_CARD_LOST, 0, 0);
+        SaveResumePosition();
+        if (m_cardSession.CardLost(chVTGetSystemTimeX()) == CardSession::Stop)
+        {
+            StopCardSession();
+        }
+    }
+
     if (flags & ModuleRFID::CardDetected)
     {
         if (m_modRFID->GetCurrentCardId(uid) == true)
@@ -275,24 +362,32 @@ void ModuleMusicbox::OnRFIDEvent(eventflags_t flags)
             char pszUID[32];
             if (MifareUIDToString(uid, pszUID) > 0)
             {
-                m_modEffects->SetMode(ModuleEffects::ModeEmptyPlaylist);
-                lastStop = chVTGetSystemTimeX();
+                if (m_cardSession.CardDetected(pszUID, chVTGetSystemTimeX()) == CardSession::Continue)
+                {
+                    /* The same card within the grace period, keep playing.*/
+                    TraceUID(TRACE_MUSICBOX_CARD_BACK, uid);
+                }
+                else
+                {
+                    m_modEffects->SetMode(ModuleEffects::ModeEmptyPlaylist);
+                    lastStop = chVTGetSystemTimeX();
 
-                chprintf(DEBUG_CANNEL, "ModuleMusicbox: RFID detected: %s.\r\n", pszUID);
-                ProcessMifareUID(pszUID);
+                    TraceUID(TRACE_MUSICBOX_CARD_DETECTED, uid);
+                    ProcessMifareUID(pszUID);
+                }
             }
         }
     }
+}
 
-    if (flags & ModuleRFID::CardLost)
-    {
-        chprintf(DEBUG_CANNEL, "ModuleMusicbox: RFID lost.\r\n");
-        hasRFIDCard = false;
-        m_modPlayer->Stop();
+void ModuleMusicbox::StopCardSession()
+{
+    SaveResumePosition();
+    hasRFIDCard = false;
+    m_modPlayer->Stop();
 
-        m_modEffects->SetMode(ModuleEffects::ModeEmptyPlaylist);
-        GoStateStop();
-    }
+    m_modEffects->SetMode(ModuleEffects::ModeEmptyPlaylist);
+    GoStateStop();
 }
 
 void ModuleMusicbox::OnCardReaderEvent(eventflags_t flags)
@@ -300,6 +395,13 @@ void ModuleMusicbox::OnCardReaderEvent(eventflags_t flags)
     if (flags & ModuleCardreader::FilesystemMounted)
     {
         ReadSettings();
+        /* A mount without the unmount before it must not leak the handle.*/
+        CloseResumeSpillFile();
+        if (m_resumeSpillFile.Create(MOD_MUSICBOX_RESUME_SPILL_FILE) == true)
+        {
+            m_resumeSpillOpen = true;
+            m_resumeTable.SetSpillFile(&m_resumeSpillFile);
+        }
         if (hasRFIDCard == true)
         {
             if (m_modRFID->GetCurrentCardId(uid) == true)
@@ -308,6 +410,7 @@ void ModuleMusicbox::OnCardReaderEvent(eventflags_t flags)
                 char pszUID[32];
                 if (MifareUIDToString(uid, pszUID) > 0)
                 {
+                    m_cardSession.CardDetected(pszUID, chVTGetSystemTimeX());
                     ProcessMifareUID(pszUID);
                 }
             }
@@ -321,6 +424,13 @@ void ModuleMusicbox::OnCardReaderEvent(eventflags_t flags)
 
     if (flags & ModuleCardreader::FilesystemUnmounted)
     {
+        /* The playlist is gone, a returning card has to load it again.*/
+        SaveResumePosition();
+        CloseResumeSpillFile();
+        m_cardSession.Reset();
+        m_playlistMutex.lock();
+        m_playlistHandle++;
+        m_playlistMutex.unlock();
         m_modPlayer->Stop();
         m_modEffects->SetMode(ModuleEffects::ModeEmptyPlaylist);
         GoStateStop();
@@ -328,32 +438,41 @@ void ModuleMusicbox::OnCardReaderEvent(eventflags_t flags)
 }
 
 void ModuleMusicbox::OnPlayerEvent(eventflags_t flags) {
+    if (flags & ModulePlayer::EventNext) {
+        /* the player continued with the queued title, follow it*/
+        trace_event(TRACE_MUSICBOX_PLAYER_NEXT, 0, 0);
+        m_activePlaylist.SelectNext();
+        QueueNextTitle();
+    }
+
     if (flags & ModulePlayer::EventPlay) {
-        chprintf(DEBUG_CANNEL, "ModuleMusicbox: player Play.\r\n");
+        trace_event(TRACE_MUSICBOX_PLAYER_PLAY, 0, 0);
         m_modEffects->SetMode(ModuleEffects::ModePlay);
         GoStatePlay();
     } else if (flags & ModulePlayer::EventStop) {
-        chprintf(DEBUG_CANNEL, "ModuleMusicbox: player Stop.\r\n");
+        trace_event(TRACE_MUSICBOX_PLAYER_STOP, 0, 0);
         DoAutoNext();
     } else if (flags & ModulePlayer::EventPause) {
-        chprintf(DEBUG_CANNEL, "ModuleMusicbox: player Pause.\r\n");
+        trace_event(TRACE_MUSICBOX_PLAYER_PAUSE, 0, 0);
+        SaveResumePosition();
         m_modEffects->SetMode(ModuleEffects::ModePause);
         GoStateStop();
 
     } else if (flags & ModulePlayer::EventSpectrum) {
         VS1053SpectrumAnalyzerResult spectrum;
         m_modPlayer->QuerySpectrumAnalyzerResult(spectrum);
-        m_modEffects->SetSpectrum(spectrum.current, spectrum.peak, sizeof(spectrum.current));
+        m_modEffects->SetSpectrum(spectrum.current, spectrum.peak, spectrum.bands);
     }
 }
 
 void ModuleMusicbox::DoAutoNext() {
     if (hasRFIDCard) {
-        memset(absoluteFileNameBuffer, 0, sizeof(absoluteFileNameBuffer));
-        uint32_t pathChars = m_activePlaylist.QueryNext(absoluteFileNameBuffer, sizeof(absoluteFileNameBuffer));
-        if (pathChars > 0) {
-            m_modPlayer->Play(absoluteFileNameBuffer);
+        if (m_activePlaylist.SelectNext()) {
+            m_modPlayer->Play(m_playlistHandle, m_activePlaylist.GetCurrentIndex());
+            QueueNextTitle();
         } else {
+            /* Played to the end, the next tap starts from the beginning.*/
+            m_resumeTable.Remove(uid.bytes, uid.size);
             m_modEffects->SetMode(ModuleEffects::ModeStop);
             GoStateStop();
         }
@@ -366,8 +485,12 @@ void ModuleMusicbox::DoAutoNext() {
 void ModuleMusicbox::ProcessMifareUID(const char* pszUID)
 {
     bool playFile = false;
+    /* the player must not read titles while the playlist is replaced*/
+    m_playlistMutex.lock();
+    m_playlistHandle++;
     /*search for folder*/
     if (FindUIDDirectory(pszUID) == true) {
+        taptrace_mark(TAPTRACE_DIRECTORY_FOUND);
         if (FindPlaylistFile(absoluteFileNameBuffer) == true) {
             playFile = LoadPlaylist(absoluteFileNameBuffer);
         } else {
@@ -381,43 +504,106 @@ void ModuleMusicbox::ProcessMifareUID(const char* pszUID)
     } else {
         snprintf(absoluteFileNameBuffer, sizeof(absoluteFileNameBuffer), "/music/%s", pszUID);
         if (f_mkdir(absoluteFileNameBuffer) == FR_OK) {
-            chprintf(DEBUG_CANNEL, "ModuleMusicbox: Create directory: %s.\r\n",
-                    absoluteFileNameBuffer);
+            if (m_modCardreader != NULL) {
+                m_modCardreader->AddUIDDirectory(pszUID);
+            }
+            TraceUID(TRACE_MUSICBOX_DIRECTORY_CREATED, uid);
         }
     }
+    m_playlistMutex.unlock();
 
     if (playFile == true) {
-        uint32_t pathChars = m_activePlaylist.QueryNext(absoluteFileNameBuffer, sizeof(absoluteFileNameBuffer));
-        if (pathChars > 0) {
-            m_modPlayer->Play(absoluteFileNameBuffer);
-        }
+        taptrace_mark(TAPTRACE_PLAYLIST_LOADED);
+        StartPlaylist();
+    }
+}
+
+void ModuleMusicbox::StartPlaylist() {
+    ResumePosition position;
+    if ((m_resumeTable.Find(uid.bytes, uid.size, position) == true)
+            && (position.playlistStamp == m_playlistStamp)
+            && (m_activePlaylist.Select(position.titleIndex) == true)) {
+        trace_event(TRACE_MUSICBOX_RESUME, position.titleIndex, position.decodeTime);
+        m_modPlayer->Play(m_playlistHandle, position.titleIndex, position.offset, position.decodeTime);
+        QueueNextTitle();
+    } else if (m_activePlaylist.SelectNext()) {
+        m_modPlayer->Play(m_playlistHandle, m_activePlaylist.GetCurrentIndex());
+        QueueNextTitle();
+    }
+    lastResumeSave = chVTGetSystemTimeX();
+}
+
+void ModuleMusicbox::CloseResumeSpillFile() {
+    if (m_resumeSpillOpen == false) {
+        return;
+    }
+    m_resumeTable.SetSpillFile(NULL);
+    m_resumeSpillFile.Close();
+    m_resumeSpillOpen = false;
+}
+
+void ModuleMusicbox::SaveResumePosition() {
+    lastResumeSave = chVTGetSystemTimeX();
+    if ((hasRFIDCard == false) || (m_activePlaylist.GetCurrentIndex() < 0)) {
+        return;
+    }
+
+    uint32_t offset;
+    uint16_t decodeTime;
+    if (m_modPlayer->GetPosition(offset, decodeTime) == true) {
+        ResumePosition position;
+        position.playlistStamp = m_playlistStamp;
+        position.titleIndex = m_activePlaylist.GetCurrentIndex();
+        position.offset = offset;
+        position.decodeTime = decodeTime;
+        m_resumeTable.Store(uid.bytes, uid.size, position);
+    }
+}
+
+void ModuleMusicbox::QueueNextTitle() {
+    if (gapless == false) {
+        return;
+    }
+
+    int32_t nextIndex = m_activePlaylist.GetCurrentIndex() + 1;
+    if (nextIndex < m_activePlaylist.GetTitleCount()) {
+        m_modPlayer->PlayNext(m_playlistHandle, nextIndex);
+    } else {
+        m_modPlayer->PlayNext(m_playlistHandle, -1);
     }
 }
 
+bool ModuleMusicbox::ResolveTitle(uint32_t playlist, int32_t index, char* buffer, uint32_t bufferSize) {
+    uint32_t chars = 0;
+    m_playlistMutex.lock();
+    if (playlist == m_playlistHandle) {
+        chars = m_activePlaylist.QueryTitle(index, buffer, bufferSize);
+    }
+    m_playlistMutex.unlock();
+    return chars > 0;
+}
+
 bool ModuleMusicbox::LoadPlaylist(const char* fileName) {
-    if (m_playlistFile.Open(absoluteFileNameBuffer) == true) {
-        return m_activePlaylist.LoadFromFile(&m_playlistFile);
+    if (m_bufferedPlaylistFile.Open(absoluteFileNameBuffer) == true) {
+        m_playlistStamp = m_bufferedPlaylistFile.Timestamp();
+        /* the index lives next to the playlist with the extension .idx*/
+        strncpy(fileNameBuffer, absoluteFileNameBuffer, sizeof(fileNameBuffer) - 1);
+        fileNameBuffer[sizeof(fileNameBuffer) - 1] = 0;
+        char* ext = strrchr(fileNameBuffer, '.');
+        if ((ext != NULL) && (strlen(ext) == 4)) {
+            strcpy(ext, ".idx");
+            return m_activePlaylist.LoadFromFile(&m_bufferedPlaylistFile, &m_playlistIndexFile, fileNameBuffer);
+        }
+        return m_activePlaylist.LoadFromFile(&m_bufferedPlaylistFile);
     }
     return false;
 }
 
 bool ModuleMusicbox::FindUIDDirectory(const char* pszUID) {
-    DIR directory;
-
-    FILINFO fileInfo;
-    fileInfo.lfname = fileNameBuffer;
-    fileInfo.lfsize = sizeof(fileNameBuffer);
     if (m_modCardreader != NULL) {
-        if (m_modCardreader->CommandFind(&directory, &fileInfo, "/music", pszUID) == true) {
-            if ((fileInfo.fname[0] == 0) && (fileInfo.lfname[0] == 0)) {
-                return false;
-            }
-            chprintf(DEBUG_CANNEL, "ModuleMusicbox: Found directory: %s.\r\n",
-                    pszUID);
-
-            memset(absoluteFileNameBuffer, 0, sizeof(absoluteFileNameBuffer));
-            strcat(absoluteFileNameBuffer, "/music/");
-            strcat(absoluteFileNameBuffer, fileInfo.lfname);
+        memset(absoluteFileNameBuffer, 0, sizeof(absoluteFileNameBuffer));
+        if (m_modCardreader->FindUIDDirectory(pszUID, absoluteFileNameBuffer, sizeof(absoluteFileNameBuffer)) == true) {
+            TraceUID(TRACE_MUSICBOX_DIRECTORY_FOUND, uid);
             return true;
         }
     }
@@ -445,7 +631,7 @@ bool ModuleMusicbox::FindPlaylistFile(const char* path) {
             {
                 strcat(absoluteFileNameBuffer, fileInfo.fname);
             }
-            chprintf(DEBUG_CANNEL, "ModuleMusicbox: Found playlist: %s .\r\n", absoluteFileNameBuffer);
+            trace_event(TRACE_MUSICBOX_PLAYLIST_FOUND, 0, 0);
             return true;
         }
     }
@@ -489,10 +675,10 @@ void ModuleMusicbox::CreatePlaylistFile(char* path, uint32_t pathLength) {
         path[i++] = '/';
         strcpy(&path[i], fileName);
         if (m_playlistFile.Create(path) == true) {
-            chprintf(DEBUG_CANNEL, "ModuleMusicbox: Create playlist: %s .\r\n", path);
             // rewind path
             path[--i] = 0;
-            AddFilesToPlaylist(path, pathLength, m_playlistFile);
+            uint32_t files = AddFilesToPlaylist(path, pathLength, m_playlistFile);
+            trace_event(TRACE_MUSICBOX_PLAYLIST_CREATED, files, 0);
             m_playlistFile.Sync();
             m_playlistFile.Close();
             path[i] = 0;
@@ -500,8 +686,9 @@ void ModuleMusicbox::CreatePlaylistFile(char* path, uint32_t pathLength) {
     }
 }
 
-void ModuleMusicbox::AddFilesToPlaylist(char* path, uint32_t pathLength, File& playlistFile) {
+uint32_t ModuleMusicbox::AddFilesToPlaylist(char* path, uint32_t pathLength, File& playlistFile) {
 
+    uint32_t files = 0;
     FILINFO fno;
     fno.lfname = fileNameBuffer;
     fno.lfsize = sizeof(fileNameBuffer);
@@ -548,7 +735,7 @@ void ModuleMusicbox::AddFilesToPlaylist(char* path, uint32_t pathLength, File& p
                 if (newPathLength < pathLength) {
                     path[i++] = '/';
                     strcpy(&path[i], fn);
-                    AddFilesToPlaylist(path, pathLength, playlistFile);
+                    files += AddFilesToPlaylist(path, pathLength, playlistFile);
                     // rewind path
                     path[--i] = 0;
                 }
@@ -566,7 +753,7 @@ void ModuleMusicbox::AddFilesToPlaylist(char* path, uint32_t pathLength, File& p
                         strcpy(&path[i], fn);
                         if (playlistFile.WriteString(path) > 0) {
                             playlistFile.WriteString("\r\n");
-                            chprintf(DEBUG_CANNEL, "ModuleMusicbox: Add file: %s .\r\n", path);
+                            files++;
                         }
                         // rewind path
                         path[--i] = 0;
@@ -575,6 +762,7 @@ void ModuleMusicbox::AddFilesToPlaylist(char* path, uint32_t pathLength, File& p
             }
         }
     }
+    return files;
 }
 
 void ModuleMusicbox::GoStatePlay()
@@ -632,6 +820,36 @@ void ModuleMusicbox::ReadSettings() {
     {
         m_modEffects->SetBrightness((float)brightness * 0.01f);
     }
+
+    gapless = ini_getl("General","gapless", 1, "/musicbox.ini") != 0; // continue with the next title without a gap
+    chprintf(DEBUG_CANNEL, "ModuleMusicbox: Settings gapless: %d\r\n", gapless ? 1 : 0);
+
+    cardGracePeriod = ini_getl("General","cardgrace", MOD_MUSICBOX_CARD_GRACE_PERIOD, "/musicbox.ini"); // keep playing a lost card for ms
+    if (cardGracePeriod < 0)
+    {
+        cardGracePeriod = 0;
+    }
+    m_cardSession.SetGracePeriod(MS2ST(cardGracePeriod));
+    chprintf(DEBUG_CANNEL, "ModuleMusicbox: Settings card grace period: %d ms\r\n", cardGracePeriod);
+
+    /* Comma separated center frequencies, the driver default is kept without.*/
+    char bandList[96];
+    if (ini_gets("General", "spectrum", "", bandList, sizeof(bandList), "/musicbox.ini") > 0)
+    {
+        uint16_t frequencies[VS1053_SPECTRUM_MAX_BANDS];
+        uint8_t bands = 0;
+        char* next = bandList;
+        while ((*next != 0) && (bands < VS1053_SPECTRUM_MAX_BANDS))
+        {
+            frequencies[bands++] = (uint16_t)strtol(next, &next, 10);
+            while ((*next == ',') || (*next == ' '))
+            {
+                next++;
+            }
+        }
+        bool applied = m_modPlayer->SetSpectrumBands(frequencies, bands);
+        chprintf(DEBUG_CANNEL, "ModuleMusicbox: Settings spectrum bands: %d%s\r\n", bands, applied ? "" : " invalid");
+    }
 }
 
 void ModuleMusicbox::SetVolume(int16_t vol)
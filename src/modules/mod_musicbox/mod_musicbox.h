@@ -18,7 +18,12 @@
 #include "button.h"
 #include "mfrc522.h"
 #include "ffile.h"
+#include "bufferedfile.h"
 #include "playlist.h"
+#include "cardsession.h"
+#include "resumetable.h"
+#include "nvmresumestorage.h"
+#include "commandchannel.h"
 
 /*===========================================================================*/
 /* Module constants.                                                         */
@@ -35,9 +40,51 @@
 #define MOD_MUSICBOX_THREADPRIO LOWPRIO
 #endif
 
+/* Default time in ms a lost card keeps playing before playback stops.*/
+#ifndef MOD_MUSICBOX_CARD_GRACE_PERIOD
+#define MOD_MUSICBOX_CARD_GRACE_PERIOD 2000
+#endif
+
+/* Number of cards whose resume position is kept in RESUME_STORAGE.*/
+#ifndef MOD_MUSICBOX_RESUME_ENTRIES
+#define MOD_MUSICBOX_RESUME_ENTRIES 64
+#endif
+
+/* Start of the resume table in RESUME_STORAGE.*/
+#ifndef MOD_MUSICBOX_RESUME_BASE
+#define MOD_MUSICBOX_RESUME_BASE 0
+#endif
+
+/* Time between two saves of the position while playing.*/
+#ifndef MOD_MUSICBOX_RESUME_SAVE_INTERVAL
+#define MOD_MUSICBOX_RESUME_SAVE_INTERVAL S2ST(10)
+#endif
+
+/* Entries which do not fit RESUME_STORAGE are moved to this file.*/
+#ifndef MOD_MUSICBOX_RESUME_SPILL_FILE
+#define MOD_MUSICBOX_RESUME_SPILL_FILE "/resume.dat"
+#endif
+
+/* Seconds jumped per repeat while next or prev is held down.*/
+#ifndef MOD_MUSICBOX_SCRUB_STEP
+#define MOD_MUSICBOX_SCRUB_STEP 10
+#endif
+
+/* The step doubles after this many repeats, up to the max step.*/
+#ifndef MOD_MUSICBOX_SCRUB_ACCELERATION
+#define MOD_MUSICBOX_SCRUB_ACCELERATION 10
+#endif
+
+#ifndef MOD_MUSICBOX_SCRUB_MAX_STEP
+#define MOD_MUSICBOX_SCRUB_MAX_STEP 120
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
+#if !defined(RESUME_STORAGE)
+#error "MOD_MUSICBOX needs RESUME_STORAGE for the resume positions"
+#endif
 
 /*===========================================================================*/
 /* Module data structures and types.                                         */
@@ -48,7 +95,7 @@ namespace tmb_musicplayer
  * @brief
  */
 
-class ModuleMusicbox : public qos::ThreadedModule<MOD_MUSICBOX_THREADSIZE>
+class ModuleMusicbox : public qos::ThreadedModule<MOD_MUSICBOX_THREADSIZE>, public TitleResolver
 {
 public:
     enum ButtonType
@@ -68,6 +115,8 @@ public:
     virtual void Start();
     virtual void Shutdown();
 
+    virtual bool ResolveTitle(uint32_t playlist, int32_t index, char* buffer, uint32_t bufferSize);
+
 protected:
 
     typedef qos::ThreadedModule<MOD_MUSICBOX_THREADSIZE> BaseClass;
@@ -99,10 +148,16 @@ private:
     void UnregisterButtonEvents();
 
     void ProcessMifareUID(const char* pszUID);
+    void StopCardSession();
+    void StartPlaylist();
+    void SaveResumePosition();
+    void CloseResumeSpillFile();
     bool LoadPlaylist(const char* fileName);
     void DoAutoNext();
+    void Scrub(int32_t direction);
+    void QueueNextTitle();
     void CreatePlaylistFile(char* path, uint32_t pathLength);
-    void AddFilesToPlaylist(char* path, uint32_t pathLength, File& playlistFile);
+    uint32_t AddFilesToPlaylist(char* path, uint32_t pathLength, File& playlistFile);
     bool FindUIDDirectory(const char* pszUID);
     bool FindPlaylistFile(const char* path);
 
@@ -124,6 +179,7 @@ private:
     bool isInDeepStandby = false;
     bool stopped = true;
     systime_t lastStop = 0;
+    uint32_t scrubRepeats = 0;
 
     void GoStatePlay();
     void GoStateStop();
@@ -135,12 +191,28 @@ private:
      */
     int16_t deepStandbyTime = 15 * 60; // 15min
     int16_t standbyTime = 5 * 60; // 5min
+    bool gapless = true;
+    int32_t cardGracePeriod = MOD_MUSICBOX_CARD_GRACE_PERIOD;
 
     ButtonData buttons[ButtonTypeCount];
     MifareUID uid;
+    CardSession m_cardSession;
 
     FFile m_playlistFile;
+    BufferedFile m_bufferedPlaylistFile;
+    FFile m_playlistIndexFile;
     Playlist m_activePlaylist;
+    uint32_t m_playlistStamp = 0;
+    /* Guards the playlist files, the player reads titles from them.*/
+    chibios_rt::Mutex m_playlistMutex;
+    /* Changes with every loaded playlist, older play targets are stale.*/
+    uint32_t m_playlistHandle = 0;
+
+    NVMResumeStorage m_resumeStorage;
+    ResumeTable m_resumeTable;
+    FFile m_resumeSpillFile;
+    bool m_resumeSpillOpen = false;
+    systime_t lastResumeSave = 0;
 
     char absoluteFileNameBuffer[1024];
     char fileNameBuffer[512];
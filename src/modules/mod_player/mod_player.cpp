@@ -11,10 +11,11 @@
 
 #include "ch_tools.h"
 #include "watchdog.h"
+#include "taptrace.h"
 #include "module_init_cpp.h"
 
 #include "qhal.h"
-#include "chprintf.h"
+#include "trace.h"
 #include "evtimer.h"
 
 #include "ff.h"
@@ -23,6 +24,7 @@
 #include <stdlib.h>
 
 #include "mod_effects.h"
+#include "metadatatags.h"
 
 template <>
 tmb_musicplayer::ModulePlayer tmb_musicplayer::ModulePlayerSingelton::instance = tmb_musicplayer::ModulePlayer();
@@ -35,12 +37,22 @@ tmb_musicplayer::ModulePlayer tmb_musicplayer::ModulePlayerSingelton::instance =
 #define EVENTMASK_COMMAND_STOP EVENT_MASK(5)
 #define EVENTMASK_COMMAND_VOLUME EVENT_MASK(6)
 #define EVENTMASK_COMMAND_PAUSE EVENT_MASK(7)
-#define EVENTMASK_MAIL EVENT_MASK(8)
+#define EVENTMASK_COMMANDS EVENT_MASK(8)
 #define EVENTMASK_PERIODIC_100MS EVENT_MASK(9)
+#define EVENTMASK_COMMAND_NEXT EVENT_MASK(10)
+#define EVENTMASK_PUMPTHREAD_NEXT_TITLE EVENT_MASK(11)
+
+/* Events received by the pump thread.*/
+#define EVENTMASK_PUMP_COMMAND EVENT_MASK(0)
 
 namespace tmb_musicplayer
 {
 
+static uint32_t TicksToMs(uint32_t ticks)
+{
+    return (uint32_t)(((uint64_t)ticks * 1000) / CH_CFG_ST_FREQUENCY);
+}
+
 ModulePlayer::ModulePlayer()
 {
 
@@ -68,6 +80,7 @@ void ModulePlayer::Start()
 void ModulePlayer::Shutdown()
 {
     m_pumpThread.requestTerminate();
+    m_pumpThread.signalEvents(EVENTMASK_PUMP_COMMAND);
     BaseClass::Shutdown();
 }
 
@@ -78,26 +91,53 @@ void ModulePlayer::ThreadMain()
     State state = StateIdle;
     bool hasNewTitle = false;
     char m_pathbuffer[512];
+    PlayTarget newTitle = {};
+    PlayTarget queuedTitle = {};
     while (chThdShouldTerminateX() == false)
     {
         eventmask_t evt = chEvtWaitAny(ALL_EVENTS);
+        if (evt & EVENTMASK_PUMPTHREAD_NEXT_TITLE)
+        {
+            /* The pump crossed the boundary to the queued title.*/
+            TraceTitleStats();
+            trace_event(TRACE_PLAYER_PLAY_NEXT, queuedTitle.index, queuedTitle.playlist);
+            m_evtSource.broadcastFlags(EventNext);
+        }
+
         if (evt & EVENTMASK_PUMPTHREAD_START)
         {
-            state = StatePlay;
+            if (state != StatePause)
+            {
+                state = StatePlay;
+            }
             m_evtSource.broadcastFlags(StatePlay);
         }
-        else if (evt & EVENTMASK_PUMPTHREAD_STOP)
+
+        if (evt & EVENTMASK_PUMPTHREAD_STOP)
         {
-            state = StateIdle;
+            TraceTitleStats();
             m_evtSource.broadcastFlags(EventStop);
         }
-        else if (evt & EVENTMASK_PUMPTHREAD_ABORT)
+
+        if (evt & EVENTMASK_PUMPTHREAD_ABORT)
         {
+            TraceTitleStats();
             m_evtSource.broadcastFlags(EventAbort);
+        }
+
+        /*
+         * The player stays busy from StartTransfer() until the pump reports
+         * the end, a title requested meanwhile starts now.
+         */
+        if (evt & (EVENTMASK_PUMPTHREAD_STOP | EVENTMASK_PUMPTHREAD_ABORT))
+        {
+            m_pumpThread.AcknowledgeTransferEnd();
             if (hasNewTitle) {
                 m_pumpThread.SetBasePath(m_pathbuffer);
-                chprintf(DEBUG_CANNEL, "ModulePlayer: play file %s.\r\n", m_pumpThread.AccessPathBuffer());
+                m_pumpThread.SetStartPosition(newTitle.offset, newTitle.decodeTime);
+                trace_event(TRACE_PLAYER_PLAY, newTitle.index, newTitle.playlist);
                 m_pumpThread.StartTransfer();
+                state = StatePlay;
             }
             else
             {
@@ -105,50 +145,90 @@ void ModulePlayer::ThreadMain()
             }
             hasNewTitle = false;
         }
-        else if (evt & EVENTMASK_PUMPTHREAD_NEW_SPECTRUMRESULT)
+
+        if (evt & EVENTMASK_PUMPTHREAD_NEW_SPECTRUMRESULT)
         {
             m_evtSource.broadcastFlags(EventSpectrum);
         }
-        else if (evt & EVENTMASK_MAIL)
+
+        /* Not chained to the other events, chEvtWaitAny() cleared them all
+         * and a command left in the channel would wait for the next post.*/
+        if (evt & EVENTMASK_COMMANDS)
         {
-            /* Processing the event.*/
-            Message* msg = NULL;
-            while (m_Mailbox.fetch(&msg, TIME_IMMEDIATE) == MSG_OK)
+            PlayTarget play;
+            PlayTarget next;
+            uint8_t volume;
+            uint32_t commands = m_commands.Fetch(play, next, volume);
+            if (commands & PlayerCommands::CommandPlay)
             {
-                if (msg->evtMask & EVENTMASK_COMMAND_PLAY)
+                taptrace_mark(TAPTRACE_PLAY_COMMAND);
+                m_pumpThread.SetNextTitle(NULL);
+                if (ResolveTarget(play) == false)
                 {
-                   if (state != StatePlay) {
-                       char* basePath = m_pumpThread.AccessPathBuffer();
-                       strcpy(basePath, msg->fileName);
-                       m_pumpThread.SetBasePath(msg->fileName);
-                       chprintf(DEBUG_CANNEL, "ModulePlayer: play file %s.\r\n", m_pumpThread.AccessPathBuffer());
-                       m_pumpThread.StartTransfer();
-                   } else {
-                       memset(m_pathbuffer, 0, sizeof(m_pathbuffer));
-                       strcpy(m_pathbuffer, msg->fileName);
-                       hasNewTitle = true;
-                       m_pumpThread.StopTransfer();
-                   }
-
+                    trace_event(TRACE_PLAYER_DROP, play.index, play.playlist);
+                    m_commands.Drop();
+                }
+                else if ((state == StateIdle) || (m_pumpThread.WithdrawTransfer() == true))
+                {
+                    /* The pump does not touch its path until it is started.*/
+                    char* basePath = m_pumpThread.AccessPathBuffer();
+                    strcpy(basePath, m_titlePath);
+                    m_pumpThread.SetBasePath(m_titlePath);
+                    m_pumpThread.SetStartPosition(play.offset, play.decodeTime);
+                    trace_event(TRACE_PLAYER_PLAY, play.index, play.playlist);
+                    m_pumpThread.StartTransfer();
+                    state = StatePlay;
                 }
-                else if (msg->evtMask & EVENTMASK_COMMAND_VOLUME)
+                else
                 {
-                    chprintf(DEBUG_CANNEL, "ModulePlayer: set volume %d.\r\n", msg->volume);
-                    m_pumpThread.SetVolume(msg->volume);
+                    memset(m_pathbuffer, 0, sizeof(m_pathbuffer));
+                    strcpy(m_pathbuffer, m_titlePath);
+                    newTitle = play;
+                    hasNewTitle = true;
+                    m_pumpThread.StopTransfer();
                 }
+            }
 
-                m_MsgObjectPool.free(msg);
+            if (commands & PlayerCommands::CommandVolume)
+            {
+                trace_event(TRACE_PLAYER_VOLUME, volume, 0);
+                m_pumpThread.SetVolume(volume);
+            }
+
+            if (commands & PlayerCommands::CommandNext)
+            {
+                if (next.index < 0)
+                {
+                    m_pumpThread.SetNextTitle(NULL);
+                }
+                else if (ResolveTarget(next) == true)
+                {
+                    queuedTitle = next;
+                    m_pumpThread.SetNextTitle(m_titlePath);
+                }
+                else
+                {
+                    trace_event(TRACE_PLAYER_DROP, next.index, next.playlist);
+                    m_pumpThread.SetNextTitle(NULL);
+                    m_commands.Drop();
+                }
             }
         }
-        else if (evt & EVENTMASK_COMMAND_PLAY)
-        {
-        }
-        else if (evt & EVENTMASK_COMMAND_STOP)
+
+        if (evt & EVENTMASK_COMMAND_STOP)
         {
-            state = StateIdle;
-            m_pumpThread.StopTransfer();
+            hasNewTitle = false;
+            if (m_pumpThread.WithdrawTransfer() == true)
+            {
+                state = StateIdle;
+            }
+            else
+            {
+                m_pumpThread.StopTransfer();
+            }
         }
-        else if (evt & EVENTMASK_COMMAND_PAUSE)
+
+        if (evt & EVENTMASK_COMMAND_PAUSE)
         {
             if (state == StatePause)
             {
@@ -168,14 +248,37 @@ void ModulePlayer::ThreadMain()
             }
             else if (state == StateIdle)
             {
-                char* basePath = m_pumpThread.AccessPathBuffer();
-                chprintf(DEBUG_CANNEL, "ModulePlayer: play file %s.\r\n", basePath);
+                trace_event(TRACE_PLAYER_PLAY_AGAIN, 0, 0);
                 m_pumpThread.StartTransfer();
+                state = StatePlay;
             }
         }
     }
 }
 
+void ModulePlayer::TraceTitleStats()
+{
+    PlaybackStats stats;
+    m_pumpThread.ReadPlaybackStats(stats);
+    if (stats.titles == m_reportedTitles)
+    {
+        return;
+    }
+    m_reportedTitles = stats.titles;
+
+    const PlaybackCounters& title = stats.last;
+    uint32_t readAverage = 0;
+    if (title.reads > 0)
+    {
+        readAverage = (uint32_t)(((uint64_t)title.readTotal * 1000000) / CH_CFG_ST_FREQUENCY / title.reads);
+    }
+    trace_event(TRACE_PLAYER_TITLE_BYTES, title.bytes, TicksToMs(title.duration));
+    trace_event(TRACE_PLAYER_TITLE_RATE, PlaybackHealth::BytesPerSecond(title, CH_CFG_ST_FREQUENCY), title.underruns);
+    trace_event(TRACE_PLAYER_TITLE_STALL, TicksToMs(title.stallTotal), TicksToMs(title.hungryMax));
+    trace_event(TRACE_PLAYER_TITLE_READS, title.reads, readAverage);
+    trace_event(TRACE_PLAYER_TITLE_READ_MAX, TicksToMs(title.readMax), 0);
+}
+
 void ModulePlayer::RegisterListener(chibios_rt::EvtListener* listener, eventmask_t mask)
 {
     m_evtSource.registerMask(listener, mask);
@@ -186,29 +289,33 @@ void ModulePlayer::UnregisterListener(chibios_rt::EvtListener* listener)
     m_evtSource.unregister(listener);
 }
 
-void ModulePlayer::Play(const char* path)
+void ModulePlayer::SetTitleResolver(TitleResolver* resolver)
 {
-    if (path == NULL)
+    m_titleResolver = resolver;
+}
+
+bool ModulePlayer::ResolveTarget(const PlayTarget& target)
+{
+    memset(m_titlePath, 0, sizeof(m_titlePath));
+    if (m_titleResolver == NULL)
     {
-        m_moduleThread.signalEvents(EVENTMASK_COMMAND_STOP);
-    }
-    else
-    {
-        Message* msg = (Message*)m_MsgObjectPool.alloc();
-        if (msg != NULL)
-        {
-            msg->evtMask = EVENTMASK_COMMAND_PLAY;
-            strcpy(msg->fileName, path);
-            if (m_Mailbox.post(msg, MS2ST(1)) == MSG_OK)
-            {
-                m_moduleThread.signalEvents(EVENTMASK_MAIL);
-            }
-            else
-            {
-                m_MsgObjectPool.free(msg);
-            }
-        }
+        return false;
     }
+    return m_titleResolver->ResolveTitle(target.playlist, target.index, m_titlePath, sizeof(m_titlePath));
+}
+
+void ModulePlayer::Play(uint32_t playlist, int32_t index, uint32_t offset, uint16_t decodeTime)
+{
+    PlayTarget target = {playlist, index, offset, decodeTime};
+    m_commands.PostPlay(target);
+    m_moduleThread.signalEvents(EVENTMASK_COMMANDS);
+}
+
+void ModulePlayer::PlayNext(uint32_t playlist, int32_t index)
+{
+    PlayTarget target = {playlist, index, 0, 0};
+    m_commands.PostNext(target);
+    m_moduleThread.signalEvents(EVENTMASK_COMMANDS);
 }
 
 void ModulePlayer::Toggle(void)
@@ -223,20 +330,18 @@ void ModulePlayer::Stop(void)
 
 void ModulePlayer::Volume(uint8_t volume)
 {
-    Message* msg = (Message*)m_MsgObjectPool.alloc();
-    if (msg != NULL)
-    {
-        msg->evtMask = EVENTMASK_COMMAND_VOLUME;
-        msg->volume = volume;
-        if (m_Mailbox.post(msg, MS2ST(1)) == MSG_OK)
-        {
-            m_moduleThread.signalEvents(EVENTMASK_MAIL);
-        }
-        else
-        {
-            m_MsgObjectPool.free(msg);
-        }
-    }
+    m_commands.PostVolume(volume);
+    m_moduleThread.signalEvents(EVENTMASK_COMMANDS);
+}
+
+void ModulePlayer::ReadCommandStats(CommandStats& stats)
+{
+    m_commands.ReadStats(stats);
+}
+
+void ModulePlayer::ReadPlaybackStats(PlaybackStats& stats)
+{
+    m_pumpThread.ReadPlaybackStats(stats);
 }
 
 void ModulePlayer::QuerySpectrumAnalyzerResult(VS1053SpectrumAnalyzerResult& spectrum)
@@ -244,7 +349,23 @@ void ModulePlayer::QuerySpectrumAnalyzerResult(VS1053SpectrumAnalyzerResult& spe
     m_pumpThread.ReadSpectrumAnalyzerResult(spectrum);
 }
 
-ModulePlayer::PumpThread::PumpThread()
+bool ModulePlayer::SetSpectrumBands(const uint16_t* frequencies, uint8_t bands)
+{
+    return m_pumpThread.SetSpectrumBands(frequencies, bands);
+}
+
+bool ModulePlayer::GetPosition(uint32_t& offset, uint16_t& decodeTime)
+{
+    return m_pumpThread.ReadPosition(offset, decodeTime);
+}
+
+void ModulePlayer::Scrub(int32_t seconds)
+{
+    m_pumpThread.Jump(seconds);
+}
+
+ModulePlayer::PumpThread::PumpThread() :
+        m_clusterMapPool(m_clusterMapWords, MOD_PLAYER_CLUSTER_MAP_POOL_SIZE)
 {
 
 }
@@ -255,6 +376,7 @@ void ModulePlayer::PumpThread::StartTransfer()
     m_pump = true;
     m_pausePump = false;
     chibios_rt::System::unlock();
+    SignalCommand();
 }
 
 void ModulePlayer::PumpThread::PauseTransfer()
@@ -263,6 +385,7 @@ void ModulePlayer::PumpThread::PauseTransfer()
     m_pump = false;
     m_pausePump = true;
     chibios_rt::System::unlock();
+    SignalCommand();
 }
 
 void ModulePlayer::PumpThread::StopTransfer()
@@ -271,6 +394,33 @@ void ModulePlayer::PumpThread::StopTransfer()
     m_pump = false;
     m_pausePump = false;
     chibios_rt::System::unlock();
+    SignalCommand();
+}
+
+bool ModulePlayer::PumpThread::WithdrawTransfer()
+{
+    bool withdrawn = false;
+    chibios_rt::System::lock();
+    if (m_transferTaken == false)
+    {
+        m_pump = false;
+        m_pausePump = false;
+        withdrawn = true;
+    }
+    chibios_rt::System::unlock();
+    return withdrawn;
+}
+
+void ModulePlayer::PumpThread::AcknowledgeTransferEnd()
+{
+    chibios_rt::System::lock();
+    m_transferTaken = false;
+    chibios_rt::System::unlock();
+}
+
+void ModulePlayer::PumpThread::SignalCommand()
+{
+    signalEvents(EVENTMASK_PUMP_COMMAND);
 }
 
 void ModulePlayer::PumpThread::SetVolume(uint8_t volume)
@@ -286,11 +436,65 @@ void ModulePlayer::PumpThread::SetVolume(uint8_t volume)
     m_codecMutex.unlock();
 }
 
-void ModulePlayer::PumpThread::ReadSpectrumAnalyzerResult(VS1053SpectrumAnalyzerResult& result)
+void ModulePlayer::PumpThread::SetNextTitle(const char* path)
+{
+    m_nextTitleMutex.lock();
+    {
+        memset(m_nextPathbuffer, 0, sizeof(m_nextPathbuffer));
+        if (path != NULL)
+        {
+            strncpy(m_nextPathbuffer, path, sizeof(m_nextPathbuffer) - 1);
+        }
+        m_nextTitleChanged = true;
+    }
+    m_nextTitleMutex.unlock();
+}
+
+void ModulePlayer::PumpThread::SetStartPosition(uint32_t offset, uint16_t decodeTime)
+{
+    chibios_rt::System::lock();
+    m_startOffset = offset;
+    m_startDecodeTime = decodeTime;
+    chibios_rt::System::unlock();
+}
+
+bool ModulePlayer::PumpThread::ReadPosition(uint32_t& offset, uint16_t& decodeTime)
 {
     chibios_rt::System::lock();
-    memcpy(&result, &m_lastSpectrum, sizeof(m_lastSpectrum));
+    bool valid = m_positionValid;
+    offset = m_position;
+    decodeTime = m_decodeTime;
     chibios_rt::System::unlock();
+    return valid;
+}
+
+void ModulePlayer::PumpThread::Jump(int32_t seconds)
+{
+    chibios_rt::System::lock();
+    m_jumpSeconds += seconds;
+    chibios_rt::System::unlock();
+    SignalCommand();
+}
+
+void ModulePlayer::PumpThread::ReadSpectrumAnalyzerResult(VS1053SpectrumAnalyzerResult& result)
+{
+    m_spectrum.Read(result);
+}
+
+void ModulePlayer::PumpThread::ReadPlaybackStats(PlaybackStats& stats)
+{
+    m_playbackStats.Read(stats);
+}
+
+bool ModulePlayer::PumpThread::SetSpectrumBands(const uint16_t* frequencies, uint8_t bands)
+{
+    bool result;
+    m_codecMutex.lock();
+    {
+        result = VS1053SetSpectrumBands(CODEC, frequencies, bands);
+    }
+    m_codecMutex.unlock();
+    return result;
 }
 
 void ModulePlayer::PumpThread::SetBasePath(const char* path)
@@ -344,13 +548,8 @@ void ModulePlayer::PumpThread::main()
 {
     chRegSetThreadName("playerPump");
 
-    char Buffer[32];
-    UINT ByteToRead = sizeof(Buffer);
-    UINT ByteRead;
-
     systime_t lastSpectrumFetchTime = chVTGetSystemTimeX();
 
-    FIL fsrc;
     bool pumpData = false;
 
     while (chThdShouldTerminateX() == false)
@@ -358,32 +557,77 @@ void ModulePlayer::PumpThread::main()
         watchdog_reload(WATCHDOG_MOD_PLAYER_PUMP);
         chibios_rt::System::lock();
         pumpData = m_pump;
+        if (pumpData == true)
+        {
+            m_transferTaken = true;
+        }
         chibios_rt::System::unlock();
         bool aborted = true;
         if (pumpData == true)
         {
             lastSpectrumFetchTime = chVTGetSystemTimeX();
 
-            FRESULT err = f_open(&fsrc, m_pathbuffer, FA_READ);
-            if (err == FR_OK)
+            FIL* fsrc = &m_files[0];
+            FIL* fnext = &m_files[1];
+            chibios_rt::System::lock();
+            uint32_t startOffset = m_startOffset;
+            uint16_t startDecodeTime = m_startDecodeTime;
+            m_startOffset = 0;
+            m_startDecodeTime = 0;
+            m_jumpSeconds = 0;
+            chibios_rt::System::unlock();
+
+            if (OpenStream(fsrc, m_pathbuffer) == true)
             {
+                taptrace_mark(TAPTRACE_FILE_OPENED);
+                /*
+                 * Resume where the title was left, the codec resynchronizes
+                 * on the next frame header.
+                 */
+                if ((startOffset > f_tell(fsrc)) && (startOffset < m_audioEnd[0]))
+                {
+                    CreateClusterMap(fsrc);
+                    if (f_lseek(fsrc, startOffset) != FR_OK)
+                    {
+                        startDecodeTime = 0;
+                    }
+                }
+                else
+                {
+                    startDecodeTime = 0;
+                }
+                m_decodeTimeBase = 0;
+                m_byteRate = 0;
+                bool setDecodeTime = true;
                 bool bReadStreamHeader = true;
+                bool endOfFile = false;
                 uint16_t headerDater[2];
-                uint16_t codecStatus;
+                uint16_t codecStatus = 0;
                 uint32_t byteTransferred = 0;
 
+                m_streamBuffer.Reset();
+                m_nextTitlePending = false;
+                m_lastSendEnd = chVTGetSystemTimeX();
+                m_health.StartTrack(m_lastSendEnd);
+
                 m_playerThread->signalEvents(EVENTMASK_PUMPTHREAD_START);
                 /*
-                 * Do while the number of bytes read is equal to the number of bytes to read
-                 * (the buffer is filled)
+                 * Do until the file is read completely and the stream buffer
+                 * is drained.
                  */
-                do
+                while (true)
                 {
                     watchdog_reload(WATCHDOG_MOD_PLAYER_PUMP);
 
                     chibios_rt::System::lock();
                     pumpData = m_pump;
                     bool pausePump = m_pausePump;
+                    int32_t jumpSeconds = 0;
+                    if (pumpData == true)
+                    {
+                        jumpSeconds = m_jumpSeconds;
+                        m_jumpSeconds = 0;
+                    }
                     chibios_rt::System::unlock();
 
                     aborted = true;
@@ -391,113 +635,193 @@ void ModulePlayer::PumpThread::main()
                     {
                         if (pausePump ==  true)
                         {
-                            /*pause*/
-                            chThdSleep(MS2ST(1));
+                            /*pause, wait for resume or stop*/
+                            chEvtWaitAnyTimeout(EVENTMASK_PUMP_COMMAND, MOD_PLAYER_PUMP_IDLE_TIMEOUT);
+                            /* The codec waiting during a pause is no underrun.*/
+                            m_lastSendEnd = chVTGetSystemTimeX();
+                            continue;
                         }
-                        else
+                        break;
+                    }
+
+                    aborted = false;
+
+                    UpdateNextTitle(fnext);
+
+                    if ((jumpSeconds != 0) && (JumpStream(fsrc, jumpSeconds, codecStatus) == true))
+                    {
+                        endOfFile = false;
+                    }
+
+                    /*
+                     * Continue seamlessly with the queued title, the codec
+                     * keeps decoding and never sees the end of the stream.
+                     */
+                    if ((endOfFile == true) && (m_nextTitlePending == false)
+                            && (SwitchToNextTitle(fsrc) == true))
+                    {
+                        FIL* tmp = fsrc;
+                        fsrc = fnext;
+                        fnext = tmp;
+                        endOfFile = false;
+                        m_bytesUntilNextTitle = m_streamBuffer.Level();
+                        m_nextTitlePending = true;
+                        if (m_bytesUntilNextTitle == 0)
                         {
-                            break;
+                            m_nextTitlePending = false;
+                            bReadStreamHeader = true;
+                            m_decodeTimeBase = m_decodeTime + m_decodeTimeBase;
+                            CompleteTitle();
+                            m_playerThread->signalEvents(EVENTMASK_PUMPTHREAD_NEXT_TITLE);
                         }
                     }
-                    else
+
+                    /*
+                     * Reader stage: refill the stream buffer while it is below
+                     * the low watermark or while the codec is busy anyway.
+                     */
+                    uint32_t level = m_streamBuffer.Level();
+                    if (endOfFile == false)
                     {
-                        aborted = false;
-                        /*
-                         * Clear the buffer.
-                         */
-                        memset(Buffer, 0, sizeof(Buffer));
-                        /*
-                         * Read the file.
-                         */
-                        SignalReadActionOn();
-                        err = f_read(&fsrc, Buffer, ByteToRead, &ByteRead);
-                        SignalReadActionOff();
-                        if (err == FR_OK && ByteRead > 0)
+                        bool codecHungry = VS1053ReadDREQ(CODEC);
+                        if ((level < MOD_PLAYER_STREAMBUFFER_LOW_WATERMARK) ||
+                                ((codecHungry == false) && (level < MOD_PLAYER_STREAMBUFFER_HIGH_WATERMARK)))
                         {
-                            SignalDecodeActionOn();
-
-                            m_codecMutex.lock();
-                            {
-                                if (VS1053SendData(CODEC, Buffer, ByteRead) != ByteRead)
-                                {
-                                    ByteRead = 0;
-                                }
-                                codecStatus = VS1053ReadStatus(CODEC);
-                            }
-                            m_codecMutex.unlock();
-
-                            SignalDecodeActionOff();
-
-                            byteTransferred = byteTransferred + ByteRead;
-
-                            /*check spectrum result*/
-                            systime_t now = chVTGetSystemTimeX();
-                            if ((now - lastSpectrumFetchTime) >= MS2ST(100))
-                            {
-                                m_codecMutex.lock();
-                                {
-                                    VS1053ReadSpectrumAnalyzerResult(CODEC, &m_lastSpectrum);
-                                    m_playerThread->signalEvents(EVENTMASK_PUMPTHREAD_NEW_SPECTRUMRESULT);
-                                }
-                                m_codecMutex.unlock();
-                                lastSpectrumFetchTime = now;
-                            }
-
-                            if (bReadStreamHeader == true)
-                            {
-                                m_codecMutex.lock();
-                                {
-                                    VS1053ReadHeaderData(CODEC, headerDater, headerDater + 1);
-                                }
-                                m_codecMutex.unlock();
-
-                                bool formatUnknown = false;
-                                if (headerDater[1] > 0xFFE0)
-                                {
-                                    //mp3 file
-                                }
-                                else if (headerDater[1] > 0x7665) // "ve"
-                                {
-                                    //wav file
-                                }
-                                else if (headerDater[1] > 0x4154) // "AT"
-                                {
-                                    //AAC ADTSF file
-                                }
-                                else if (headerDater[1] > 0x4144) // "AD"
-                                {
-                                    //AAC .ADIF file
-                                }
-                                else if (headerDater[1] > 0x4D34) // "M4"
-                                {
-                                    //AAC .mp4 file
-                                }
-                                else if (headerDater[1] > 0x574D) // "WM"
-                                {
-                                    //WMA file
-                                }
-                                else if (headerDater[1] > 0x4D54) // "MT"
-                                {
-                                    //Midi file
-                                }
-                                else if (headerDater[1] > 0x4F67) // "Og"
-                                {
-                                    //Ogg Vorbis file
-                                }
-                                else
-                                {
-                                    //unknow
-                                    formatUnknown = true;
-                                }
-                                bReadStreamHeader = VS1053CanJump(codecStatus)
-                                        && !formatUnknown;
-                            }
+                            endOfFile = (FillStreamBuffer(fsrc) == false);
+                            continue;
+                        }
+                    }
+                    else if (level == 0)
+                    {
+                        break;
+                    }
 
+                    /*
+                     * Writer stage: start one DREQ gated burst to the codec and
+                     * read ahead while it is transferred by DMA.
+                     */
+                    uint32_t bytesSent = StartStreamTransfer();
+                    if (bytesSent == 0)
+                    {
+                        break;
+                    }
+
+                    if ((endOfFile == false) &&
+                            (m_streamBuffer.Level() < MOD_PLAYER_STREAMBUFFER_HIGH_WATERMARK))
+                    {
+                        endOfFile = (FillStreamBuffer(fsrc) == false);
+                    }
+
+                    if (FinishStreamTransfer(bytesSent) == true)
+                    {
+                        bReadStreamHeader = true;
+                        m_byteRate = 0;
+                        byteTransferred = 0;
+                        /* The codec keeps counting across gapless titles.*/
+                        m_decodeTimeBase = m_decodeTime + m_decodeTimeBase;
+                    }
+
+                    if (byteTransferred == 0)
+                    {
+                        taptrace_mark(TAPTRACE_FIRST_BYTE);
+                    }
+
+                    if (setDecodeTime == true)
+                    {
+                        /* Count from the resumed time, not from the last stream.*/
+                        m_codecMutex.lock();
+                        {
+                            VS1053SetDecodeTime(CODEC, startDecodeTime);
                         }
+                        m_codecMutex.unlock();
+                        setDecodeTime = false;
+                    }
+
+                    m_codecMutex.lock();
+                    {
+                        codecStatus = VS1053ReadStatus(CODEC);
                     }
-                } while (ByteRead >= ByteToRead);
+                    m_codecMutex.unlock();
+
+                    byteTransferred = byteTransferred + bytesSent;
+
+                    /*check spectrum result*/
+                    systime_t now = chVTGetSystemTimeX();
+                    bool fetchSpectrum = (now - lastSpectrumFetchTime) >= MS2ST(100);
+                    UpdatePosition(fsrc, fetchSpectrum);
+                    if (fetchSpectrum == true)
+                    {
+                        m_playbackStats.Publish(m_health.Update(now));
 
-                f_close(&fsrc);
+                        VS1053SpectrumAnalyzerResult spectrum;
+                        m_codecMutex.lock();
+                        {
+                            VS1053ReadSpectrumAnalyzerResult(CODEC, &spectrum);
+                        }
+                        m_codecMutex.unlock();
+                        m_spectrum.Publish(spectrum);
+                        m_playerThread->signalEvents(EVENTMASK_PUMPTHREAD_NEW_SPECTRUMRESULT);
+                        lastSpectrumFetchTime = now;
+                    }
+
+                    if (bReadStreamHeader == true)
+                    {
+                        m_codecMutex.lock();
+                        {
+                            VS1053ReadHeaderData(CODEC, headerDater, headerDater + 1);
+                        }
+                        m_codecMutex.unlock();
+
+                        bool formatUnknown = false;
+                        if (headerDater[1] > 0xFFE0)
+                        {
+                            //mp3 file
+                        }
+                        else if (headerDater[1] > 0x7665) // "ve"
+                        {
+                            //wav file
+                        }
+                        else if (headerDater[1] > 0x4154) // "AT"
+                        {
+                            //AAC ADTSF file
+                        }
+                        else if (headerDater[1] > 0x4144) // "AD"
+                        {
+                            //AAC .ADIF file
+                        }
+                        else if (headerDater[1] > 0x4D34) // "M4"
+                        {
+                            //AAC .mp4 file
+                        }
+                        else if (headerDater[1] > 0x574D) // "WM"
+                        {
+                            //WMA file
+                        }
+                        else if (headerDater[1] > 0x4D54) // "MT"
+                        {
+                            //Midi file
+                        }
+                        else if (headerDater[1] > 0x4F67) // "Og"
+                        {
+                            //Ogg Vorbis file
+                        }
+                        else
+                        {
+                            //unknow
+                            formatUnknown = true;
+                        }
+                        /* The header is read until the codec has recognized the stream.*/
+                        if (formatUnknown == false)
+                        {
+                            m_byteRate = VS1053ByteRate(headerDater[0], headerDater[1]);
+                        }
+                        bReadStreamHeader = formatUnknown;
+                    }
+                }
+
+                CloseStream(fsrc);
+                CloseNextTitle(fnext);
+                CompleteTitle();
 
                 m_codecMutex.lock();
                 {
@@ -508,6 +832,7 @@ void ModulePlayer::PumpThread::main()
 
             chibios_rt::System::lock();
             m_pump = false;
+            m_positionValid = false;
             chibios_rt::System::unlock();
             ResetSpectrumResult();
 
@@ -517,17 +842,420 @@ void ModulePlayer::PumpThread::main()
                 m_playerThread->signalEvents(EVENTMASK_PUMPTHREAD_STOP);
             }
         }
-        chThdSleep(MS2ST(100));
+        else
+        {
+            /*
+             * Block until the player sends a command, commands set their
+             * flags before signaling so a pending event is never missed.
+             */
+            chEvtWaitAnyTimeout(EVENTMASK_PUMP_COMMAND, MOD_PLAYER_PUMP_IDLE_TIMEOUT);
+        }
     }
 }
 
-void  ModulePlayer::PumpThread::ResetSpectrumResult()
+bool ModulePlayer::PumpThread::OpenStream(FIL* file, const char* path)
+{
+    if (f_open(file, path, FA_READ) != FR_OK)
+    {
+        return false;
+    }
+
+    /*
+     * Only audio frames are sent to the codec. Leading ID3v2 tags, which may
+     * be repeated, and trailing APE and ID3v1 tags are skipped.
+     */
+    uint8_t tagData[MetadataTags::TrailerSize];
+    uint32_t audioStart = 0;
+    uint32_t audioEnd = f_size(file);
+    UINT bytesRead = 0;
+
+    while (true)
+    {
+        if ((f_lseek(file, audioStart) != FR_OK)
+                || (f_read(file, tagData, MetadataTags::ID3v2HeaderSize, &bytesRead) != FR_OK))
+        {
+            break;
+        }
+        uint32_t tagSize = MetadataTags::ID3v2TagSize(tagData, bytesRead);
+        if ((tagSize == 0) || (tagSize > (audioEnd - audioStart)))
+        {
+            break;
+        }
+        audioStart += tagSize;
+    }
+
+    if ((audioEnd - audioStart) >= sizeof(tagData))
+    {
+        if ((f_lseek(file, audioEnd - sizeof(tagData)) == FR_OK)
+                && (f_read(file, tagData, sizeof(tagData), &bytesRead) == FR_OK))
+        {
+            uint32_t tagSize = MetadataTags::TrailingTagSize(tagData, bytesRead);
+            if (tagSize < (audioEnd - audioStart))
+            {
+                audioEnd -= tagSize;
+            }
+        }
+    }
+
+    if (audioStart > 0)
+    {
+        trace_event(TRACE_PLAYER_SKIP_METADATA, audioStart, 0);
+    }
+
+    m_audioStart[file - m_files] = audioStart;
+    m_audioEnd[file - m_files] = audioEnd;
+    if (f_lseek(file, audioStart) != FR_OK)
+    {
+        CloseStream(file);
+        return false;
+    }
+    return true;
+}
+
+void ModulePlayer::PumpThread::CreateClusterMap(FIL* file)
+{
+#if _USE_FASTSEEK
+    static_assert(sizeof(DWORD) == sizeof(uint32_t), "cluster map word size");
+
+    /*
+     * With the map every seek is a lookup in RAM instead of a walk along
+     * the cluster chain. Building it walks the whole chain once, so it is
+     * only built before the first seek of a title and not on every open.
+     * The map is built into the largest free block and the unused rest is
+     * returned, FatFs stores the words it needs in the first word of the
+     * table. The file pointer is not moved.
+     */
+    if (m_clusterMap[file - m_files] != NULL)
+    {
+        return;
+    }
+
+    uint32_t size;
+    uint32_t* map = m_clusterMapPool.AllocateLargest(size);
+    if (map != NULL)
+    {
+        map[0] = size;
+        file->cltbl = (DWORD*)map;
+        if (f_lseek(file, CREATE_LINKMAP) == FR_OK)
+        {
+            m_clusterMapPool.Shrink(map, map[0]);
+            m_clusterMap[file - m_files] = map;
+            return;
+        }
+        file->cltbl = NULL;
+        m_clusterMapPool.Release(map);
+    }
+    trace_event(TRACE_PLAYER_NO_CLUSTER_MAP, 0, 0);
+#else
+    (void)file;
+#endif
+}
+
+void ModulePlayer::PumpThread::CloseStream(FIL* file)
+{
+    f_close(file);
+    uint32_t*& map = m_clusterMap[file - m_files];
+    if (map != NULL)
+    {
+        m_clusterMapPool.Release(map);
+        map = NULL;
+    }
+}
+
+void ModulePlayer::PumpThread::UpdatePosition(FIL* file, bool readDecodeTime)
+{
+    /* While the previous title drains the buffer holds data of two files.*/
+    if (m_nextTitlePending == true)
+    {
+        return;
+    }
+
+    uint16_t decodeTime = m_decodeTime + m_decodeTimeBase;
+    if (readDecodeTime == true)
+    {
+        m_codecMutex.lock();
+        {
+            decodeTime = VS1053ReadDecodeTime(CODEC);
+        }
+        m_codecMutex.unlock();
+    }
+
+    chibios_rt::System::lock();
+    m_position = f_tell(file) - m_streamBuffer.Level();
+    m_decodeTime = decodeTime - m_decodeTimeBase;
+    m_positionValid = true;
+    chibios_rt::System::unlock();
+}
+
+bool ModulePlayer::PumpThread::JumpStream(FIL* file, int32_t seconds, uint16_t codecStatus)
+{
+    /* While the previous title drains the buffer holds data of two files.*/
+    if ((m_nextTitlePending == true) || (m_byteRate == 0)
+            || (VS1053CanJump(codecStatus) == false))
+    {
+        return false;
+    }
+
+    /*
+     * Continue from the byte the codec would play in a few seconds, the
+     * buffered data is dropped and the codec resynchronizes on the next
+     * frame header. The first jump of a title builds the cluster map, the
+     * later ones seek in RAM.
+     */
+    uint32_t index = file - m_files;
+    int64_t target = (int64_t)(f_tell(file) - m_streamBuffer.Level())
+            + (int64_t)seconds * m_byteRate;
+    if (target < m_audioStart[index])
+    {
+        target = m_audioStart[index];
+    }
+    if (target >= m_audioEnd[index])
+    {
+        return false;
+    }
+    CreateClusterMap(file);
+    if (f_lseek(file, (DWORD)target) != FR_OK)
+    {
+        return false;
+    }
+    m_streamBuffer.Reset();
+
+    uint16_t decodeTime = ((uint32_t)target - m_audioStart[index]) / m_byteRate;
+    m_codecMutex.lock();
+    {
+        VS1053SetDecodeTime(CODEC, m_decodeTimeBase + decodeTime);
+    }
+    m_codecMutex.unlock();
+
+    chibios_rt::System::lock();
+    m_position = (uint32_t)target;
+    m_decodeTime = decodeTime;
+    chibios_rt::System::unlock();
+    return true;
+}
+
+bool ModulePlayer::PumpThread::FillStreamBuffer(FIL* file)
+{
+    uint32_t contiguous;
+    uint8_t* buffer = m_streamBuffer.WritePointer(contiguous);
+    if (contiguous > MOD_PLAYER_STREAMBUFFER_READSIZE)
+    {
+        contiguous = MOD_PLAYER_STREAMBUFFER_READSIZE;
+    }
+
+    uint32_t audioEnd = m_audioEnd[file - m_files];
+    uint32_t remaining = audioEnd - f_tell(file);
+    if (contiguous > remaining)
+    {
+        contiguous = remaining;
+    }
+
+    UINT bytesRead = 0;
+    SignalReadActionOn();
+    systime_t start = chVTGetSystemTimeX();
+    FRESULT err = f_read(file, buffer, contiguous, &bytesRead);
+    m_health.ReadDone(chVTGetSystemTimeX() - start);
+    SignalReadActionOff();
+    if (err != FR_OK)
+    {
+        return false;
+    }
+
+    m_streamBuffer.Commit(bytesRead);
+    return (bytesRead >= contiguous) && (f_tell(file) < audioEnd);
+}
+
+uint32_t ModulePlayer::PumpThread::StartStreamTransfer()
+{
+    uint32_t contiguous;
+    const uint8_t* data = m_streamBuffer.ReadPointer(contiguous);
+    if (contiguous > 32)
+    {
+        contiguous = 32;
+    }
+
+    /*
+     * Time how long the codec has been requesting data, beyond the time a
+     * full FIFO lasts it has run dry.
+     */
+    systime_t now = chVTGetSystemTimeX();
+    systime_t since = m_lastSendEnd;
+    systime_t rise = since;
+    uint32_t hungry = 0;
+    if (VS1053ReadDREQRise(CODEC, &rise) == true)
+    {
+        if ((systime_t)(now - rise) < (systime_t)(now - since))
+        {
+            since = rise;
+        }
+        hungry = now - since;
+    }
+    uint32_t fifoTime = 0;
+    if (m_byteRate > 0)
+    {
+        fifoTime = (VS1053_SDI_FIFO_SIZE * CH_CFG_ST_FREQUENCY) / m_byteRate;
+    }
+
+    SignalDecodeActionOn();
+
+    m_codecMutex.lock();
+    {
+        if (VS1053SendDataAsync(CODEC, (const char*)data, contiguous, NULL) == false)
+        {
+            contiguous = 0;
+        }
+    }
+    m_codecMutex.unlock();
+
+    if (contiguous == 0)
+    {
+        SignalDecodeActionOff();
+    }
+    else
+    {
+        m_health.Sent(contiguous, hungry, fifoTime);
+    }
+    return contiguous;
+}
+
+bool ModulePlayer::PumpThread::FinishStreamTransfer(uint32_t bytes)
+{
+    /*
+     * The burst is still part of the buffer level until the DMA has finished,
+     * so the reader stage cannot overwrite it.
+     */
+    m_codecMutex.lock();
+    {
+        VS1053WaitSendComplete(CODEC);
+    }
+    m_codecMutex.unlock();
+    m_lastSendEnd = chVTGetSystemTimeX();
+
+    SignalDecodeActionOff();
+
+    m_streamBuffer.Consume(bytes);
+
+    /*
+     * Report the queued title as started once the last byte of the previous
+     * one has been handed to the codec.
+     */
+    if (m_nextTitlePending == true)
+    {
+        if (bytes >= m_bytesUntilNextTitle)
+        {
+            m_bytesUntilNextTitle = 0;
+            m_nextTitlePending = false;
+            CompleteTitle();
+            m_playerThread->signalEvents(EVENTMASK_PUMPTHREAD_NEXT_TITLE);
+            return true;
+        }
+        m_bytesUntilNextTitle -= bytes;
+    }
+    return false;
+}
+
+void ModulePlayer::PumpThread::CompleteTitle()
 {
-    for (int16_t i = 0; i < VS1053_SPECTRUM_BANDS; i++)
+    /* Published before the player is signaled, so it reports this title.*/
+    m_health.EndTrack(chVTGetSystemTimeX());
+    m_playbackStats.Publish(m_health.Update(chVTGetSystemTimeX()));
+}
+
+void ModulePlayer::PumpThread::UpdateNextTitle(FIL* nextFile)
+{
+    m_nextTitleMutex.lock();
+    if (m_nextTitleChanged == true)
+    {
+        m_nextTitleChanged = false;
+        if (m_nextTitleOpen == true)
+        {
+            CloseStream(nextFile);
+            m_nextTitleOpen = false;
+        }
+
+        if (m_nextPathbuffer[0] != 0)
+        {
+            /* Open ahead of time, so the switch does not stall the stream.*/
+            m_nextTitleOpen = OpenStream(nextFile, m_nextPathbuffer);
+        }
+    }
+    m_nextTitleMutex.unlock();
+}
+
+bool ModulePlayer::PumpThread::SwitchToNextTitle(FIL* file)
+{
+    bool switched = false;
+    m_nextTitleMutex.lock();
+    if ((m_nextTitleOpen == true) && (m_nextTitleChanged == false)
+            && IsSameFormat(m_pathbuffer, m_nextPathbuffer))
     {
-        m_lastSpectrum.current[i] = 0;
-        m_lastSpectrum.peak[i] = 0;
+        CloseStream(file);
+        SetBasePath(m_nextPathbuffer);
+        memset(m_nextPathbuffer, 0, sizeof(m_nextPathbuffer));
+        m_nextTitleOpen = false;
+        switched = true;
     }
+    m_nextTitleMutex.unlock();
+    return switched;
+}
+
+void ModulePlayer::PumpThread::CloseNextTitle(FIL* nextFile)
+{
+    m_nextTitleMutex.lock();
+    if (m_nextTitleOpen == true)
+    {
+        CloseStream(nextFile);
+        m_nextTitleOpen = false;
+        /* Keep the path, it is opened again with the next stream.*/
+        m_nextTitleChanged = true;
+    }
+    m_nextTitleMutex.unlock();
+}
+
+bool ModulePlayer::PumpThread::IsSameFormat(const char* path1, const char* path2)
+{
+    /*
+     * Only streams of the same container can be concatenated without
+     * resetting the decoder, compare the file extensions.
+     */
+    const char* ext1 = strrchr(path1, '.');
+    const char* ext2 = strrchr(path2, '.');
+    if ((ext1 == NULL) || (ext2 == NULL))
+    {
+        return false;
+    }
+
+    while (true)
+    {
+        char c1 = ((uint8_t)*ext1 >= ' ') ? *ext1 : 0;
+        char c2 = ((uint8_t)*ext2 >= ' ') ? *ext2 : 0;
+        if ((c1 >= 'A') && (c1 <= 'Z'))
+        {
+            c1 = c1 - 'A' + 'a';
+        }
+        if ((c2 >= 'A') && (c2 <= 'Z'))
+        {
+            c2 = c2 - 'A' + 'a';
+        }
+        if (c1 != c2)
+        {
+            return false;
+        }
+        if (c1 == 0)
+        {
+            return true;
+        }
+        ext1++;
+        ext2++;
+    }
+}
+
+void  ModulePlayer::PumpThread::ResetSpectrumResult()
+{
+    VS1053SpectrumAnalyzerResult spectrum;
+    memset(&spectrum, 0, sizeof(spectrum));
+    spectrum.bands = (CODEC)->spectrumBands;
+    m_spectrum.Publish(spectrum);
     m_playerThread->signalEvents(EVENTMASK_PUMPTHREAD_NEW_SPECTRUMRESULT);
 }
 
@@ -17,6 +17,12 @@
 
 #if MOD_PLAYER
 
+#include "ff.h"
+#include "ringbuffer.h"
+#include "clustermappool.h"
+#include "snapshot.h"
+#include "commandchannel.h"
+#include "playbackhealth.h"
 
 /*===========================================================================*/
 /* Module constants.                                                         */
@@ -41,13 +47,60 @@
 #define MOD_PLAYER_THREADPRIO LOWPRIO
 #endif
 
-#ifndef MOD_PLAYER_CMD_QUEUE_SIZE
-#define MOD_PLAYER_CMD_QUEUE_SIZE 2
+/*
+ * Size of the buffer between file reads and codec writes, must be a power of two.
+ */
+#ifndef MOD_PLAYER_STREAMBUFFER_SIZE
+#define MOD_PLAYER_STREAMBUFFER_SIZE 4096
+#endif
+
+/*
+ * Number of bytes requested from the file system per read.
+ */
+#ifndef MOD_PLAYER_STREAMBUFFER_READSIZE
+#define MOD_PLAYER_STREAMBUFFER_READSIZE 512
+#endif
+
+/*
+ * Below this level the buffer is refilled even if the codec requests data.
+ */
+#ifndef MOD_PLAYER_STREAMBUFFER_LOW_WATERMARK
+#define MOD_PLAYER_STREAMBUFFER_LOW_WATERMARK 1024
+#endif
+
+/*
+ * While the codec is busy the buffer is filled up to this level.
+ */
+#ifndef MOD_PLAYER_STREAMBUFFER_HIGH_WATERMARK
+#define MOD_PLAYER_STREAMBUFFER_HIGH_WATERMARK 3584
+#endif
+
+/*
+ * Words shared by the fast seek cluster link maps of the open titles. A map
+ * needs two words per fragment of the file plus one, files whose map does
+ * not fit are seeked by following the cluster chain.
+ */
+#ifndef MOD_PLAYER_CLUSTER_MAP_POOL_SIZE
+#define MOD_PLAYER_CLUSTER_MAP_POOL_SIZE 256
+#endif
+
+/*
+ * Longest time the idle or paused pump blocks before it reloads the watchdog.
+ */
+#ifndef MOD_PLAYER_PUMP_IDLE_TIMEOUT
+#define MOD_PLAYER_PUMP_IDLE_TIMEOUT MS2ST(1000)
 #endif
 
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
+#if MOD_PLAYER_STREAMBUFFER_LOW_WATERMARK >= MOD_PLAYER_STREAMBUFFER_HIGH_WATERMARK
+#error "MOD_PLAYER_STREAMBUFFER_LOW_WATERMARK must be below MOD_PLAYER_STREAMBUFFER_HIGH_WATERMARK"
+#endif
+
+#if MOD_PLAYER_STREAMBUFFER_HIGH_WATERMARK > (MOD_PLAYER_STREAMBUFFER_SIZE - MOD_PLAYER_STREAMBUFFER_READSIZE)
+#error "MOD_PLAYER_STREAMBUFFER_HIGH_WATERMARK leaves no room for a complete read"
+#endif
 
 /*===========================================================================*/
 /* Module data structures and types.                                         */
@@ -66,7 +119,8 @@ public:
         EventPause = 1 << 1,
         EventStop = 1 << 2,
         EventAbort = 1 << 3,
-        EventSpectrum = 1 << 4
+        EventSpectrum = 1 << 4,
+        EventNext = 1 << 5,
     };
 
     ModulePlayer();
@@ -76,11 +130,19 @@ public:
     virtual void Start();
     virtual void Shutdown();
 
-    void Play(const char* path);
+    void SetTitleResolver(TitleResolver* resolver);
+    /* Titles are referenced by playlist and index, a negative index queues no title.*/
+    void Play(uint32_t playlist, int32_t index, uint32_t offset = 0, uint16_t decodeTime = 0);
+    void PlayNext(uint32_t playlist, int32_t index);
     void Toggle(void);
     void Stop(void);
     void Volume(uint8_t volume);
     void QuerySpectrumAnalyzerResult(VS1053SpectrumAnalyzerResult& spectrum);
+    bool SetSpectrumBands(const uint16_t* frequencies, uint8_t bands);
+    bool GetPosition(uint32_t& offset, uint16_t& decodeTime);
+    void Scrub(int32_t seconds);
+    void ReadCommandStats(CommandStats& stats);
+    void ReadPlaybackStats(PlaybackStats& stats);
 
     void RegisterListener(chibios_rt::EvtListener* listener, eventmask_t mask);
     void UnregisterListener(chibios_rt::EvtListener* listener);
@@ -103,9 +165,13 @@ protected:
 
 private:
 
+    bool ResolveTarget(const PlayTarget& target);
+
     static bool QueryCurrentFilename(uint16_t wantedFileId, char* pszFileNameBuffer);
     static bool FindFileWithID(uint16_t wantedFileId, uint16_t& folderStartId, char* pszFileNameBuffer);
 
+    void TraceTitleStats();
+
     enum State
     {
         StateIdle = 0,
@@ -123,7 +189,16 @@ private:
         void StartTransfer();
         void PauseTransfer();
         void StopTransfer();
+        /*
+         * Takes back a start the pump has not picked up yet. Returns false
+         * while a transfer runs or its end has not been acknowledged.
+         */
+        bool WithdrawTransfer();
+        void AcknowledgeTransferEnd();
         void SetVolume(uint8_t volume);
+        void SetNextTitle(const char* path);
+        void SetStartPosition(uint32_t offset, uint16_t decodeTime);
+        bool ReadPosition(uint32_t& offset, uint16_t& decodeTime);
 
         void SetPlayerThread(chibios_rt::BaseThread* thread)
         {
@@ -136,6 +211,9 @@ private:
        void ResetPathtoBase();
        void ResetPath();
        void ReadSpectrumAnalyzerResult(VS1053SpectrumAnalyzerResult& result);
+       bool SetSpectrumBands(const uint16_t* frequencies, uint8_t bands);
+       void Jump(int32_t seconds);
+       void ReadPlaybackStats(PlaybackStats& stats);
 
     protected:
         virtual void main();
@@ -149,32 +227,93 @@ private:
         void SignalDecodeActionOff();
 
         void ResetSpectrumResult();
+        void SignalCommand();
+
+        bool OpenStream(FIL* file, const char* path);
+        void CreateClusterMap(FIL* file);
+        void CloseStream(FIL* file);
+        void UpdatePosition(FIL* file, bool readDecodeTime);
+        bool JumpStream(FIL* file, int32_t seconds, uint16_t codecStatus);
+        bool FillStreamBuffer(FIL* file);
+        uint32_t StartStreamTransfer();
+        bool FinishStreamTransfer(uint32_t bytes);
+
+        void CompleteTitle();
+
+        void UpdateNextTitle(FIL* nextFile);
+        bool SwitchToNextTitle(FIL* file);
+        void CloseNextTitle(FIL* nextFile);
+
+        static bool IsSameFormat(const char* path1, const char* path2);
 
         char m_pathbuffer[512];
         uint16_t basePathEndIdx = 0;
 
         bool m_pump = false;
         bool m_pausePump = false;
+        /* Set by the pump when it starts a transfer, cleared by the player
+         * once it handled the end of it.*/
+        bool m_transferTaken = false;
         uint8_t m_volume = 0;
         chibios_rt::Mutex m_codecMutex;
         chibios_rt::BaseThread* m_playerThread;
-        VS1053SpectrumAnalyzerResult m_lastSpectrum;
+        /* Written by the pump only, readers never block it.*/
+        Snapshot<VS1053SpectrumAnalyzerResult> m_spectrum;
+        RingBuffer<MOD_PLAYER_STREAMBUFFER_SIZE> m_streamBuffer;
+
+        /*
+         * Gapless playback, the next title is opened ahead of time and its
+         * data is appended to the stream buffer when the current file ends.
+         */
+        FIL m_files[2];
+        uint32_t m_audioStart[2];
+        uint32_t m_audioEnd[2];
+        uint32_t* m_clusterMap[2] = {NULL, NULL};
+        uint32_t m_clusterMapWords[MOD_PLAYER_CLUSTER_MAP_POOL_SIZE];
+        ClusterMapPool m_clusterMapPool;
+        chibios_rt::Mutex m_nextTitleMutex;
+        char m_nextPathbuffer[128];
+        bool m_nextTitleChanged = false;
+        bool m_nextTitleOpen = false;
+        bool m_nextTitlePending = false;
+        uint32_t m_bytesUntilNextTitle = 0;
+
+        /*
+         * Resume, the next transfer starts at this offset of the file. The
+         * position of the bytes handed to the codec is kept for the musicbox.
+         */
+        uint32_t m_startOffset = 0;
+        uint16_t m_startDecodeTime = 0;
+        bool m_positionValid = false;
+        uint32_t m_position = 0;
+        uint16_t m_decodeTime = 0;
+        uint16_t m_decodeTimeBase = 0;
+
+        /*
+         * Scrubbing, jumps requested since the last transfer are summed up.
+         * The byte rate is taken from the stream header.
+         */
+        int32_t m_jumpSeconds = 0;
+        uint32_t m_byteRate = 0;
+
+        /*
+         * Stream health, the codec is taken as requesting data since the
+         * last burst ended or DREQ rose, whichever came later.
+         */
+        PlaybackHealth m_health;
+        Snapshot<PlaybackStats> m_playbackStats;
+        systime_t m_lastSendEnd = 0;
     };
 
-    class Message
-    {
-    public:
-        eventmask_t evtMask;
-        char fileName[128];
-        uint8_t volume;
-    };
+    typedef CommandChannel<chibios_rt::Mutex> PlayerCommands;
 
     PumpThread m_pumpThread;
 
     chibios_rt::EvtSource m_evtSource;
-    chibios_rt::ObjectsPool<Message, MOD_PLAYER_CMD_QUEUE_SIZE> m_MsgObjectPool;
-    chibios_rt::Mailbox<Message*, MOD_PLAYER_CMD_QUEUE_SIZE> m_Mailbox;
-
+    PlayerCommands m_commands;
+    TitleResolver* m_titleResolver = NULL;
+    char m_titlePath[128];
+    uint32_t m_reportedTitles = 0;
 
 };
 
@@ -8,6 +8,7 @@
 
 #include "hal.h"
 #include "vs1053.h"
+#include "dreqwait.h"
 #include <string.h>
 
 #if HAL_USE_VS1053 || defined(__DOXYGEN__)
@@ -202,7 +203,7 @@ static const unsigned short plugin[1000] = { /* Compressed plugin */
 //        10500,
 //};
 
-static const int16_t spectrumCenterFrequencies[] = {
+static const uint16_t spectrumCenterFrequencies[] = {
         100,
         250,
         440,
@@ -218,6 +219,64 @@ static bool ReadDREQ(VS1053Driver* VS1053p)
     return palReadPad(VS1053p->config->xDREQPort, VS1053p->config->xDREQPad);
 }
 
+static bool DREQPortRead(void* arg)
+{
+    return ReadDREQ((VS1053Driver*)arg);
+}
+
+#if VS1053_USE_DREQ_INTERRUPT
+static bool DREQPortBlock(void* arg, uint32_t timeout)
+{
+    VS1053Driver* VS1053p = (VS1053Driver*)arg;
+    return osalThreadEnqueueTimeoutS(&VS1053p->dreqQueue, timeout) == MSG_OK;
+}
+#else
+static bool DREQPortBlock(void* arg, uint32_t timeout)
+{
+    (void)arg;
+    osalThreadSleepS((timeout < MS2ST(1)) ? timeout : MS2ST(1));
+    return true;
+}
+#endif
+
+static uint32_t DREQPortNow(void* arg)
+{
+    (void)arg;
+    return osalOsGetSystemTimeX();
+}
+
+/*
+ * Blocks until the codec asserts DREQ or the timeout expires.
+ * Returns the DREQ level after waiting.
+ */
+static bool WaitDREQ(VS1053Driver* VS1053p, systime_t timeout)
+{
+    const struct dreq_port port = {DREQPortRead, DREQPortBlock, DREQPortNow, VS1053p};
+    bool ready;
+
+    osalSysLock();
+    ready = dreq_wait(&port, timeout);
+    osalSysUnlock();
+    return ready;
+}
+
+/*
+ * Blocks until a running asynchronous SDI transfer has completed.
+ */
+static void WaitTransfer(VS1053Driver* VS1053p)
+{
+#if VS1053_USE_ASYNC_SDI
+    osalSysLock();
+    while (VS1053p->state == VS1053_SDI_TRANSFER_ASYNC)
+    {
+        osalThreadEnqueueTimeoutS(&VS1053p->transferQueue, TIME_INFINITE);
+    }
+    osalSysUnlock();
+#else
+    (void)VS1053p;
+#endif
+}
+
 static bool ResetChip(VS1053Driver* VS1053p)
 {
     palClearPad(VS1053p->config->xResetPort, VS1053p->config->xResetPad);
@@ -235,6 +294,20 @@ static bool ResetChip(VS1053Driver* VS1053p)
     return true;
 }
 
+/*
+ * Switches the bus to the given configuration, SCI always runs with the
+ * conservative one. Must only be called while no transfer is running.
+ */
+static void SelectSPIConfig(VS1053Driver* VS1053p, const SPIConfig* cfg)
+{
+    if (VS1053p->activeSpiCfg != cfg)
+    {
+        spiStart(VS1053p->config->spid, cfg);
+        spiUnselect(VS1053p->config->spid);
+        VS1053p->activeSpiCfg = cfg;
+    }
+}
+
 static void ActivateSCI(VS1053Driver* VS1053p)
 {
     palSetPad(VS1053p->config->xDCSPort, VS1053p->config->xDCSPad);
@@ -249,6 +322,8 @@ static void DeactivateSCI(VS1053Driver* VS1053p)
 
 static void WriteRegister(VS1053Driver* VS1053p, uint8_t addressbyte, uint8_t highbyte, uint8_t lowbyte)
 {
+    WaitTransfer(VS1053p);
+    SelectSPIConfig(VS1053p, VS1053p->config->spiCfg);
     VS1053p->state = VS1053_SCI_TRANSFER;
     ActivateSCI(VS1053p);
     spiSelect(VS1053p->config->spid);
@@ -259,9 +334,7 @@ static void WriteRegister(VS1053Driver* VS1053p, uint8_t addressbyte, uint8_t hi
     spiSend(VS1053p->config->spid, 4, VS1053p->txBuffer);
     DeactivateSCI(VS1053p);
 
-    while (ReadDREQ(VS1053p) == false)
-    {
-    }
+    WaitDREQ(VS1053p, VS1053_DREQ_TIMEOUT);
     VS1053p->state = VS1053_ACTIVE;
 }
 
@@ -272,6 +345,8 @@ static void WriteWordRegister(VS1053Driver* VS1053p, uint8_t address, uint16_t d
 
 static uint16_t ReadRegister(VS1053Driver* VS1053p, uint8_t addressbyte)
 {
+    WaitTransfer(VS1053p);
+    SelectSPIConfig(VS1053p, VS1053p->config->spiCfg);
     VS1053p->state = VS1053_SCI_TRANSFER;
     ActivateSCI(VS1053p);
 
@@ -292,6 +367,89 @@ static uint16_t ReadRegister(VS1053Driver* VS1053p, uint8_t addressbyte)
     return result;
 }
 
+/*
+ * The codec only pulls DREQ low for a few clock cycles after a word was
+ * written to SCI_WRAM, sleeping a tick as WaitDREQ does would dominate.
+ */
+static bool SpinDREQ(VS1053Driver* VS1053p)
+{
+    systime_t start = osalOsGetSystemTimeX();
+    while (ReadDREQ(VS1053p) == false)
+    {
+        if ((osalOsGetSystemTimeX() - start) >= VS1053_DREQ_TIMEOUT)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * SCI multiple write, xCS stays asserted and only the data words follow the
+ * command. A stride of 0 writes the same word count times.
+ */
+static void WriteRegisterWords(VS1053Driver* VS1053p, uint8_t address, const uint16_t* data, size_t stride, size_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    WaitTransfer(VS1053p);
+    SelectSPIConfig(VS1053p, VS1053p->config->spiCfg);
+    VS1053p->state = VS1053_SCI_TRANSFER;
+    ActivateSCI(VS1053p);
+    spiSelect(VS1053p->config->spid);
+    VS1053p->txBuffer[0] = VS_WRITE_COMMAND;
+    VS1053p->txBuffer[1] = address;
+    spiSend(VS1053p->config->spid, 2, VS1053p->txBuffer);
+
+    while (count--)
+    {
+        VS1053p->txBuffer[2] = 0x00ff & (*data >> 8);
+        VS1053p->txBuffer[3] = 0x00ff & *data;
+        spiSend(VS1053p->config->spid, 2, VS1053p->txBuffer + 2);
+        data += stride;
+        if (SpinDREQ(VS1053p) == false)
+        {
+            break;
+        }
+    }
+
+    spiUnselect(VS1053p->config->spid);
+    DeactivateSCI(VS1053p);
+
+    WaitDREQ(VS1053p, VS1053_DREQ_TIMEOUT);
+    VS1053p->state = VS1053_ACTIVE;
+}
+
+/*
+ * The codec needs a new command for every read, the bus stays owned by the
+ * driver and only xCS is toggled between the words.
+ */
+static void ReadRegisterWords(VS1053Driver* VS1053p, uint8_t address, uint16_t* data, size_t count)
+{
+    WaitTransfer(VS1053p);
+    SelectSPIConfig(VS1053p, VS1053p->config->spiCfg);
+    VS1053p->state = VS1053_SCI_TRANSFER;
+    VS1053p->txBuffer[0] = VS_READ_COMMAND;
+    VS1053p->txBuffer[1] = address;
+    VS1053p->txBuffer[2] = 0;
+    VS1053p->txBuffer[3] = 0;
+
+    spiSelect(VS1053p->config->spid);
+    while (count--)
+    {
+        ActivateSCI(VS1053p);
+        spiExchange(VS1053p->config->spid, 4, VS1053p->txBuffer, VS1053p->rxBuffer);
+        DeactivateSCI(VS1053p);
+        *data++ = (VS1053p->rxBuffer[2] << 8) | VS1053p->rxBuffer[3];
+    }
+    spiUnselect(VS1053p->config->spid);
+
+    VS1053p->state = VS1053_ACTIVE;
+}
+
 static void SoftReset(VS1053Driver* VS1053p)
 {
     WriteRegister(VS1053p, SCI_MODE, SM_SDINEW>>8, SM_RESET);
@@ -316,20 +474,15 @@ static void LoadUserCode(VS1053Driver* VS1053p) {
         uint16_t n = plugin[i++];
         if (n & 0x8000U) { /* RLE run, replicate n samples */
             n &= 0x7FFF;
-            uint16_t val = plugin[i++];
-            while (n--) {
-                WriteWordRegister(VS1053p, addr, val);
-            }
+            WriteRegisterWords(VS1053p, addr, &plugin[i++], 0, n);
         } else {           /* Copy run, copy n samples */
-            while (n--) {
-                uint16_t val = plugin[i++];
-                WriteWordRegister(VS1053p, addr, val);
-            }
+            WriteRegisterWords(VS1053p, addr, &plugin[i], 1, n);
+            i += n;
         }
     }
 }
 
-static void InitSpectrumAnalyzerPlugin(VS1053Driver* VS1053p)
+static void WriteSpectrumBands(VS1053Driver* VS1053p, const uint16_t* frequencies, uint8_t bands)
 {
     /* Setting Bands
      *  You can also change the frequency band center frequencies and the number of bands
@@ -339,32 +492,99 @@ static void InitSpectrumAnalyzerPlugin(VS1053Driver* VS1053p)
      */
 
 
-    WriteWordRegister(VS1053p, SCI_WRAMADDR, 0x1868);
     /* write center frequencies */
+    uint16_t table[VS1053_SPECTRUM_MAX_BANDS];
     int32_t i;
-    for (i = 0; i < VS1053_SPECTRUM_BANDS; i++) {
-        WriteWordRegister(VS1053p, SCI_WRAM, spectrumCenterFrequencies[i]);
+    for (i = 0; i < bands; i++) {
+        table[i] = frequencies[i];
     }
 
-    while (i < 15)
+    while (i < VS1053_SPECTRUM_MAX_BANDS)
     {
-        WriteWordRegister(VS1053p, SCI_WRAM, 25000);
+        table[i] = 25000;
         i++;
     }
+    VS1053WriteWram(VS1053p, 0x1868, table, VS1053_SPECTRUM_MAX_BANDS);
 
     /* Reset sample rate field to activate new frequencies */
     WriteWordRegister(VS1053p, SCI_WRAMADDR, 0x1811);
     WriteWordRegister(VS1053p, SCI_WRAM, 0);
+
+    VS1053p->spectrumBands = bands;
+}
+
+static void InitSpectrumAnalyzerPlugin(VS1053Driver* VS1053p)
+{
+    WriteSpectrumBands(VS1053p, spectrumCenterFrequencies,
+            sizeof(spectrumCenterFrequencies) / sizeof(spectrumCenterFrequencies[0]));
+}
+
+/*
+ * SDI is write only, so the fast configuration is checked with SCI writes,
+ * which have the same CLKI/4 limit. Test patterns are written to SCI_VOL at
+ * the fast clock and read back at the slow one. 0xFFFF is left out, it powers
+ * down the analog drivers and pops.
+ */
+static bool CalibrateSDI(VS1053Driver* VS1053p)
+{
+    static const uint16_t patterns[] = {0xFEFE, 0x5555, 0xAAAA, 0x1234, 0xEDCB, 0x0101};
+
+    const SPIConfig* fastCfg = VS1053p->config->spiFastCfg;
+    if (fastCfg == NULL)
+    {
+        return false;
+    }
+
+    int round;
+    for (round = 0; round < VS1053_CALIBRATION_ROUNDS; round++)
+    {
+        size_t i;
+        for (i = 0; i < sizeof(patterns) / sizeof(patterns[0]); i++)
+        {
+            WaitTransfer(VS1053p);
+            SelectSPIConfig(VS1053p, fastCfg);
+            VS1053p->state = VS1053_SCI_TRANSFER;
+            ActivateSCI(VS1053p);
+            spiSelect(VS1053p->config->spid);
+            VS1053p->txBuffer[0] = VS_WRITE_COMMAND;
+            VS1053p->txBuffer[1] = SCI_VOL;
+            VS1053p->txBuffer[2] = 0x00ff & (patterns[i] >> 8);
+            VS1053p->txBuffer[3] = 0x00ff & patterns[i];
+            spiSend(VS1053p->config->spid, 4, VS1053p->txBuffer);
+            spiUnselect(VS1053p->config->spid);
+            DeactivateSCI(VS1053p);
+            VS1053p->state = VS1053_ACTIVE;
+
+            if ((WaitDREQ(VS1053p, VS1053_DREQ_TIMEOUT) == false)
+                    || (ReadRegister(VS1053p, SCI_VOL) != patterns[i]))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
 }
 
 static bool InitChip(VS1053Driver* VS1053p)
 {
     /*Set clock frequency*/
-    WriteRegister(VS1053p, SCI_CLOCKF,0x60 | 0x08, 0x00);
+    uint16_t clockf = VS1053p->config->clockf;
+    if (clockf == 0)
+    {
+        clockf = 0x6800;
+    }
+    WriteWordRegister(VS1053p, SCI_CLOCKF, clockf);
 
     /*Set mode*/
     SoftReset(VS1053p);
 
+    /* SDI only runs at the fast clock if the codec keeps up with it.*/
+    VS1053p->sdiSpiCfg = VS1053p->config->spiCfg;
+    if (CalibrateSDI(VS1053p) == true)
+    {
+        VS1053p->sdiSpiCfg = VS1053p->config->spiFastCfg;
+    }
+
     /* Load and configure Plugins */
     LoadUserCode(VS1053p);
     InitSpectrumAnalyzerPlugin(VS1053p);
@@ -399,6 +619,17 @@ void VS1053ObjectInit(VS1053Driver* VS1053p) {
 
 	VS1053p->state = VS1053_STOP;
 	VS1053p->config = NULL;
+	VS1053p->activeSpiCfg = NULL;
+	VS1053p->sdiSpiCfg = NULL;
+	VS1053p->spectrumBands = 0;
+#if VS1053_USE_DREQ_INTERRUPT
+	osalThreadQueueObjectInit(&VS1053p->dreqQueue);
+	VS1053p->dreqRise = 0;
+#endif
+#if VS1053_USE_ASYNC_SDI
+	osalThreadQueueObjectInit(&VS1053p->transferQueue);
+	VS1053p->sdiEndCb = NULL;
+#endif
 }
 
 /**
@@ -430,6 +661,8 @@ void VS1053Start(VS1053Driver* VS1053p, const VS1053Config* config) {
 
 	spiStart(config->spid, config->spiCfg);
 	spiUnselect(VS1053p->config->spid);
+	VS1053p->activeSpiCfg = config->spiCfg;
+	VS1053p->sdiSpiCfg = config->spiCfg;
 
 	InitChip( VS1053p);
 
@@ -449,6 +682,8 @@ void VS1053Stop(VS1053Driver* VS1053p) {
 
 	osalDbgCheck(VS1053p != NULL);
 
+	WaitTransfer(VS1053p);
+
 	osalSysLock();
 	osalDbgAssert(VS1053p->state == VS1053_ACTIVE, "invalid state");
 	osalSysUnlock();
@@ -456,6 +691,7 @@ void VS1053Stop(VS1053Driver* VS1053p) {
 	palClearPad(VS1053p->config->xResetPort, VS1053p->config->xResetPad);
 
 	spiStop(VS1053p->config->spid);
+	VS1053p->activeSpiCfg = NULL;
 
 	osalSysLock();
 	VS1053p->state = VS1053_STOP;
@@ -499,17 +735,65 @@ void VS1053SetVolume(VS1053Driver* VS1053p, uint8_t leftVol, uint8_t rightVol)
     SetVolume(VS1053p, leftVol, rightVol);
 }
 
-uint8_t VS1053SendData(VS1053Driver* VS1053p, const char* data, uint8_t bytes)
+/*
+ * Returns the current DREQ level without waiting. A high level means the
+ * codec can accept at least 32 bytes of SDI data.
+ */
+bool VS1053ReadDREQ(VS1053Driver* VS1053p)
+{
+    return ReadDREQ(VS1053p);
+}
+
+/*
+ * Returns the current DREQ level and the time it last went high. The time
+ * is only recorded with VS1053_USE_DREQ_INTERRUPT, rise is left untouched
+ * otherwise.
+ */
+bool VS1053ReadDREQRise(VS1053Driver* VS1053p, systime_t* rise)
 {
     osalSysLock();
-    VS1053p->state = VS1053_SDI_TRANSFER;
+    bool dreq = ReadDREQ(VS1053p);
+#if VS1053_USE_DREQ_INTERRUPT
+    *rise = VS1053p->dreqRise;
+#else
+    (void)rise;
+#endif
     osalSysUnlock();
+    return dreq;
+}
 
-    while (ReadDREQ(VS1053p) == false)
+/**
+ * @brief   Wakes up all threads waiting for DREQ.
+ * @note    To be called from the rising edge interrupt of the DREQ pad.
+ *
+ * @iclass
+ */
+void VS1053DREQInterruptI(VS1053Driver* VS1053p)
+{
+    osalDbgCheckClassI();
+#if VS1053_USE_DREQ_INTERRUPT
+    VS1053p->dreqRise = osalOsGetSystemTimeX();
+    osalThreadDequeueAllI(&VS1053p->dreqQueue, MSG_OK);
+#else
+    (void)VS1053p;
+#endif
+}
+
+uint8_t VS1053SendData(VS1053Driver* VS1053p, const char* data, uint8_t bytes)
+{
+    WaitTransfer(VS1053p);
+
+    if (WaitDREQ(VS1053p, VS1053_DREQ_TIMEOUT) == false)
     {
-        chThdSleep(MS2ST(1));
+        return 0;
     }
 
+    SelectSPIConfig(VS1053p, VS1053p->sdiSpiCfg);
+
+    osalSysLock();
+    VS1053p->state = VS1053_SDI_TRANSFER;
+    osalSysUnlock();
+
     DeactivateSCI(VS1053p);
 
     spiSelect(VS1053p->config->spid);
@@ -525,6 +809,106 @@ uint8_t VS1053SendData(VS1053Driver* VS1053p, const char* data, uint8_t bytes)
     return bytes;
 }
 
+/**
+ * @brief   Starts sending up to 32 bytes of SDI data without waiting for
+ *          the SPI transfer to finish.
+ * @details The function still waits for DREQ before the transfer is started.
+ *          @p data must stay valid until @p endCb has been called or
+ *          @p VS1053WaitSendComplete() has returned.
+ *
+ * @param[in] VS1053p   pointer to the @p VS1053Driver object
+ * @param[in] data      data to send, must be DMA accessible
+ * @param[in] bytes     number of bytes to send
+ * @param[in] endCb     completion callback or @p NULL
+ * @return              false if DREQ was not asserted in time.
+ *
+ * @api
+ */
+bool VS1053SendDataAsync(VS1053Driver* VS1053p, const char* data, uint8_t bytes, vs1053callback_t endCb)
+{
+#if VS1053_USE_ASYNC_SDI
+    WaitTransfer(VS1053p);
+
+    if (WaitDREQ(VS1053p, VS1053_DREQ_TIMEOUT) == false)
+    {
+        return false;
+    }
+
+    SelectSPIConfig(VS1053p, VS1053p->sdiSpiCfg);
+
+    osalSysLock();
+    VS1053p->state = VS1053_SDI_TRANSFER_ASYNC;
+    VS1053p->sdiEndCb = endCb;
+    osalSysUnlock();
+
+    DeactivateSCI(VS1053p);
+
+    spiSelect(VS1053p->config->spid);
+    spiStartSend(VS1053p->config->spid, bytes, data);
+
+    return true;
+#else
+    if (VS1053SendData(VS1053p, data, bytes) != bytes)
+    {
+        return false;
+    }
+
+    if (endCb != NULL)
+    {
+        osalSysLock();
+        endCb(VS1053p);
+        osalSysUnlock();
+    }
+    return true;
+#endif
+}
+
+/**
+ * @brief   Waits until the last asynchronous SDI transfer has completed.
+ *
+ * @param[in] VS1053p   pointer to the @p VS1053Driver object
+ *
+ * @api
+ */
+void VS1053WaitSendComplete(VS1053Driver* VS1053p)
+{
+    WaitTransfer(VS1053p);
+}
+
+/**
+ * @brief   Completes an asynchronous SDI transfer.
+ * @note    To be called from the @p end_cb of the codec SPI configuration.
+ *          Synchronous transfers are ignored.
+ *
+ * @iclass
+ */
+void VS1053SPIEndInterruptI(VS1053Driver* VS1053p)
+{
+    osalDbgCheckClassI();
+#if VS1053_USE_ASYNC_SDI
+    if (VS1053p->state != VS1053_SDI_TRANSFER_ASYNC)
+    {
+        return;
+    }
+
+    spiUnselectI(VS1053p->config->spid);
+    ActivateSCI(VS1053p);
+
+    VS1053p->state = VS1053_ACTIVE;
+
+    vs1053callback_t endCb = VS1053p->sdiEndCb;
+    VS1053p->sdiEndCb = NULL;
+    osalThreadDequeueAllI(&VS1053p->transferQueue, MSG_OK);
+
+    if (endCb != NULL)
+    {
+        endCb(VS1053p);
+    }
+#else
+    (void)VS1053p;
+#endif
+}
+
 void VS1053StopPlaying(VS1053Driver* VS1053p)
 {
     uint8_t endFillByte = ReadEndFillByte(VS1053p);
@@ -559,42 +943,153 @@ void VS1053StopPlaying(VS1053Driver* VS1053p)
 
 void VS1053ReadHeaderData(VS1053Driver* VS1053p, uint16_t* headerData0, uint16_t* headerData1)
 {
-    while (ReadDREQ(VS1053p) == false)
-    {
-        chThdSleep(MS2ST(1));
-    }
+    WaitDREQ(VS1053p, VS1053_DREQ_TIMEOUT);
     *headerData0 = ReadRegister(VS1053p, SCI_HDAT0);
     *headerData1 = ReadRegister(VS1053p, SCI_HDAT1);
 }
 
 void VS1053ReadSpectrumAnalyzerResult(VS1053Driver* VS1053p, struct VS1053SpectrumAnalyzerResult* result)
 {
-    WriteWordRegister(VS1053p, SCI_WRAMADDR, 0x1814);
+    uint16_t values[VS1053_SPECTRUM_MAX_BANDS];
+    VS1053ReadWram(VS1053p, 0x1814, values, VS1053p->spectrumBands);
+    result->bands = VS1053p->spectrumBands;
     size_t i;
-    for (i = 0; i < VS1053_SPECTRUM_BANDS; i++)
+    for (i = 0; i < VS1053p->spectrumBands; i++)
     {
-        uint16_t val = ReadRegister(VS1053p, SCI_WRAM);
-        result->current[i] = 0x3f & val;
-        result->peak[i] = 0x3f & (val >> 6);
+        result->current[i] = 0x3f & values[i];
+        result->peak[i] = 0x3f & (values[i] >> 6);
     }
 }
 
-uint16_t VS1053ReadStatus(VS1053Driver* VS1053p)
+/**
+ * @brief   Sets the center frequencies of the spectrum analyzer bands.
+ *
+ * @param[in] VS1053p       pointer to the @p VS1053Driver object
+ * @param[in] frequencies   center frequencies in Hz in ascending order
+ * @param[in] bands         number of bands, 1..VS1053_SPECTRUM_MAX_BANDS
+ * @return                  false if the table is not usable.
+ *
+ * @api
+ */
+bool VS1053SetSpectrumBands(VS1053Driver* VS1053p, const uint16_t* frequencies, uint8_t bands)
 {
-    while (ReadDREQ(VS1053p) == false)
+    if ((bands == 0) || (bands > VS1053_SPECTRUM_MAX_BANDS))
+    {
+        return false;
+    }
+
+    uint8_t i;
+    for (i = 1; i < bands; i++)
     {
-        chThdSleep(MS2ST(1));
+        if (frequencies[i] <= frequencies[i - 1])
+        {
+            return false;
+        }
     }
+
+    WriteSpectrumBands(VS1053p, frequencies, bands);
+    return true;
+}
+
+/**
+ * @brief   Writes consecutive words to the codec RAM.
+ * @details The words are streamed to SCI_WRAM in one SCI multiple write,
+ *          the codec increments the address after every word.
+ *
+ * @param[in] VS1053p   pointer to the @p VS1053Driver object
+ * @param[in] addr      first RAM address as used by SCI_WRAMADDR
+ * @param[in] words     words to write
+ * @param[in] n         number of words
+ *
+ * @api
+ */
+void VS1053WriteWram(VS1053Driver* VS1053p, uint16_t addr, const uint16_t* words, size_t n)
+{
+    WriteWordRegister(VS1053p, SCI_WRAMADDR, addr);
+    WriteRegisterWords(VS1053p, SCI_WRAM, words, 1, n);
+}
+
+/**
+ * @brief   Reads consecutive words from the codec RAM.
+ *
+ * @param[in] VS1053p   pointer to the @p VS1053Driver object
+ * @param[in] addr      first RAM address as used by SCI_WRAMADDR
+ * @param[out] words    buffer for the words
+ * @param[in] n         number of words
+ *
+ * @api
+ */
+void VS1053ReadWram(VS1053Driver* VS1053p, uint16_t addr, uint16_t* words, size_t n)
+{
+    WriteWordRegister(VS1053p, SCI_WRAMADDR, addr);
+    ReadRegisterWords(VS1053p, SCI_WRAM, words, n);
+}
+
+uint16_t VS1053ReadStatus(VS1053Driver* VS1053p)
+{
+    WaitDREQ(VS1053p, VS1053_DREQ_TIMEOUT);
     return ReadRegister(VS1053p, SCI_STATUS);
 }
 
 uint16_t VS1053ReadSampleRate(VS1053Driver* VS1053p)
 {
-    while (ReadDREQ(VS1053p) == false)
+    WaitDREQ(VS1053p, VS1053_DREQ_TIMEOUT);
+    return ReadRegister(VS1053p, SCI_AUDATA);
+}
+
+uint16_t VS1053ReadDecodeTime(VS1053Driver* VS1053p)
+{
+    WaitDREQ(VS1053p, VS1053_DREQ_TIMEOUT);
+    return ReadRegister(VS1053p, SCI_DECODE_TIME);
+}
+
+void VS1053SetDecodeTime(VS1053Driver* VS1053p, uint16_t seconds)
+{
+    /* The firmware may overwrite the first write, so it is written twice.*/
+    WaitDREQ(VS1053p, VS1053_DREQ_TIMEOUT);
+    WriteWordRegister(VS1053p, SCI_DECODE_TIME, seconds);
+    WaitDREQ(VS1053p, VS1053_DREQ_TIMEOUT);
+    WriteWordRegister(VS1053p, SCI_DECODE_TIME, seconds);
+}
+
+/*
+ * Bit rates in kbit/s of the MP3 frame header bitrate index 1..14, rows are
+ * MPEG 1 layer I, II, III and MPEG 2/2.5 layer I, layer II and III.
+ */
+static const uint16_t mp3BitRates[5][14] = {
+    {32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448},
+    {32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384},
+    {32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320},
+    {32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256},
+    {8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160},
+};
+
+uint32_t VS1053ByteRate(uint16_t headerData0, uint16_t headerData1)
+{
+    if (headerData1 < 0xFFE0)
     {
-        chThdSleep(MS2ST(1));
+        /* All other formats report the average byte rate in HDAT0.*/
+        return headerData0;
     }
-    return ReadRegister(VS1053p, SCI_AUDATA);
+
+    uint8_t id = (headerData1 >> 3) & 0x03;
+    uint8_t layer = (headerData1 >> 1) & 0x03;
+    uint8_t index = headerData0 >> 12;
+    if ((id == 1) || (layer == 0) || (index == 0) || (index == 15))
+    {
+        return 0;
+    }
+
+    uint8_t row;
+    if (id == 3)
+    {
+        row = 3 - layer;
+    }
+    else
+    {
+        row = (layer == 3) ? 3 : 4;
+    }
+    return (uint32_t)mp3BitRates[row][index - 1] * 1000 / 8;
 }
 
 
@@ -15,12 +15,51 @@
 /*===========================================================================*/
 /* Driver constants.                                                         */
 /*===========================================================================*/
-#define VS1053_SPECTRUM_BANDS 5
+/**
+ * @brief   Number of bands the spectrum analyzer plugin supports.
+ */
+#define VS1053_SPECTRUM_MAX_BANDS 15
+
+/**
+ * @brief   Size of the SDI FIFO of the decoder in bytes.
+ */
+#define VS1053_SDI_FIFO_SIZE 2048
 
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
+/**
+ * @brief   Wait for DREQ on a thread queue woken by @p VS1053DREQInterruptI().
+ * @note    The board has to wire the DREQ pad to an external interrupt
+ *          and call @p VS1053DREQInterruptI() on its rising edge.
+ */
+#if !defined(VS1053_USE_DREQ_INTERRUPT) || defined(__DOXYGEN__)
+#define VS1053_USE_DREQ_INTERRUPT           TRUE
+#endif
 
+/**
+ * @brief   Use DMA backed SDI transfers for @p VS1053SendDataAsync().
+ * @note    The board has to call @p VS1053SPIEndInterruptI() from the
+ *          @p end_cb of the SPI configuration used by the codec.
+ */
+#if !defined(VS1053_USE_ASYNC_SDI) || defined(__DOXYGEN__)
+#define VS1053_USE_ASYNC_SDI                TRUE
+#endif
+
+/**
+ * @brief   Maximum time to wait for a single DREQ assertion.
+ */
+#if !defined(VS1053_DREQ_TIMEOUT) || defined(__DOXYGEN__)
+#define VS1053_DREQ_TIMEOUT                 MS2ST(100)
+#endif
+
+/**
+ * @brief   Number of test pattern rounds written at the SDI clock before
+ *          the fast SPI configuration is used.
+ */
+#if !defined(VS1053_CALIBRATION_ROUNDS) || defined(__DOXYGEN__)
+#define VS1053_CALIBRATION_ROUNDS           16
+#endif
 
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
@@ -40,11 +79,18 @@ typedef enum {
   VS1053_ACTIVE = 3,                   /**< Active.                            */
   VS1053_SCI_TRANSFER = 4,
   VS1053_SDI_TRANSFER = 5,
+  VS1053_SDI_TRANSFER_ASYNC = 6,       /**< SDI data in flight via DMA.        */
 } VS1053state_t;
 /**
  * @brief   Type of a structure representing an VS1053Driver driver.
  */
 typedef struct VS1053Driver VS1053Driver;
+
+/**
+ * @brief   Completion callback of an asynchronous SDI transfer.
+ * @note    Called from ISR context with the system locked.
+ */
+typedef void (*vs1053callback_t)(VS1053Driver* VS1053p);
 /**
  * @brief   Driver configuration structure.
  * @note    It could be empty on some architectures.
@@ -52,7 +98,20 @@ typedef struct VS1053Driver VS1053Driver;
 typedef struct
 {
     SPIDriver* spid;
+    /**
+     * @brief SPI configuration for reset and SCI, within CLKI/7 of the
+     *        codec even before the clock multiplier is applied.
+     */
     const SPIConfig* spiCfg;
+    /**
+     * @brief SPI configuration for SDI once @p clockf is applied, may be
+     *        @p NULL to use @p spiCfg for everything.
+     */
+    const SPIConfig* spiFastCfg;
+    /**
+     * @brief Value of SCI_CLOCKF, 0 keeps the driver default.
+     */
+    uint16_t              clockf;
 
     /**
      * @brief Port used of X_RESET
@@ -105,8 +164,41 @@ struct VS1053Driver {
    * @brief   Current configuration data.
    */
   const VS1053Config           *config;
+  /**
+   * @brief   SPI configuration the bus currently runs with.
+   */
+  const SPIConfig          *activeSpiCfg;
+  /**
+   * @brief   SPI configuration used for SDI, the fast one if it passed
+   *          the calibration.
+   */
+  const SPIConfig          *sdiSpiCfg;
+  /**
+   * @brief   Number of bands the spectrum analyzer is set up for.
+   */
+  uint8_t                  spectrumBands;
   uint8_t                  txBuffer[4];
   uint8_t                  rxBuffer[4];
+#if VS1053_USE_DREQ_INTERRUPT || defined(__DOXYGEN__)
+  /**
+   * @brief   Threads waiting for DREQ to be asserted.
+   */
+  threads_queue_t          dreqQueue;
+  /**
+   * @brief   Time of the last rising edge of DREQ.
+   */
+  systime_t                dreqRise;
+#endif
+#if VS1053_USE_ASYNC_SDI || defined(__DOXYGEN__)
+  /**
+   * @brief   Threads waiting for an asynchronous SDI transfer.
+   */
+  threads_queue_t          transferQueue;
+  /**
+   * @brief   Completion callback of the running SDI transfer.
+   */
+  vs1053callback_t         sdiEndCb;
+#endif
   /* End of the mandatory fields.*/
 };
 
@@ -115,13 +207,18 @@ struct VS1053Driver {
  *          Values are from 0..31 in 3dB steps.
  */
 struct VS1053SpectrumAnalyzerResult {
-    int8_t current[VS1053_SPECTRUM_BANDS];
-    int8_t peak[VS1053_SPECTRUM_BANDS];
+    uint8_t bands;
+    int8_t current[VS1053_SPECTRUM_MAX_BANDS];
+    int8_t peak[VS1053_SPECTRUM_MAX_BANDS];
 };
 /*===========================================================================*/
 /* Driver macros.                                                            */
 /*===========================================================================*/
-#define VS1053CanJump(status) (status && (1 << 15) == 0)
+/**
+ * @brief   SS_DO_NOT_JUMP is set while the codec parses a header, the stream
+ *          must not be jumped then.
+ */
+#define VS1053CanJump(status) (((status) & (1 << 15)) == 0)
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -136,12 +233,24 @@ extern "C" {
 
   void VS1053SineTest(VS1053Driver* VS1053p, uint16_t freq, uint8_t leftVol, uint8_t rightVol);
   void VS1053SetVolume(VS1053Driver* VS1053p, uint8_t leftVol, uint8_t rightVol);
+  bool VS1053ReadDREQ(VS1053Driver* VS1053p);
+  bool VS1053ReadDREQRise(VS1053Driver* VS1053p, systime_t* rise);
+  void VS1053DREQInterruptI(VS1053Driver* VS1053p);
   uint8_t VS1053SendData(VS1053Driver* VS1053p, const char* data, uint8_t bytes);
+  bool VS1053SendDataAsync(VS1053Driver* VS1053p, const char* data, uint8_t bytes, vs1053callback_t endCb);
+  void VS1053WaitSendComplete(VS1053Driver* VS1053p);
+  void VS1053SPIEndInterruptI(VS1053Driver* VS1053p);
   void VS1053StopPlaying(VS1053Driver* VS1053p);
   void VS1053ReadHeaderData(VS1053Driver* VS1053p, uint16_t* headerData0, uint16_t* headerData1);
   void VS1053ReadSpectrumAnalyzerResult(VS1053Driver* VS1053p, struct VS1053SpectrumAnalyzerResult* result);
+  bool VS1053SetSpectrumBands(VS1053Driver* VS1053p, const uint16_t* frequencies, uint8_t bands);
+  void VS1053WriteWram(VS1053Driver* VS1053p, uint16_t addr, const uint16_t* words, size_t n);
+  void VS1053ReadWram(VS1053Driver* VS1053p, uint16_t addr, uint16_t* words, size_t n);
   uint16_t VS1053ReadStatus(VS1053Driver* VS1053p);
   uint16_t VS1053ReadSampleRate(VS1053Driver* VS1053p);
+  uint16_t VS1053ReadDecodeTime(VS1053Driver* VS1053p);
+  void VS1053SetDecodeTime(VS1053Driver* VS1053p, uint16_t seconds);
+  uint32_t VS1053ByteRate(uint16_t headerData0, uint16_t headerData1);
 #ifdef __cplusplus
 }
 #endif
@@ -12,6 +12,7 @@
 
 #include "ch_tools.h"
 #include "watchdog.h"
+#include "taptrace.h"
 #include "module_init_cpp.h"
 
 #include "qhal.h"
@@ -20,6 +21,8 @@
 #include <string.h>
 #include <stdlib.h>
 
+#define EVENTMASK_RFID_IRQ EVENT_MASK(0)
+
 namespace tmb_musicplayer
 {
 template <>
@@ -33,7 +36,8 @@ ModuleRFID ModuleRFIDSingelton::instance = tmb_musicplayer::ModuleRFID();
 
 ModuleRFID::ModuleRFID() :
         m_detectedCard(false),
-        m_mfrcDriver(NULL)
+        m_mfrcDriver(NULL),
+        m_cardSensor(this)
 {
 
 }
@@ -94,27 +98,44 @@ void ModuleRFID::ThreadMain()
 {
     chRegSetThreadName("rfidreader");
 
+#if defined(RFID_IRQ)
+    event_listener_t irqListener;
+    chEvtRegisterMask(RFID_IRQ, &irqListener, EVENTMASK_RFID_IRQ);
+#endif
+
     m_detectedCard = false;
+    m_cardSensor.Init();
 
     SetRFIDDetectLed(false);
     while (!chThdShouldTerminateX())
     {
         watchdog_reload(WATCHDOG_MOD_RFID);
         bool lastDetectState = m_detectedCard;
-        m_mutex.lock();
-        MIFARE_Status_t status = MifareCheck(m_mfrcDriver, &m_cardID);
-        m_detectedCard = status == MIFARE_OK;
+
         if (m_detectedCard == false)
         {
-            /*reset cardid*/
-            m_cardID.size = 0;
+            /* The empty field is asked with a single REQA at the fast rate,
+             * the UID is only read once a card answered. Halted afterwards
+             * the card ignores further requests.*/
+            if (m_cardSensor.RequestCard() == true && ReadCard() == true)
+            {
+                m_cardSensor.HaltCard();
+            }
+        }
+        else
+        {
+            /* A known card is only woken and compared at the slow rate.*/
+            if (m_cardSensor.CheckPresence(m_cardID.bytes, m_cardID.size) == false)
+            {
+                ForgetCard();
+            }
         }
-        m_mutex.unlock();
 
         if (m_detectedCard == true)
         {
             if (lastDetectState == false)
             {
+                taptrace_mark(TAPTRACE_CARD_DETECTED);
                 SetRFIDDetectLed(true);
                 m_evtSource.broadcastFlags(CardDetected);
             }
@@ -128,8 +149,69 @@ void ModuleRFID::ThreadMain()
           }
         }
 
-        chibios_rt::BaseThread::sleep(MS2ST(100));
+        if (m_detectedCard == true)
+        {
+            chibios_rt::BaseThread::sleep(MOD_RFID_PRESENCE_INTERVAL);
+        }
+        else
+        {
+            chibios_rt::BaseThread::sleep(MOD_RFID_IDLE_POLL_INTERVAL);
+        }
+    }
+
+#if defined(RFID_IRQ)
+    chEvtUnregister(RFID_IRQ, &irqListener);
+#endif
+}
+
+bool ModuleRFID::ReadCard()
+{
+    m_mutex.lock();
+    MIFARE_Status_t status = MifareCheck(m_mfrcDriver, &m_cardID);
+    m_detectedCard = status == MIFARE_OK;
+    if (m_detectedCard == false)
+    {
+        /*reset cardid*/
+        m_cardID.size = 0;
     }
+    m_mutex.unlock();
+    return m_detectedCard;
+}
+
+void ModuleRFID::ForgetCard()
+{
+    m_mutex.lock();
+    m_detectedCard = false;
+    m_cardID.size = 0;
+    m_mutex.unlock();
+}
+
+void ModuleRFID::WriteRegister(uint8_t addr, uint8_t val)
+{
+    MFRC522WriteRegister(m_mfrcDriver, addr, val);
+}
+
+uint8_t ModuleRFID::ReadRegister(uint8_t addr)
+{
+    return MFRC522ReadRegister(m_mfrcDriver, addr);
+}
+
+void ModuleRFID::ClearIRQ()
+{
+#if defined(RFID_IRQ)
+    chEvtGetAndClearEvents(EVENTMASK_RFID_IRQ);
+#endif
+}
+
+bool ModuleRFID::WaitIRQ(uint32_t timeout)
+{
+#if defined(RFID_IRQ)
+    return chEvtWaitAnyTimeout(EVENTMASK_RFID_IRQ, MS2ST(timeout)) != 0;
+#else
+    /* Without the IRQ line just give the card the full time to answer.*/
+    chibios_rt::BaseThread::sleep(MS2ST(timeout));
+    return true;
+#endif
 }
 
 void ModuleRFID::SetRFIDDetectLed(bool on)
@@ -12,6 +12,7 @@
 #include "target_cfg.h"
 #include "threadedmodule.h"
 #include "singleton.h"
+#include "cardsensor.h"
 
 #if MOD_RFID
 
@@ -23,13 +24,24 @@
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 #ifndef MOD_RFID_THREADSIZE
-#define MOD_RFID_THREADSIZE 320
+#define MOD_RFID_THREADSIZE 384
 #endif
 
 #ifndef MOD_RFID_THREADPRIO
 #define MOD_RFID_THREADPRIO LOWPRIO
 #endif
 
+/* Time between two REQA while no card is in the field.*/
+#ifndef MOD_RFID_IDLE_POLL_INTERVAL
+#define MOD_RFID_IDLE_POLL_INTERVAL MS2ST(20)
+#endif
+
+/* Time between two WUPA presence checks of the card in the field, this
+ * is also the time until a removed card is noticed.*/
+#ifndef MOD_RFID_PRESENCE_INTERVAL
+#define MOD_RFID_PRESENCE_INTERVAL MS2ST(250)
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -43,7 +55,7 @@ namespace tmb_musicplayer
  * @brief
  */
 
-class ModuleRFID : public qos::ThreadedModule<MOD_RFID_THREADSIZE>
+class ModuleRFID : public qos::ThreadedModule<MOD_RFID_THREADSIZE>, private MFRC522Port
 {
 public:
     enum EventsFlags
@@ -72,11 +84,19 @@ protected:
 
 
 private:
+    virtual void WriteRegister(uint8_t addr, uint8_t val);
+    virtual uint8_t ReadRegister(uint8_t addr);
+    virtual void ClearIRQ();
+    virtual bool WaitIRQ(uint32_t timeout);
+
+    bool ReadCard();
+    void ForgetCard();
     void SetRFIDDetectLed(bool on);
 
     bool m_detectedCard;
     MFRC522Driver* m_mfrcDriver;
     MifareUID m_cardID;
+    CardSensor m_cardSensor;
 
     chibios_rt::EvtSource m_evtSource;
     chibios_rt::Mutex m_mutex;
@@ -0,0 +1,76 @@
+/**
+ * @file    src/mod_trace.c
+ * @brief
+ *
+ * @addtogroup
+ * @{
+ */
+
+#include "mod_trace.h"
+
+#if MOD_TRACE
+
+#include "trace.h"
+#include "taptrace.h"
+#include "mod_monitor.h"
+#include "module_init_cpp.h"
+
+namespace tmb_musicplayer
+{
+template <>
+ModuleTrace ModuleTraceSingelton::instance = tmb_musicplayer::ModuleTrace();
+
+/**
+ * @brief
+ */
+
+ModuleTrace::ModuleTrace()
+{
+
+}
+
+ModuleTrace::~ModuleTrace()
+{
+
+}
+
+void ModuleTrace::Init()
+{
+}
+
+void ModuleTrace::Start()
+{
+    BaseClass::Start();
+}
+
+void ModuleTrace::Shutdown()
+{
+    BaseClass::Shutdown();
+}
+
+void ModuleTrace::ThreadMain()
+{
+    chRegSetThreadName("trace");
+
+    while (!chThdShouldTerminateX())
+    {
+        trace_drain(DEBUG_CANNEL);
+        taptrace_report(DEBUG_CANNEL);
+#if MOD_MONITOR && MOD_MONITOR_REPORT
+        ModuleMonitorSingelton::GetInstance()->Report(DEBUG_CANNEL);
+#endif
+        chThdSleep(MOD_TRACE_DRAIN_INTERVAL);
+    }
+
+    /* Records of the modules shut down before.*/
+    trace_drain(DEBUG_CANNEL);
+}
+
+}
+
+MODULE_INITCALL(1, qos::ModuleInit<tmb_musicplayer::ModuleTraceSingelton>::Init,
+        qos::ModuleInit<tmb_musicplayer::ModuleTraceSingelton>::Start,
+        qos::ModuleInit<tmb_musicplayer::ModuleTraceSingelton>::Shutdown)
+
+#endif
+/** @} */
@@ -0,0 +1,67 @@
+/**
+ * @file    src/mod_trace.h
+ * @brief
+ *
+ * @addtogroup
+ * @{
+ */
+
+#ifndef _MOD_TRACE_H_
+#define _MOD_TRACE_H_
+
+#include "target_cfg.h"
+#include "threadedmodule.h"
+#include "singleton.h"
+
+#if MOD_TRACE
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+#ifndef MOD_TRACE_THREADSIZE
+#define MOD_TRACE_THREADSIZE 512
+#endif
+
+#ifndef MOD_TRACE_THREADPRIO
+#define MOD_TRACE_THREADPRIO LOWPRIO
+#endif
+
+/* Time between two drains of the trace ring, the ring has to hold the
+ * records written meanwhile.*/
+#ifndef MOD_TRACE_DRAIN_INTERVAL
+#define MOD_TRACE_DRAIN_INTERVAL MS2ST(20)
+#endif
+
+namespace tmb_musicplayer
+{
+/**
+ * @brief   Formats the trace records on the debug channel.
+ * @details Runs at the lowest priority, so the serial output only takes
+ *          time nobody else needs. The tap latency and monitor reports
+ *          are printed here as well, they never interleave with the
+ *          records.
+ */
+
+class ModuleTrace : public qos::ThreadedModule<MOD_TRACE_THREADSIZE>
+{
+public:
+    ModuleTrace();
+    ~ModuleTrace();
+
+    virtual void Init();
+    virtual void Start();
+    virtual void Shutdown();
+
+protected:
+    typedef qos::ThreadedModule<MOD_TRACE_THREADSIZE> BaseClass;
+
+    virtual void ThreadMain();
+    virtual tprio_t GetThreadPrio() const {return MOD_TRACE_THREADPRIO;}
+};
+typedef qos::Singleton<ModuleTrace> ModuleTraceSingelton;
+
+}
+#endif /* MOD_TRACE */
+#endif /* _MOD_TRACE_H_ */
+
+/** @} */
@@ -283,17 +283,38 @@ static MFRC522Config RFID1_cfg =
  */
 #if HAL_USE_VS1053
 VS1053Driver VS1053D1;
+
+static void spicb_vs1053(SPIDriver *spip)
+{
+    (void)spip;
+
+    osalSysLockFromISR();
+    VS1053SPIEndInterruptI(&VS1053D1);
+    osalSysUnlockFromISR();
+}
+
+/* Reset and SCI, fPCLK/16.*/
 static const SPIConfig SPI2cfg = {
-  NULL,
+  spicb_vs1053,
   GPIOC,
   14U,
   SPI_CR1_BR_0 | SPI_CR1_BR_1
 };
 
+/* SDI, fPCLK/4 stays below CLKI/4 with the 4.5x clock multiplier.*/
+static const SPIConfig SPI2fastcfg = {
+  spicb_vs1053,
+  GPIOC,
+  14U,
+  SPI_CR1_BR_0
+};
+
 static const VS1053Config VS1053D1_cfg =
 {
     .spid = &SPID2,
     .spiCfg = &SPI2cfg,
+    .spiFastCfg = &SPI2fastcfg,
+    .clockf = 0xC000,
     .xResetPort = GPIOD,
     .xResetPad = 10U,
     .xCSPort = GPIOD,
@@ -306,4 +327,74 @@ static const VS1053Config VS1053D1_cfg =
 
 #endif /* HAL_USE_VS1053 */
 
+/*
+ * External interrupt configuration.
+ */
+#if HAL_USE_EXT
+#if HAL_USE_VS1053
+static void extcb_vs1053_dreq(EXTDriver *extp, expchannel_t channel)
+{
+    (void)extp;
+    (void)channel;
+
+    osalSysLockFromISR();
+    VS1053DREQInterruptI(&VS1053D1);
+    osalSysUnlockFromISR();
+}
+#endif /* HAL_USE_VS1053 */
+
+#if HAL_USE_MFRC522
+EVENTSOURCE_DECL(RFID1_irq);
+
+static void extcb_mfrc522_irq(EXTDriver *extp, expchannel_t channel)
+{
+    (void)extp;
+    (void)channel;
+
+    osalSysLockFromISR();
+    chEvtBroadcastI(&RFID1_irq);
+    osalSysUnlockFromISR();
+}
+#endif /* HAL_USE_MFRC522 */
+
+static const EXTConfig extcfg =
+{
+    {
+        {EXT_CH_MODE_DISABLED, NULL},
+        {EXT_CH_MODE_DISABLED, NULL},
+        {EXT_CH_MODE_DISABLED, NULL},
+        {EXT_CH_MODE_DISABLED, NULL},
+        {EXT_CH_MODE_DISABLED, NULL},
+#if HAL_USE_MFRC522
+        /* PC5 MFRC522 IRQ, active low */
+        {EXT_CH_MODE_FALLING_EDGE | EXT_CH_MODE_AUTOSTART | EXT_MODE_GPIOC, extcb_mfrc522_irq},
+#else
+        {EXT_CH_MODE_DISABLED, NULL},
+#endif /* HAL_USE_MFRC522 */
+        {EXT_CH_MODE_DISABLED, NULL},
+        {EXT_CH_MODE_DISABLED, NULL},
+        {EXT_CH_MODE_DISABLED, NULL},
+#if HAL_USE_VS1053
+        /* PD9 VS1053 DREQ */
+        {EXT_CH_MODE_RISING_EDGE | EXT_CH_MODE_AUTOSTART | EXT_MODE_GPIOD, extcb_vs1053_dreq},
+#else
+        {EXT_CH_MODE_DISABLED, NULL},
+#endif /* HAL_USE_VS1053 */
+        {EXT_CH_MODE_DISABLED, NULL},
+        {EXT_CH_MODE_DISABLED, NULL},
+        {EXT_CH_MODE_DISABLED, NULL},
+        {EXT_CH_MODE_DISABLED, NULL},
+        {EXT_CH_MODE_DISABLED, NULL},
+        {EXT_CH_MODE_DISABLED, NULL},
+        {EXT_CH_MODE_DISABLED, NULL},
+        {EXT_CH_MODE_DISABLED, NULL},
+        {EXT_CH_MODE_DISABLED, NULL},
+        {EXT_CH_MODE_DISABLED, NULL},
+        {EXT_CH_MODE_DISABLED, NULL},
+        {EXT_CH_MODE_DISABLED, NULL},
+        {EXT_CH_MODE_DISABLED, NULL}
+    }
+};
+#endif /* HAL_USE_EXT */
+
 #endif /* BOARD_CFG_H_ */
@@ -514,7 +514,7 @@
  * PC2  - PIN2                      (input pullup).
  * PC3  - PDM_OUT                   (input pullup).
  * PC4  - PIN4                      (input pullup).
- * PC5  - PIN5                      (input pullup).
+ * PC5  - PIN5                      (input pullup, MFRC522 IRQ).
  * PC6  - PIN6                      (input pullup).
  * PC7  - MCLK                      (alternate 6).
  * PC8  - PIN8                      (input pullup).
@@ -30,6 +30,10 @@
 
 #if HAL_USE_MFRC522
 extern MFRC522Driver RFID1;
+#if HAL_USE_EXT
+/* Broadcast on the falling edge of the MFRC522 IRQ pin */
+extern event_source_t RFID1_irq;
+#endif /* HAL_USE_EXT */
 #endif /* HAL_USE_MFRC522 */
 
 #if HAL_USE_VS1053
@@ -170,6 +170,10 @@ void boardStart(void)
     ws281xStart(&ws281x, &ws281x_cfg);
 #endif /* HAL_USE_WS281X */
 
+#if HAL_USE_EXT
+    extStart(&EXTD1, &extcfg);
+#endif /* HAL_USE_EXT */
+
 #if HAL_USE_VS1053
     VS1053Start(&VS1053D1, &VS1053D1_cfg);
 #endif /* HAL_USE_VS1053 */
@@ -258,6 +262,10 @@ void boardStop(void)
     VS1053Stop(&VS1053D1);
 #endif /* HAL_USE_VS1053 */
 
+#if HAL_USE_EXT
+    extStop(&EXTD1);
+#endif /* HAL_USE_EXT */
+
 #if HAL_USE_WS281X
     ws281xStop(&ws281x);
 #endif /* HAL_USE_WS281X */
@@ -28,9 +28,12 @@
 
 #define CODEC                   &VS1053D1
 
+#define RFID_IRQ                &RFID1_irq
+
 #define PARTITION_BL            ((BaseNVMDevice*)&nvm_part_internal_flash_bl)
 #define PARTITION_FW            ((BaseNVMDevice*)&nvm_part_internal_flash_fw)
 #define PARTITION_BL_UPDATE     ((BaseNVMDevice*)&nvm_memory_bl_bin)
+#define RESUME_STORAGE          ((BaseNVMDevice*)&nvm_memory_bkpsram)
 
 /* List modules here. */
 #define MOD_TEST_CPP                TRUE
@@ -40,6 +43,11 @@
 #define MOD_INPUT                   TRUE
 #define MOD_EFFECTS                 TRUE
 #define MOD_CARDREADER              TRUE
+#define MOD_TRACE                   TRUE
+/* Uses the kernel debug options, see chconf.h. */
+#if !defined(NDEBUG)
+#define MOD_MONITOR                 TRUE
+#endif
 
 #define DISPLAY_WIDTH 5
 #define DISPLAY_HEIGHT 1
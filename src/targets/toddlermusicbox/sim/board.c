@@ -0,0 +1,310 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "target_cfg.h"
+
+#include "simscript.h"
+#include "chprintf.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/* MAY ONLY BE INCLUDED ONCE! */
+#include "board_cfg.h"
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+static size_t sim_stdout_write(void *ip, const uint8_t *bp, size_t n)
+{
+    (void)ip;
+    n = fwrite(bp, 1, n, stdout);
+    fflush(stdout);
+    return n;
+}
+
+static size_t sim_stdout_read(void *ip, uint8_t *bp, size_t n)
+{
+    (void)ip;
+    (void)bp;
+    (void)n;
+    return 0;
+}
+
+static msg_t sim_stdout_put(void *ip, uint8_t b)
+{
+    (void)ip;
+    putchar(b);
+    if (b == '\n')
+    {
+        fflush(stdout);
+    }
+    return MSG_OK;
+}
+
+static msg_t sim_stdout_get(void *ip)
+{
+    (void)ip;
+    return MSG_RESET;
+}
+
+static const struct BaseSequentialStreamVMT sim_stdout_vmt =
+{
+    sim_stdout_write,
+    sim_stdout_read,
+    sim_stdout_put,
+    sim_stdout_get
+};
+
+BaseSequentialStream sim_stdout = {&sim_stdout_vmt};
+
+static void report(void)
+{
+#if HAL_USE_VS1053
+    CodecModelStats stats;
+    codecModelReadStats(&stats);
+
+    uint32_t averageLatency = 0;
+    if (stats.wakeups > 0)
+    {
+        averageLatency = (uint32_t)(((uint64_t)stats.wakeupLatencyTotal * 1000000)
+                / CH_CFG_ST_FREQUENCY / stats.wakeups);
+    }
+    uint32_t maxLatency = (uint32_t)(((uint64_t)stats.wakeupLatencyMax * 1000000) / CH_CFG_ST_FREQUENCY);
+
+    chprintf(DEBUG_CANNEL, "sim: codec %u bytes, %u underruns, stalled %u ms (longest %u ms).\r\n",
+            stats.sdiBytes, stats.underruns, stats.stallTotal, stats.stallMax);
+    chprintf(DEBUG_CANNEL, "sim: DREQ answered %u times after %u us on average, %u us at most.\r\n",
+            stats.wakeups, averageLatency, maxLatency);
+#endif /* HAL_USE_VS1053 */
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Early initialization code.
+ */
+void __early_init(void)
+{
+}
+
+#if HAL_USE_SDC
+bool sdc_lld_is_card_inserted(SDCDriver *sdcp) {
+
+    return sdcp->image != NULL;
+}
+
+bool sdc_lld_is_write_protected(SDCDriver *sdcp) {
+
+  (void)sdcp;
+  return FALSE;
+}
+#endif
+
+/**
+ * @brief   Prepare all driver configurations
+ * @details The stand-ins are set up from the environment:
+ *          SIM_SDCARD          FAT image used as memory card
+ *          SIM_SCRIPT          card and button events, see simscript.h
+ *          SIM_FRAMES          file receiving the LED frames
+ *          SIM_CODEC_BITRATE   bits per second the codec consumes
+ */
+void boardInit(void)
+{
+    /**
+     * Initialize custom drivers as boardInit() is being called at the end of halInit()
+     */
+    qhalInit();
+
+    /**
+     * call *ObjectInit() for all device instances which are created in here.
+     */
+
+    /* Start status LED driver */
+#if HAL_USE_LED
+    ledObjectInit(&LED1);
+    ledObjectInit(&LED2);
+    ledObjectInit(&LED3);
+    ledObjectInit(&LED4);
+    ledObjectInit(&LED5);
+    ledObjectInit(&LED6);
+
+    ledObjectInit(&EXTO1);
+#endif /* HAL_USE_LED */
+
+    /* nvm memory drivers */
+#if HAL_USE_NVM_MEMORY
+    nvmmemoryObjectInit(&nvm_memory_bkpsram);
+#endif /* HAL_USE_NVM_MEMORY */
+
+#if HAL_USE_WS281X
+    ws281xObjectInit(&ws281x);
+    ws281x_cfg.framesPath = getenv("SIM_FRAMES");
+#endif /* HAL_USE_WS281X */
+
+#if HAL_USE_SDC
+    const char* image = getenv("SIM_SDCARD");
+    if (image != NULL)
+    {
+        if (sdcSimInsert(&SDCD1, image) == HAL_SUCCESS)
+        {
+            /* Card detect is active low.*/
+            palClearPad(IOPORT1, IOPORT1_CARD_DETECT);
+        }
+        else
+        {
+            fprintf(stderr, "sim: can not open card image %s\n", image);
+        }
+    }
+#endif /* HAL_USE_SDC */
+
+#if HAL_USE_MFRC522
+    MFRC522ObjectInit(&RFID1);
+#endif /* HAL_USE_MFRC522 */
+
+#if HAL_USE_VS1053
+    const char* bitrate = getenv("SIM_CODEC_BITRATE");
+    if ((bitrate != NULL) && (atoi(bitrate) >= 8))
+    {
+        codec_model_cfg.byteRate = atoi(bitrate) / 8;
+    }
+    VS1053ObjectInit(&VS1053D1);
+#endif /* HAL_USE_VS1053 */
+
+    const char* script = getenv("SIM_SCRIPT");
+    if ((script != NULL) && (simScriptLoad(script) == false))
+    {
+        exit(1);
+    }
+}
+
+/**
+ * @brief   Start all drivers
+ */
+void boardStart(void)
+{
+    /* Start status LED driver */
+#if HAL_USE_LED
+    ledStart(&LED1, &led_1_cfg);
+    ledStart(&LED2, &led_2_cfg);
+    ledStart(&LED3, &led_3_cfg);
+    ledStart(&LED4, &led_4_cfg);
+    ledStart(&LED5, &led_5_cfg);
+    ledStart(&LED6, &led_6_cfg);
+
+    ledStart(&EXTO1, &exto_1_cfg);
+#endif /* HAL_USE_LED */
+
+#if HAL_USE_WS281X
+    ws281xStart(&ws281x, &ws281x_cfg);
+#endif /* HAL_USE_WS281X */
+
+    simScriptStart();
+
+#if HAL_USE_VS1053
+    codecModelStart(&codec_model_cfg);
+    VS1053Start(&VS1053D1, &VS1053D1_cfg);
+#endif /* HAL_USE_VS1053 */
+
+    /* nvm memory drivers */
+#if HAL_USE_NVM_MEMORY
+    nvmmemoryStart(&nvm_memory_bkpsram, &nvm_memory_bkpsram_cfg);
+#endif /* HAL_USE_NVM_MEMORY */
+
+#if HAL_USE_SDC
+    sdcStart(&SDCD1, &sdccfg);
+#endif /* HAL_USE_SDC */
+
+#if HAL_USE_MFRC522
+    MFRC522Start(&RFID1, &RFID1_cfg);
+#endif /* HAL_USE_MFRC522 */
+}
+
+/**
+ * @brief   Stop all drivers in the reverse order of their start.
+ * @note    The simulation ends here, the report goes to the debug channel.
+ */
+void boardStop(void)
+{
+#if HAL_USE_MFRC522
+    MFRC522Stop(&RFID1);
+#endif /* HAL_USE_MFRC522 */
+
+#if HAL_USE_SDC
+    sdcStop(&SDCD1);
+#endif /* HAL_USE_SDC */
+
+    /* nvm memory drivers */
+#if HAL_USE_NVM_MEMORY
+    nvmmemorySync(&nvm_memory_bkpsram);
+    nvmmemoryStop(&nvm_memory_bkpsram);
+#endif /* HAL_USE_NVM_MEMORY */
+
+#if HAL_USE_VS1053
+    VS1053Stop(&VS1053D1);
+    codecModelStop();
+#endif /* HAL_USE_VS1053 */
+
+    simScriptStop();
+
+#if HAL_USE_WS281X
+    ws281xStop(&ws281x);
+#endif /* HAL_USE_WS281X */
+
+    /* Stop status LED driver */
+#if HAL_USE_LED
+    ledOff(&LED6);
+    ledStop(&LED6);
+    ledOff(&LED5);
+    ledStop(&LED5);
+    ledOff(&LED4);
+    ledStop(&LED4);
+    ledOff(&LED3);
+    ledStop(&LED3);
+    ledOff(&LED2);
+    ledStop(&LED2);
+    ledOff(&LED1);
+    ledStop(&LED1);
+
+    ledOff(&EXTO1);
+    ledStop(&EXTO1);
+#endif /* HAL_USE_LED */
+
+    report();
+    exit(0);
+}
+
+void boardReset(void)
+{
+    exit(0);
+}
@@ -0,0 +1,86 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef _BOARD_H_
+#define _BOARD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Setup for the toddlermusicbox host simulator.
+ */
+
+/*
+ * Board identifier.
+ */
+#define BOARD_TODDLERMUSICBOX_SIM
+#define BOARD_NAME                  "toddlermusicbox simulator"
+
+/*
+ * IO pins assignments.
+ * IOPORT1 carries everything the stand-ins drive, IOPORT2 everything the
+ * firmware drives. Buttons and card detect are active low like on the board.
+ */
+#define IOPORT1_BTN_PLAY            0U
+#define IOPORT1_BTN_NEXT            1U
+#define IOPORT1_BTN_PREV            2U
+#define IOPORT1_BTN_VOLUP           3U
+#define IOPORT1_BTN_VOLDOWN         4U
+#define IOPORT1_CARD_DETECT         5U
+#define IOPORT1_VS1053_DREQ         8U
+
+#define IOPORT2_LED1                0U
+#define IOPORT2_LED2                1U
+#define IOPORT2_LED3                2U
+#define IOPORT2_LED4                3U
+#define IOPORT2_LED5                4U
+#define IOPORT2_LED6                5U
+#define IOPORT2_EXTO1               6U
+#define IOPORT2_VS1053_XRESET       8U
+#define IOPORT2_VS1053_XCS          9U
+#define IOPORT2_VS1053_XDCS         10U
+#define IOPORT2_SPI2_NSS            11U
+
+/*
+ * I/O ports initial setup, all inputs released, the codec in reset.
+ */
+#define VAL_IOPORT1_DATA            ((1U << IOPORT1_BTN_PLAY) |             \
+                                     (1U << IOPORT1_BTN_NEXT) |             \
+                                     (1U << IOPORT1_BTN_PREV) |             \
+                                     (1U << IOPORT1_BTN_VOLUP) |            \
+                                     (1U << IOPORT1_BTN_VOLDOWN) |          \
+                                     (1U << IOPORT1_CARD_DETECT))
+#define VAL_IOPORT1_DIR             0x00000000U
+
+#define VAL_IOPORT2_DATA            ((1U << IOPORT2_EXTO1) |                \
+                                     (1U << IOPORT2_VS1053_XCS) |           \
+                                     (1U << IOPORT2_VS1053_XDCS) |          \
+                                     (1U << IOPORT2_SPI2_NSS))
+#define VAL_IOPORT2_DIR             0xFFFFFFFFU
+
+#if !defined(_FROM_ASM_)
+#ifdef __cplusplus
+extern "C" {
+#endif
+    void boardInit(void);
+    void boardStart(void);
+    void boardStop(void);
+    void boardReset(void);
+#ifdef __cplusplus
+}
+#endif
+#endif /* _FROM_ASM_ */
+
+#endif /* _BOARD_H_ */
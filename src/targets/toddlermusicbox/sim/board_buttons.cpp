@@ -0,0 +1,24 @@
+
+#include "board_buttons.h"
+#include "target_cfg.h"
+
+
+#if HAL_USE_BUTTONS
+
+tmb_musicplayer::Button BoardButtons::BtnPlay(IOPORT1, IOPORT1_BTN_PLAY);
+tmb_musicplayer::Button BoardButtons::BtnNext(IOPORT1, IOPORT1_BTN_NEXT);
+tmb_musicplayer::Button BoardButtons::BtnPrev(IOPORT1, IOPORT1_BTN_PREV);
+tmb_musicplayer::Button BoardButtons::BtnVolUp(IOPORT1, IOPORT1_BTN_VOLUP);
+tmb_musicplayer::Button BoardButtons::BtnVolDown(IOPORT1, IOPORT1_BTN_VOLDOWN);
+tmb_musicplayer::Button BoardButtons::BtnCardDetect(IOPORT1, IOPORT1_CARD_DETECT);
+
+tmb_musicplayer::Button* BoardButtons::Buttons[] = {
+        &BoardButtons::BtnPlay,
+        &BoardButtons::BtnNext,
+        &BoardButtons::BtnPrev,
+        &BoardButtons::BtnVolUp,
+        &BoardButtons::BtnVolDown,
+        &BoardButtons::BtnCardDetect
+};
+
+#endif /* HAL_USE_BUTTONS */
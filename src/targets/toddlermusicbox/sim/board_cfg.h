@@ -0,0 +1,196 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef BOARD_CFG_H_
+#define BOARD_CFG_H_
+
+#include "codecmodel.h"
+
+#if HAL_USE_PAL || defined(__DOXYGEN__)
+/**
+ * @brief   PAL setup.
+ * @details Digital I/O ports static configuration as defined in @p board.h.
+ *          This variable is used by the HAL when initializing the PAL driver.
+ */
+const PALConfig pal_default_config = {
+  {VAL_IOPORT1_DATA, VAL_IOPORT1_DIR},
+  {VAL_IOPORT2_DATA, VAL_IOPORT2_DIR}
+};
+#endif
+
+/* Status LEDs */
+#if HAL_USE_LED
+LedDriver LED1;
+static const LedConfig led_1_cfg =
+{
+    .ledport = IOPORT2,
+    .ledpad = IOPORT2_LED1,
+    .drive = LED_ACTIVE_HIGH,
+};
+
+LedDriver LED2;
+static const LedConfig led_2_cfg =
+{
+    .ledport = IOPORT2,
+    .ledpad = IOPORT2_LED2,
+    .drive = LED_ACTIVE_HIGH,
+};
+
+LedDriver LED3;
+static const LedConfig led_3_cfg =
+{
+    .ledport = IOPORT2,
+    .ledpad = IOPORT2_LED3,
+    .drive = LED_ACTIVE_HIGH,
+};
+
+LedDriver LED4;
+static const LedConfig led_4_cfg =
+{
+    .ledport = IOPORT2,
+    .ledpad = IOPORT2_LED4,
+    .drive = LED_ACTIVE_HIGH,
+};
+
+LedDriver LED5;
+static const LedConfig led_5_cfg =
+{
+    .ledport = IOPORT2,
+    .ledpad = IOPORT2_LED5,
+    .drive = LED_ACTIVE_HIGH,
+};
+
+LedDriver LED6;
+static const LedConfig led_6_cfg =
+{
+    .ledport = IOPORT2,
+    .ledpad = IOPORT2_LED6,
+    .drive = LED_ACTIVE_HIGH,
+};
+
+LedDriver EXTO1;
+static const LedConfig exto_1_cfg =
+{
+    .ledport = IOPORT2,
+    .ledpad = IOPORT2_EXTO1,
+    .drive = LED_ACTIVE_LOW,
+};
+
+#endif /* HAL_USE_LED */
+
+#if HAL_USE_NVM_MEMORY
+static uint8_t bkpsram[4096];
+NVMMemoryDriver nvm_memory_bkpsram;
+static const NVMMemoryConfig nvm_memory_bkpsram_cfg =
+{
+    .memoryp = bkpsram,
+    .sector_size = 1,
+    .sector_num = sizeof(bkpsram),
+};
+#endif /* HAL_USE_NVM_MEMORY */
+
+#if HAL_USE_WS281X
+ws281xDriver ws281x;
+/* @note    framesPath is filled in at runtime. */
+static ws281xConfig ws281x_cfg =
+{
+    .ledCount = 5,
+    .framesPath = NULL,
+};
+#endif /* HAL_USE_WS281X */
+
+#if HAL_USE_SDC
+static uint8_t sd_scratchpad[512];
+static const SDCConfig sdccfg = {
+  sd_scratchpad,
+  SDC_MODE_4BIT
+};
+#endif /* HAL_USE_SDC */
+
+/*
+ * RFID configuration, the registers are served by the script.
+ */
+#if HAL_USE_MFRC522
+MFRC522Driver RFID1;
+EVENTSOURCE_DECL(RFID1_irq);
+
+static MFRC522Config RFID1_cfg =
+{
+
+};
+#endif /* HAL_USE_MFRC522 */
+
+/*
+ * VSConfiguration
+ */
+#if HAL_USE_VS1053
+VS1053Driver VS1053D1;
+
+static void spicb_vs1053(SPIDriver *spip)
+{
+    (void)spip;
+
+    osalSysLockFromISR();
+    VS1053SPIEndInterruptI(&VS1053D1);
+    osalSysUnlockFromISR();
+}
+
+static void codec_dreq_rising(void)
+{
+    VS1053DREQInterruptI(&VS1053D1);
+}
+
+/* Reset and SCI, fPCLK/16.*/
+static const SPIConfig SPI2cfg = {
+  spicb_vs1053,
+  IOPORT2,
+  IOPORT2_SPI2_NSS,
+  42000000 / 16,
+  &codec_model_device
+};
+
+/* SDI, fPCLK/4.*/
+static const SPIConfig SPI2fastcfg = {
+  spicb_vs1053,
+  IOPORT2,
+  IOPORT2_SPI2_NSS,
+  42000000 / 4,
+  &codec_model_device
+};
+
+static const VS1053Config VS1053D1_cfg =
+{
+    .spid = &SPID2,
+    .spiCfg = &SPI2cfg,
+    .spiFastCfg = &SPI2fastcfg,
+    .clockf = 0xC000,
+    .xResetPort = IOPORT2,
+    .xResetPad = IOPORT2_VS1053_XRESET,
+    .xCSPort = IOPORT2,
+    .xCSPad = IOPORT2_VS1053_XCS,
+    .xDCSPort = IOPORT2,
+    .xDCSPad = IOPORT2_VS1053_XDCS,
+    .xDREQPort = IOPORT1,
+    .xDREQPad = IOPORT1_VS1053_DREQ,
+};
+
+/* @note    byteRate is filled in at runtime. */
+static CodecModelConfig codec_model_cfg =
+{
+    .byteRate = 128000 / 8,
+    .dreqRisingCb = codec_dreq_rising,
+};
+#endif /* HAL_USE_VS1053 */
+
+#endif /* BOARD_CFG_H_ */
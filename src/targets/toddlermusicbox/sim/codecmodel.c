@@ -0,0 +1,376 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "codecmodel.h"
+
+#include <string.h>
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+#define CODEC_FIFO_SIZE         2048
+#define CODEC_DREQ_SPACE        32
+#define CODEC_DRAIN_PERIOD      MS2ST(1)
+
+#define CODEC_WRITE_COMMAND     0x02
+#define CODEC_READ_COMMAND      0x03
+
+#define SCI_MODE                0x00
+#define SCI_STATUS              0x01
+#define SCI_DECODE_TIME         0x04
+#define SCI_WRAM                0x06
+#define SCI_WRAMADDR            0x07
+#define SCI_HDAT0               0x08
+#define SCI_HDAT1               0x09
+
+#define SM_RESET                0x0004
+#define SM_CANCEL               0x0008
+#define SM_SDINEW               0x0800
+
+/* "ve" of RIFF WAVE in HDAT1.*/
+#define HDAT1_WAV               0x7665
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+static const CodecModelConfig* config;
+static virtual_timer_t drainTimer;
+
+static uint16_t regs[16];
+static uint16_t wram[0x10000];
+
+/* SCI frame, restarted by every select of the bus.*/
+static uint32_t framePos;
+static uint8_t frameCommand;
+static uint8_t frameAddress;
+static uint8_t frameHigh;
+static uint16_t frameRead;
+
+static uint32_t fifoLevel;
+static uint32_t drainRemainder;
+static uint32_t decodedBytes;
+static uint32_t cancelBytes;
+
+static bool streaming;
+static bool dry;
+static systime_t dryStart;
+
+static bool dreq;
+static bool wakeupPending;
+static systime_t dreqRise;
+
+static CodecModelStats stats;
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+static void ResetCodec(void)
+{
+    memset(regs, 0, sizeof(regs));
+    regs[SCI_MODE] = SM_SDINEW;
+    fifoLevel = 0;
+    drainRemainder = 0;
+    decodedBytes = 0;
+    cancelBytes = 0;
+    streaming = false;
+    dry = false;
+    wakeupPending = false;
+}
+
+static void UpdateDREQI(void)
+{
+    bool level = (palReadPad(IOPORT2, IOPORT2_VS1053_XRESET) == PAL_HIGH)
+            && ((CODEC_FIFO_SIZE - fifoLevel) >= CODEC_DREQ_SPACE);
+
+    if (level == dreq)
+    {
+        return;
+    }
+    dreq = level;
+    if (level == true)
+    {
+        palSetPad(IOPORT1, IOPORT1_VS1053_DREQ);
+        dreqRise = chVTGetSystemTimeX();
+        wakeupPending = streaming;
+        config->dreqRisingCb();
+    }
+    else
+    {
+        palClearPad(IOPORT1, IOPORT1_VS1053_DREQ);
+    }
+}
+
+static uint16_t ReadSCI(uint8_t address)
+{
+    switch (address)
+    {
+    case SCI_DECODE_TIME:
+        return regs[SCI_DECODE_TIME] + (decodedBytes / config->byteRate);
+    case SCI_WRAM:
+        return wram[regs[SCI_WRAMADDR]++];
+    case SCI_HDAT0:
+        if (streaming == false)
+        {
+            return 0;
+        }
+        return (config->byteRate > 0xFFFF) ? 0xFFFF : config->byteRate;
+    case SCI_HDAT1:
+        return (streaming == true) ? HDAT1_WAV : 0;
+    default:
+        return regs[address];
+    }
+}
+
+static void WriteSCI(uint8_t address, uint16_t value)
+{
+    switch (address)
+    {
+    case SCI_MODE:
+        if (value & SM_RESET)
+        {
+            ResetCodec();
+            regs[SCI_MODE] = value & ~SM_RESET;
+            return;
+        }
+        if ((value & SM_CANCEL) && !(regs[SCI_MODE] & SM_CANCEL))
+        {
+            cancelBytes = 0;
+        }
+        regs[SCI_MODE] = value;
+        break;
+    case SCI_DECODE_TIME:
+        regs[SCI_DECODE_TIME] = value;
+        decodedBytes = 0;
+        break;
+    case SCI_WRAM:
+        wram[regs[SCI_WRAMADDR]++] = value;
+        break;
+    default:
+        regs[address] = value;
+        break;
+    }
+}
+
+static uint8_t TransferSCI(uint8_t byte)
+{
+    uint32_t pos = framePos++;
+    if (pos == 0)
+    {
+        frameCommand = byte;
+        return 0;
+    }
+    if (pos == 1)
+    {
+        frameAddress = byte & 0x0F;
+        if (frameCommand == CODEC_READ_COMMAND)
+        {
+            frameRead = ReadSCI(frameAddress);
+        }
+        return 0;
+    }
+
+    if (frameCommand == CODEC_READ_COMMAND)
+    {
+        /* Every read is a frame of its own, the driver repeats the command.*/
+        if (pos == 2)
+        {
+            return frameRead >> 8;
+        }
+        framePos = 0;
+        return frameRead & 0xFF;
+    }
+
+    /* Multiple writes keep sending words after the address.*/
+    if (frameCommand == CODEC_WRITE_COMMAND)
+    {
+        if ((pos & 1) == 0)
+        {
+            frameHigh = byte;
+        }
+        else
+        {
+            WriteSCI(frameAddress, (frameHigh << 8) | byte);
+        }
+    }
+    return 0;
+}
+
+static void TransferSDI(size_t n)
+{
+    systime_t now = chVTGetSystemTimeX();
+
+    if (regs[SCI_MODE] & SM_CANCEL)
+    {
+        /* The decoder gives up on the stream after the next 32 bytes.*/
+        cancelBytes += n;
+        if (cancelBytes >= CODEC_DREQ_SPACE)
+        {
+            regs[SCI_MODE] &= ~SM_CANCEL;
+            fifoLevel = 0;
+            streaming = false;
+            dry = false;
+        }
+        return;
+    }
+
+    if (wakeupPending == true)
+    {
+        systime_t latency = now - dreqRise;
+        stats.wakeups++;
+        stats.wakeupLatencyTotal += latency;
+        if (latency > stats.wakeupLatencyMax)
+        {
+            stats.wakeupLatencyMax = latency;
+        }
+        wakeupPending = false;
+    }
+
+    if (dry == true)
+    {
+        uint32_t stall = (uint32_t)(((uint64_t)(now - dryStart) * 1000) / CH_CFG_ST_FREQUENCY);
+        stats.underruns++;
+        stats.stallTotal += stall;
+        if (stall > stats.stallMax)
+        {
+            stats.stallMax = stall;
+        }
+        dry = false;
+    }
+
+    streaming = true;
+    stats.sdiBytes += n;
+    fifoLevel += n;
+    if (fifoLevel > CODEC_FIFO_SIZE)
+    {
+        fifoLevel = CODEC_FIFO_SIZE;
+    }
+}
+
+static void CodecSelect(void)
+{
+    framePos = 0;
+}
+
+/*
+ * Bytes go to SCI while xCS is low, to SDI while only xDCS is low and are
+ * lost while the chip is held in reset.
+ */
+static void CodecTransfer(const uint8_t* txbuf, uint8_t* rxbuf, size_t n)
+{
+    if (palReadPad(IOPORT2, IOPORT2_VS1053_XRESET) == PAL_LOW)
+    {
+        if (rxbuf != NULL)
+        {
+            memset(rxbuf, 0, n);
+        }
+        return;
+    }
+
+    if (palReadPad(IOPORT2, IOPORT2_VS1053_XCS) == PAL_LOW)
+    {
+        size_t i;
+        for (i = 0; i < n; i++)
+        {
+            uint8_t rx = TransferSCI((txbuf != NULL) ? txbuf[i] : 0xFF);
+            if (rxbuf != NULL)
+            {
+                rxbuf[i] = rx;
+            }
+        }
+    }
+    else if (palReadPad(IOPORT2, IOPORT2_VS1053_XDCS) == PAL_LOW)
+    {
+        TransferSDI(n);
+        if (rxbuf != NULL)
+        {
+            memset(rxbuf, 0, n);
+        }
+    }
+    UpdateDREQI();
+}
+
+static void DrainCallback(void* p)
+{
+    (void)p;
+
+    chSysLockFromISR();
+    if (palReadPad(IOPORT2, IOPORT2_VS1053_XRESET) == PAL_LOW)
+    {
+        ResetCodec();
+    }
+    else
+    {
+        drainRemainder += config->byteRate;
+        uint32_t budget = drainRemainder / 1000;
+        drainRemainder %= 1000;
+
+        uint32_t consumed = (budget < fifoLevel) ? budget : fifoLevel;
+        fifoLevel -= consumed;
+        decodedBytes += consumed;
+        if ((streaming == true) && (dry == false) && (consumed < budget))
+        {
+            dry = true;
+            dryStart = chVTGetSystemTimeX();
+        }
+    }
+    UpdateDREQI();
+
+    chVTSetI(&drainTimer, CODEC_DRAIN_PERIOD, DrainCallback, NULL);
+    chSysUnlockFromISR();
+}
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+const SPISimDevice codec_model_device =
+{
+    CodecSelect,
+    CodecTransfer,
+};
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+void codecModelStart(const CodecModelConfig* cfg)
+{
+    osalDbgCheck((cfg != NULL) && (cfg->byteRate > 0));
+
+    config = cfg;
+    ResetCodec();
+    dreq = false;
+    memset(&stats, 0, sizeof(stats));
+    chVTObjectInit(&drainTimer);
+    chVTSet(&drainTimer, CODEC_DRAIN_PERIOD, DrainCallback, NULL);
+}
+
+void codecModelStop(void)
+{
+    chVTReset(&drainTimer);
+}
+
+void codecModelReadStats(CodecModelStats* result)
+{
+    chSysLock();
+    *result = stats;
+    chSysUnlock();
+}
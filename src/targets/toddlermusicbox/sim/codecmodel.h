@@ -0,0 +1,64 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef CODECMODEL_H_
+#define CODECMODEL_H_
+
+#include "hal.h"
+
+/*
+ * @brief   VS1053 stand-in behind SPID2.
+ * @details SCI reads and writes go to a register file and WRAM, SDI bytes
+ *          enter a 2048 byte FIFO which is drained at a fixed byte rate.
+ *          DREQ is high while the FIFO takes another 32 bytes. Every
+ *          stream is reported as a WAV file with the drain rate as byte
+ *          rate. The FIFO running dry while a stream is going on counts as
+ *          an underrun, so do pauses.
+ */
+
+typedef void (*codecdreqcallback_t)(void);
+
+typedef struct {
+    /* Bytes per second the decoder consumes.*/
+    uint32_t byteRate;
+    /* Called locked from the timer interrupt or an SPI transfer on the
+     * rising edge of DREQ.*/
+    codecdreqcallback_t dreqRisingCb;
+} CodecModelConfig;
+
+typedef struct {
+    uint32_t sdiBytes;
+    uint32_t underruns;
+    /* Time the FIFO was dry within a stream, in ms.*/
+    uint32_t stallTotal;
+    uint32_t stallMax;
+    /* Rising DREQ edges answered with SDI data and the time it took.*/
+    uint32_t wakeups;
+    systime_t wakeupLatencyTotal;
+    systime_t wakeupLatencyMax;
+} CodecModelStats;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern const SPISimDevice codec_model_device;
+
+void codecModelStart(const CodecModelConfig* config);
+void codecModelStop(void);
+void codecModelReadStats(CodecModelStats* stats);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CODECMODEL_H_ */
@@ -0,0 +1,386 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_sdc_lld.c
+ * @brief   Simulated SDC low level driver code.
+ *
+ * @addtogroup SDC
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+
+#if HAL_USE_SDC || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/* Relative card address handed out by CMD3.*/
+#define SIM_SDC_RCA                         0x12340000U
+
+/* R1 with the card in the transfer state and no error bits.*/
+#define SIM_SDC_R1_TRAN                     (MMCSD_STS_TRAN << 9U)
+
+/* OCR of a powered up high capacity card.*/
+#define SIM_SDC_OCR                         0xC0FF8000U
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/** @brief SDCD1 driver identifier.*/
+SDCDriver SDCD1;
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/*
+ * CSD version 2.0, only the structure and C_SIZE are looked at by the HAL.
+ */
+static void sdc_lld_build_csd(SDCDriver *sdcp, uint32_t *csd) {
+  uint32_t c_size = sdcp->blocks / 1024U;
+
+  if (c_size > 0U) {
+    c_size--;
+  }
+  csd[0] = 0U;
+  csd[1] = (c_size & 0xFFFFU) << 16U;
+  csd[2] = (c_size >> 16U) & 0x3FU;
+  csd[3] = 0x40000000U;
+}
+
+static bool sdc_lld_answer(SDCDriver *sdcp, uint8_t cmd, uint32_t arg,
+                           uint32_t *resp) {
+
+  if (sdcp->image == NULL) {
+    sdcp->errors |= SDC_COMMAND_TIMEOUT;
+    return HAL_FAILED;
+  }
+
+  switch (cmd) {
+  case MMCSD_CMD_SEND_IF_COND:
+    resp[0] = arg & 0xFFFU;
+    break;
+  case MMCSD_CMD_APP_OP_COND:
+    resp[0] = SIM_SDC_OCR;
+    break;
+  case MMCSD_CMD_SEND_RELATIVE_ADDR:
+    resp[0] = SIM_SDC_RCA;
+    break;
+  case MMCSD_CMD_ALL_SEND_CID:
+    memset(resp, 0, 4U * sizeof(uint32_t));
+    break;
+  case MMCSD_CMD_SEND_CSD:
+    sdc_lld_build_csd(sdcp, resp);
+    break;
+  default:
+    resp[0] = SIM_SDC_R1_TRAN;
+    break;
+  }
+  return HAL_SUCCESS;
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level SDC driver initialization.
+ *
+ * @notapi
+ */
+void sdc_lld_init(void) {
+
+  sdcObjectInit(&SDCD1);
+  SDCD1.image = NULL;
+  SDCD1.blocks = 0U;
+}
+
+/**
+ * @brief   Inserts the card image at @p path.
+ * @note    Without an image the slot stays empty.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] path      FAT image on the host
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  if the image was opened.
+ * @retval HAL_FAILED   if the image can not be opened.
+ */
+bool sdcSimInsert(SDCDriver *sdcp, const char *path) {
+  FILE *image = fopen(path, "r+b");
+
+  if (image == NULL) {
+    return HAL_FAILED;
+  }
+  fseek(image, 0, SEEK_END);
+  sdcp->blocks = (uint32_t)(ftell(image) / MMCSD_BLOCK_SIZE);
+  sdcp->image = image;
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Configures and activates the SDC peripheral.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ *
+ * @notapi
+ */
+void sdc_lld_start(SDCDriver *sdcp) {
+
+  (void)sdcp;
+}
+
+/**
+ * @brief   Deactivates the SDC peripheral.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ *
+ * @notapi
+ */
+void sdc_lld_stop(SDCDriver *sdcp) {
+
+  if (sdcp->image != NULL) {
+    fflush(sdcp->image);
+  }
+}
+
+/**
+ * @brief   Starts the SDIO clock and sets it to init mode (400kHz or less).
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ *
+ * @notapi
+ */
+void sdc_lld_start_clk(SDCDriver *sdcp) {
+
+  (void)sdcp;
+}
+
+/**
+ * @brief   Sets the SDIO clock to data mode.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] clk       the clock mode
+ *
+ * @notapi
+ */
+void sdc_lld_set_data_clk(SDCDriver *sdcp, sdcbusclk_t clk) {
+
+  (void)sdcp;
+  (void)clk;
+}
+
+/**
+ * @brief   Stops the SDIO clock.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ *
+ * @notapi
+ */
+void sdc_lld_stop_clk(SDCDriver *sdcp) {
+
+  (void)sdcp;
+}
+
+/**
+ * @brief   Switches the bus to 1, 4 or 8 bits mode.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] mode      bus mode
+ *
+ * @notapi
+ */
+void sdc_lld_set_bus_mode(SDCDriver *sdcp, sdcbusmode_t mode) {
+
+  (void)sdcp;
+  (void)mode;
+}
+
+/**
+ * @brief   Sends an SDIO command with no response expected.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] cmd       card command
+ * @param[in] arg       command argument
+ *
+ * @notapi
+ */
+void sdc_lld_send_cmd_none(SDCDriver *sdcp, uint8_t cmd, uint32_t arg) {
+
+  (void)sdcp;
+  (void)cmd;
+  (void)arg;
+}
+
+/**
+ * @brief   Sends an SDIO command with a short response expected.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] cmd       card command
+ * @param[in] arg       command argument
+ * @param[out] resp     pointer to the response buffer (one word)
+ * @return              The operation status.
+ *
+ * @notapi
+ */
+bool sdc_lld_send_cmd_short(SDCDriver *sdcp, uint8_t cmd, uint32_t arg,
+                            uint32_t *resp) {
+
+  return sdc_lld_answer(sdcp, cmd, arg, resp);
+}
+
+/**
+ * @brief   Sends an SDIO command with a short response expected and CRC.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] cmd       card command
+ * @param[in] arg       command argument
+ * @param[out] resp     pointer to the response buffer (one word)
+ * @return              The operation status.
+ *
+ * @notapi
+ */
+bool sdc_lld_send_cmd_short_crc(SDCDriver *sdcp, uint8_t cmd, uint32_t arg,
+                                uint32_t *resp) {
+
+  return sdc_lld_answer(sdcp, cmd, arg, resp);
+}
+
+/**
+ * @brief   Sends an SDIO command with a long response expected and CRC.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] cmd       card command
+ * @param[in] arg       command argument
+ * @param[out] resp     pointer to the response buffer (four words)
+ * @return              The operation status.
+ *
+ * @notapi
+ */
+bool sdc_lld_send_cmd_long_crc(SDCDriver *sdcp, uint8_t cmd, uint32_t arg,
+                               uint32_t *resp) {
+
+  return sdc_lld_answer(sdcp, cmd, arg, resp);
+}
+
+/**
+ * @brief   Reads special registers using data bus.
+ * @details The switch function status reports no high speed support, the
+ *          SCR offers 1 and 4 bit bus widths.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[out] buf      pointer to the read buffer
+ * @param[in] bytes     number of bytes to read
+ * @param[in] cmd       card command
+ * @param[in] arg       argument for command
+ * @return              The operation status.
+ *
+ * @notapi
+ */
+bool sdc_lld_read_special(SDCDriver *sdcp, uint8_t *buf, size_t bytes,
+                          uint8_t cmd, uint32_t arg) {
+
+  (void)arg;
+  if (sdcp->image == NULL) {
+    return HAL_FAILED;
+  }
+  memset(buf, 0, bytes);
+  /* ACMD51, SEND_SCR.*/
+  if ((cmd == 51U) && (bytes >= 2U)) {
+    buf[0] = 0x02U;
+    buf[1] = 0x35U;
+  }
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Reads one or more blocks.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] startblk  first block to read
+ * @param[out] buf      pointer to the read buffer
+ * @param[in] blocks    number of blocks to read
+ * @return              The operation status.
+ *
+ * @notapi
+ */
+bool sdc_lld_read(SDCDriver *sdcp, uint32_t startblk,
+                  uint8_t *buf, uint32_t blocks) {
+
+  if ((sdcp->image == NULL) || (startblk + blocks > sdcp->blocks)) {
+    return HAL_FAILED;
+  }
+  if ((fseek(sdcp->image, (long)startblk * MMCSD_BLOCK_SIZE, SEEK_SET) != 0) ||
+      (fread(buf, MMCSD_BLOCK_SIZE, blocks, sdcp->image) != blocks)) {
+    return HAL_FAILED;
+  }
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Writes one or more blocks.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @param[in] startblk  first block to write
+ * @param[out] buf      pointer to the write buffer
+ * @param[in] blocks    number of blocks to write
+ * @return              The operation status.
+ *
+ * @notapi
+ */
+bool sdc_lld_write(SDCDriver *sdcp, uint32_t startblk,
+                   const uint8_t *buf, uint32_t blocks) {
+
+  if ((sdcp->image == NULL) || (startblk + blocks > sdcp->blocks)) {
+    return HAL_FAILED;
+  }
+  if ((fseek(sdcp->image, (long)startblk * MMCSD_BLOCK_SIZE, SEEK_SET) != 0) ||
+      (fwrite(buf, MMCSD_BLOCK_SIZE, blocks, sdcp->image) != blocks)) {
+    return HAL_FAILED;
+  }
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Waits for card idle condition.
+ *
+ * @param[in] sdcp      pointer to the @p SDCDriver object
+ * @return              The operation status.
+ *
+ * @api
+ */
+bool sdc_lld_sync(SDCDriver *sdcp) {
+
+  if (sdcp->image != NULL) {
+    fflush(sdcp->image);
+  }
+  return HAL_SUCCESS;
+}
+
+#endif /* HAL_USE_SDC */
+
+/** @} */
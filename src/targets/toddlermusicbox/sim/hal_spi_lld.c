@@ -0,0 +1,233 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_spi_lld.c
+ * @brief   Simulated SPI low level driver code.
+ *
+ * @addtogroup SPI
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+
+#if HAL_USE_SPI || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/** @brief SPI2 driver identifier.*/
+#if SIM_SPI_USE_SPI2 || defined(__DOXYGEN__)
+SPIDriver SPID2;
+#endif
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/*
+ * Runs in the timer interrupt like a DMA completion would. Virtual timer
+ * callbacks are invoked outside the lock, the driver handling enters it
+ * itself.
+ */
+static void spi_lld_serve_interrupt(void *p) {
+  SPIDriver *spip = (SPIDriver *)p;
+
+  _spi_isr_code(spip);
+}
+
+static void spi_lld_start_transfer(SPIDriver *spip, size_t n,
+                                   const void *txbuf, void *rxbuf) {
+  const SPIConfig *cfg = spip->config;
+
+  if (cfg->device != NULL) {
+    cfg->device->transfer((const uint8_t *)txbuf, (uint8_t *)rxbuf, n);
+  }
+  else if (rxbuf != NULL) {
+    memset(rxbuf, 0xFF, n);
+  }
+
+  /* At least one tick, transfers never complete inside the call.*/
+  uint64_t ticks = ((uint64_t)n * 8U * CH_CFG_ST_FREQUENCY + cfg->bitrate - 1U) /
+                   cfg->bitrate;
+  if (ticks == 0U) {
+    ticks = 1U;
+  }
+  chVTSetI(&spip->vt, (systime_t)ticks, spi_lld_serve_interrupt, spip);
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level SPI driver initialization.
+ *
+ * @notapi
+ */
+void spi_lld_init(void) {
+
+#if SIM_SPI_USE_SPI2
+  spiObjectInit(&SPID2);
+  chVTObjectInit(&SPID2.vt);
+#endif
+}
+
+/**
+ * @brief   Configures and activates the SPI peripheral.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_start(SPIDriver *spip) {
+
+  osalDbgAssert(spip->config->bitrate > 0U, "invalid bitrate");
+}
+
+/**
+ * @brief   Deactivates the SPI peripheral.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_stop(SPIDriver *spip) {
+
+  osalSysLock();
+  chVTResetI(&spip->vt);
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Asserts the slave select signal and prepares for transfers.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_select(SPIDriver *spip) {
+
+  palClearPad(spip->config->ssport, spip->config->sspad);
+  if (spip->config->device != NULL) {
+    spip->config->device->select();
+  }
+}
+
+/**
+ * @brief   Deasserts the slave select signal.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ *
+ * @notapi
+ */
+void spi_lld_unselect(SPIDriver *spip) {
+
+  palSetPad(spip->config->ssport, spip->config->sspad);
+}
+
+/**
+ * @brief   Ignores data on the SPI bus.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to be ignored
+ *
+ * @notapi
+ */
+void spi_lld_ignore(SPIDriver *spip, size_t n) {
+
+  spi_lld_start_transfer(spip, n, NULL, NULL);
+}
+
+/**
+ * @brief   Exchanges data on the SPI bus.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to be exchanged
+ * @param[in] txbuf     the pointer to the transmit buffer
+ * @param[out] rxbuf    the pointer to the receive buffer
+ *
+ * @notapi
+ */
+void spi_lld_exchange(SPIDriver *spip, size_t n,
+                      const void *txbuf, void *rxbuf) {
+
+  spi_lld_start_transfer(spip, n, txbuf, rxbuf);
+}
+
+/**
+ * @brief   Sends data over the SPI bus.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to send
+ * @param[in] txbuf     the pointer to the transmit buffer
+ *
+ * @notapi
+ */
+void spi_lld_send(SPIDriver *spip, size_t n, const void *txbuf) {
+
+  spi_lld_start_transfer(spip, n, txbuf, NULL);
+}
+
+/**
+ * @brief   Receives data from the SPI bus.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] n         number of words to receive
+ * @param[out] rxbuf    the pointer to the receive buffer
+ *
+ * @notapi
+ */
+void spi_lld_receive(SPIDriver *spip, size_t n, void *rxbuf) {
+
+  spi_lld_start_transfer(spip, n, NULL, rxbuf);
+}
+
+/**
+ * @brief   Exchanges one frame using a polled wait.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object
+ * @param[in] frame     the data frame to send over the SPI bus
+ * @return              The received data frame from the SPI bus.
+ */
+uint16_t spi_lld_polled_exchange(SPIDriver *spip, uint16_t frame) {
+  uint8_t tx = (uint8_t)frame;
+  uint8_t rx = 0xFFU;
+
+  if (spip->config->device != NULL) {
+    osalSysLock();
+    spip->config->device->transfer(&tx, &rx, 1U);
+    osalSysUnlock();
+  }
+  return rx;
+}
+
+#endif /* HAL_USE_SPI */
+
+/** @} */
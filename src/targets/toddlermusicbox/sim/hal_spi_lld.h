@@ -0,0 +1,178 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_spi_lld.h
+ * @brief   Simulated SPI low level driver header.
+ * @details The bus hands every transfer to the device model attached to
+ *          the configuration and completes it from a virtual timer after
+ *          the time the bytes would take at the configured bit rate.
+ *
+ * @addtogroup SPI
+ * @{
+ */
+
+#ifndef _HAL_SPI_LLD_H_
+#define _HAL_SPI_LLD_H_
+
+#if HAL_USE_SPI || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   SPID2 driver enable switch.
+ */
+#if !defined(SIM_SPI_USE_SPI2) || defined(__DOXYGEN__)
+#define SIM_SPI_USE_SPI2                    TRUE
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a structure representing an SPI driver.
+ */
+typedef struct SPIDriver SPIDriver;
+
+/**
+ * @brief   SPI notification callback type.
+ *
+ * @param[in] spip      pointer to the @p SPIDriver object triggering the
+ *                      callback
+ */
+typedef void (*spicallback_t)(SPIDriver *spip);
+
+/**
+ * @brief   Device model on the other end of the bus.
+ */
+typedef struct {
+  /**
+   * @brief   Called when the slave select is asserted.
+   */
+  void                      (*select)(void);
+  /**
+   * @brief   Clocks @p n bytes, @p txbuf or @p rxbuf may be @p NULL.
+   * @note    Called with the system locked.
+   */
+  void                      (*transfer)(const uint8_t *txbuf,
+                                        uint8_t *rxbuf, size_t n);
+} SPISimDevice;
+
+/**
+ * @brief   Driver configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief   Operation complete callback or @p NULL.
+   */
+  spicallback_t             end_cb;
+  /* End of the mandatory fields.*/
+  /**
+   * @brief   The chip select line port.
+   */
+  ioportid_t                ssport;
+  /**
+   * @brief   The chip select line pad number.
+   */
+  uint16_t                  sspad;
+  /**
+   * @brief   Bus clock in bits per second.
+   */
+  uint32_t                  bitrate;
+  /**
+   * @brief   Device model receiving the transfers.
+   */
+  const SPISimDevice        *device;
+} SPIConfig;
+
+/**
+ * @brief   Structure representing an SPI driver.
+ */
+struct SPIDriver {
+  /**
+   * @brief   Driver state.
+   */
+  spistate_t                state;
+  /**
+   * @brief   Current configuration data.
+   */
+  const SPIConfig           *config;
+#if SPI_USE_WAIT || defined(__DOXYGEN__)
+  /**
+   * @brief   Waiting thread.
+   */
+  thread_reference_t        thread;
+#endif /* SPI_USE_WAIT */
+#if SPI_USE_MUTUAL_EXCLUSION || defined(__DOXYGEN__)
+  /**
+   * @brief   Mutex protecting the peripheral.
+   */
+  mutex_t                   mutex;
+#endif /* SPI_USE_MUTUAL_EXCLUSION */
+#if defined(SPI_DRIVER_EXT_FIELDS)
+  SPI_DRIVER_EXT_FIELDS
+#endif
+  /* End of the mandatory fields.*/
+  /**
+   * @brief   Completes the running transfer.
+   */
+  virtual_timer_t           vt;
+};
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if SIM_SPI_USE_SPI2 && !defined(__DOXYGEN__)
+extern SPIDriver SPID2;
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void spi_lld_init(void);
+  void spi_lld_start(SPIDriver *spip);
+  void spi_lld_stop(SPIDriver *spip);
+  void spi_lld_select(SPIDriver *spip);
+  void spi_lld_unselect(SPIDriver *spip);
+  void spi_lld_ignore(SPIDriver *spip, size_t n);
+  void spi_lld_exchange(SPIDriver *spip, size_t n,
+                        const void *txbuf, void *rxbuf);
+  void spi_lld_send(SPIDriver *spip, size_t n, const void *txbuf);
+  void spi_lld_receive(SPIDriver *spip, size_t n, void *rxbuf);
+  uint16_t spi_lld_polled_exchange(SPIDriver *spip, uint16_t frame);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_SPI */
+
+#endif /* _HAL_SPI_LLD_H_ */
+
+/** @} */
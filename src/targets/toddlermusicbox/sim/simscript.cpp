@@ -0,0 +1,248 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "simscript.h"
+#include "target_cfg.h"
+
+#include "common/ut/fakemfrc522.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" {
+extern binary_semaphore_t main_shutdown_sema;
+}
+
+namespace
+{
+
+struct ButtonWindow
+{
+    uint32_t pad;
+    uint32_t start;
+    uint32_t end;
+};
+
+struct ButtonName
+{
+    const char* name;
+    uint32_t pad;
+};
+
+const ButtonName buttonNames[] = {
+    {"play", IOPORT1_BTN_PLAY},
+    {"next", IOPORT1_BTN_NEXT},
+    {"prev", IOPORT1_BTN_PREV},
+    {"volup", IOPORT1_BTN_VOLUP},
+    {"voldown", IOPORT1_BTN_VOLDOWN},
+};
+
+FakeMFRC522 rfid;
+bool rfidIrq = false;
+std::vector<ButtonWindow> buttons;
+uint32_t stopTime = 0;
+systime_t startTime = 0;
+virtual_timer_t scriptTimer;
+
+uint32_t ElapsedMs()
+{
+    return (uint32_t)(((uint64_t)(chVTGetSystemTimeX() - startTime) * 1000) / CH_CFG_ST_FREQUENCY);
+}
+
+/* Runs the card up to now, broadcasts the falling edge of the IRQ line.*/
+void UpdateRFIDI()
+{
+    uint32_t now = ElapsedMs();
+    if (now > rfid.Now())
+    {
+        rfid.Advance(now - rfid.Now());
+    }
+
+    bool asserted = rfid.IRQAsserted();
+    if ((asserted == true) && (rfidIrq == false))
+    {
+        chEvtBroadcastI(&RFID1_irq);
+    }
+    rfidIrq = asserted;
+}
+
+void ScriptTick(void* p)
+{
+    (void)p;
+
+    chSysLockFromISR();
+    UpdateRFIDI();
+
+    uint32_t now = ElapsedMs();
+    for (size_t i = 0; i < sizeof(buttonNames) / sizeof(buttonNames[0]); i++)
+    {
+        bool pressed = false;
+        for (size_t w = 0; w < buttons.size(); w++)
+        {
+            if ((buttons[w].pad == buttonNames[i].pad) && (now >= buttons[w].start) && (now < buttons[w].end))
+            {
+                pressed = true;
+            }
+        }
+        if (pressed == true)
+        {
+            palClearPad(IOPORT1, buttonNames[i].pad);
+        }
+        else
+        {
+            palSetPad(IOPORT1, buttonNames[i].pad);
+        }
+    }
+
+    if ((stopTime != 0) && (now >= stopTime))
+    {
+        stopTime = 0;
+        chBSemSignalI(&main_shutdown_sema);
+    }
+
+    chVTSetI(&scriptTimer, MS2ST(1), ScriptTick, NULL);
+    chSysUnlockFromISR();
+}
+
+bool ParseUID(const char* hex, std::vector<uint8_t>& uid)
+{
+    size_t length = strlen(hex);
+    if ((length == 0) || ((length % 2) != 0) || (length > 20))
+    {
+        return false;
+    }
+    for (size_t i = 0; i < length; i += 2)
+    {
+        char byte[3] = {hex[i], hex[i + 1], '\0'};
+        char* end;
+        uid.push_back((uint8_t)strtoul(byte, &end, 16));
+        if (*end != '\0')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ParseLine(const char* line)
+{
+    char keyword[16];
+    char name[24];
+    unsigned start;
+    unsigned end;
+
+    if (sscanf(line, "%15s", keyword) != 1 || keyword[0] == '#')
+    {
+        return true;
+    }
+    if (strcmp(keyword, "card") == 0 && sscanf(line, "%*s %u %u %23s", &start, &end, name) == 3)
+    {
+        std::vector<uint8_t> uid;
+        if (ParseUID(name, uid) == false)
+        {
+            return false;
+        }
+        rfid.PlaceCard(start, end, uid);
+        return true;
+    }
+    if (strcmp(keyword, "button") == 0 && sscanf(line, "%*s %23s %u %u", name, &start, &end) == 3)
+    {
+        for (size_t i = 0; i < sizeof(buttonNames) / sizeof(buttonNames[0]); i++)
+        {
+            if (strcmp(name, buttonNames[i].name) == 0)
+            {
+                buttons.push_back(ButtonWindow{buttonNames[i].pad, start, end});
+                return true;
+            }
+        }
+        return false;
+    }
+    if (strcmp(keyword, "stop") == 0 && sscanf(line, "%*s %u", &start) == 1)
+    {
+        stopTime = (start > 0) ? start : 1;
+        return true;
+    }
+    return false;
+}
+
+}
+
+bool simScriptLoad(const char* path)
+{
+    FILE* file = fopen(path, "r");
+    if (file == NULL)
+    {
+        fprintf(stderr, "sim: can not open script %s\n", path);
+        return false;
+    }
+
+    bool ok = true;
+    char line[128];
+    unsigned number = 0;
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        number++;
+        if (ParseLine(line) == false)
+        {
+            fprintf(stderr, "sim: %s:%u: bad line: %s", path, number, line);
+            ok = false;
+        }
+    }
+    fclose(file);
+    return ok;
+}
+
+void simScriptStart(void)
+{
+    chSysLock();
+    startTime = chVTGetSystemTimeX();
+    chVTObjectInit(&scriptTimer);
+    chVTSetI(&scriptTimer, MS2ST(1), ScriptTick, NULL);
+    chSysUnlock();
+}
+
+void simScriptStop(void)
+{
+    chVTReset(&scriptTimer);
+}
+
+extern "C" {
+
+void MFRC522WriteRegister(MFRC522Driver* mfrc522p, uint8_t addr, uint8_t val)
+{
+    (void)mfrc522p;
+
+    chSysLock();
+    UpdateRFIDI();
+    rfid.WriteRegister(addr, val);
+    UpdateRFIDI();
+    chSchRescheduleS();
+    chSysUnlock();
+}
+
+uint8_t MFRC522ReadRegister(MFRC522Driver* mfrc522p, uint8_t addr)
+{
+    (void)mfrc522p;
+
+    chSysLock();
+    UpdateRFIDI();
+    uint8_t val = rfid.ReadRegister(addr);
+    UpdateRFIDI();
+    chSchRescheduleS();
+    chSysUnlock();
+    return val;
+}
+
+}
@@ -0,0 +1,42 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef SIMSCRIPT_H_
+#define SIMSCRIPT_H_
+
+#include "hal.h"
+
+/*
+ * @brief   Scripted user in front of the simulated box.
+ * @details One event per line, times in ms since start, '#' starts a
+ *          comment:
+ *              card <start> <end> <uid in hex>
+ *              button <play|next|prev|volup|voldown> <start> <end>
+ *              stop <time>
+ *          A card lies on the reader and a button is held from start until
+ *          end. The card is answered by the register level MFRC522 stand-in
+ *          of the unit tests, stop shuts the firmware down.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+bool simScriptLoad(const char* path);
+void simScriptStart(void);
+void simScriptStop(void);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIMSCRIPT_H_ */
@@ -0,0 +1,84 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ws281x.h"
+
+#include <string.h>
+
+#if HAL_USE_WS281X || defined(__DOXYGEN__)
+
+void ws281xObjectInit(ws281xDriver* ws281xp)
+{
+    ws281xp->config = NULL;
+    ws281xp->frames = NULL;
+    memset(ws281xp->colors, 0, sizeof(ws281xp->colors));
+    ws281xp->anyShown = false;
+}
+
+void ws281xStart(ws281xDriver* ws281xp, const ws281xConfig* config)
+{
+    osalDbgCheck((config != NULL) && (config->ledCount <= WS281X_SIM_MAX_LEDS));
+
+    ws281xp->config = config;
+    if (config->framesPath != NULL)
+    {
+        ws281xp->frames = fopen(config->framesPath, "w");
+    }
+}
+
+void ws281xStop(ws281xDriver* ws281xp)
+{
+    if (ws281xp->frames != NULL)
+    {
+        fclose(ws281xp->frames);
+        ws281xp->frames = NULL;
+    }
+    ws281xp->config = NULL;
+}
+
+void ws281xSetColor(ws281xDriver* ws281xp, int index, uint8_t r, uint8_t g, uint8_t b)
+{
+    if ((index < 0) || (index >= WS281X_SIM_MAX_LEDS))
+    {
+        return;
+    }
+    ws281xp->colors[index][0] = r;
+    ws281xp->colors[index][1] = g;
+    ws281xp->colors[index][2] = b;
+}
+
+void ws281xUpdate(ws281xDriver* ws281xp)
+{
+    size_t bytes = ws281xp->config->ledCount * sizeof(ws281xp->colors[0]);
+
+    if ((ws281xp->frames == NULL)
+            || ((ws281xp->anyShown == true) && (memcmp(ws281xp->shown, ws281xp->colors, bytes) == 0)))
+    {
+        return;
+    }
+    memcpy(ws281xp->shown, ws281xp->colors, bytes);
+    ws281xp->anyShown = true;
+
+    uint32_t ms = (uint32_t)(((uint64_t)chVTGetSystemTime() * 1000) / CH_CFG_ST_FREQUENCY);
+    fprintf(ws281xp->frames, "%u", (unsigned)ms);
+    uint16_t i;
+    for (i = 0; i < ws281xp->config->ledCount; i++)
+    {
+        fprintf(ws281xp->frames, " %02x%02x%02x",
+                ws281xp->colors[i][0], ws281xp->colors[i][1], ws281xp->colors[i][2]);
+    }
+    fprintf(ws281xp->frames, "\n");
+}
+
+#endif /* HAL_USE_WS281X */
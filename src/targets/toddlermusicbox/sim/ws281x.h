@@ -0,0 +1,61 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef WS281X_H_
+#define WS281X_H_
+
+#include <stdio.h>
+
+#include "hal.h"
+
+/*
+ * @brief   Stand-in for the WS281x driver of the board.
+ * @details Every frame that differs from the previous one is appended to
+ *          the frame file as "<ms> rrggbb rrggbb ...".
+ */
+
+#if HAL_USE_WS281X || defined(__DOXYGEN__)
+
+#define WS281X_SIM_MAX_LEDS         16
+
+typedef struct {
+    /* Number of LEDs in the chain.*/
+    uint16_t ledCount;
+    /* Frame file, nothing is written if NULL.*/
+    const char* framesPath;
+} ws281xConfig;
+
+typedef struct {
+    const ws281xConfig* config;
+    FILE* frames;
+    uint8_t colors[WS281X_SIM_MAX_LEDS][3];
+    uint8_t shown[WS281X_SIM_MAX_LEDS][3];
+    bool anyShown;
+} ws281xDriver;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+void ws281xObjectInit(ws281xDriver* ws281xp);
+void ws281xStart(ws281xDriver* ws281xp, const ws281xConfig* config);
+void ws281xStop(ws281xDriver* ws281xp);
+void ws281xSetColor(ws281xDriver* ws281xp, int index, uint8_t r, uint8_t g, uint8_t b);
+void ws281xUpdate(ws281xDriver* ws281xp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_USE_WS281X */
+
+#endif /* WS281X_H_ */
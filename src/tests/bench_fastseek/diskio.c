@@ -0,0 +1,98 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * FatFs disk backed by an image file, counts the sectors read.
+ */
+
+#include <stdio.h>
+
+#include "diskio.h"
+#include "imagedisk.h"
+
+static FILE* image = NULL;
+static DWORD imageSectors = 0;
+
+DWORD imagedisk_sectors_read = 0;
+
+int imagedisk_open(const char* path, DWORD sectors) {
+    image = fopen(path, "w+b");
+    if (image == NULL) {
+        return 0;
+    }
+    imageSectors = sectors;
+    imagedisk_sectors_read = 0;
+    /* Sparse file of the full size, mkfs only writes the metadata.*/
+    return (fseek(image, (long)sectors * 512 - 1, SEEK_SET) == 0)
+            && (fputc(0, image) != EOF);
+}
+
+void imagedisk_close(void) {
+    if (image != NULL) {
+        fclose(image);
+        image = NULL;
+    }
+}
+
+DSTATUS disk_initialize(BYTE pdrv) {
+    return disk_status(pdrv);
+}
+
+DSTATUS disk_status(BYTE pdrv) {
+    return ((pdrv == 0) && (image != NULL)) ? 0 : STA_NOINIT;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE* buff, DWORD sector, UINT count) {
+    if (disk_status(pdrv) != 0) {
+        return RES_NOTRDY;
+    }
+    imagedisk_sectors_read += count;
+    if ((fseek(image, (long)sector * 512, SEEK_SET) != 0)
+            || (fread(buff, 512, count, image) != count)) {
+        return RES_ERROR;
+    }
+    return RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count) {
+    if (disk_status(pdrv) != 0) {
+        return RES_NOTRDY;
+    }
+    if ((fseek(image, (long)sector * 512, SEEK_SET) != 0)
+            || (fwrite(buff, 512, count, image) != count)) {
+        return RES_ERROR;
+    }
+    return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void* buff) {
+    if (disk_status(pdrv) != 0) {
+        return RES_NOTRDY;
+    }
+    switch (cmd) {
+    case CTRL_SYNC:
+        fflush(image);
+        return RES_OK;
+    case GET_SECTOR_COUNT:
+        *(DWORD*)buff = imageSectors;
+        return RES_OK;
+    case GET_SECTOR_SIZE:
+        *(WORD*)buff = 512;
+        return RES_OK;
+    case GET_BLOCK_SIZE:
+        *(DWORD*)buff = 1;
+        return RES_OK;
+    }
+    return RES_PARERR;
+}
@@ -0,0 +1,33 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef _IMAGEDISK_H_
+#define _IMAGEDISK_H_
+
+#include "integer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern DWORD imagedisk_sectors_read;
+
+int imagedisk_open(const char* path, DWORD sectors);
+void imagedisk_close(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _IMAGEDISK_H_ */
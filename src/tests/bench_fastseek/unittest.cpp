@@ -0,0 +1,160 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host benchmark of f_lseek into a 200 MB file on a FatFs image, with and
+ * without the fast seek cluster link map. Reports the sectors read by the
+ * seek, which dominate on the SD card, and the host time. Building the map
+ * walks the whole cluster chain once, it is reported on its own.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "ch.h"
+#include "qhal.h"
+#include "ff.h"
+}
+
+#include "common/clustermappool.h"
+#include "imagedisk.h"
+
+class FastSeekBenchmark: public ::testing::TestWithParam<int> {
+ protected:
+    typedef std::chrono::steady_clock Clock;
+
+    static const DWORD ImageSectors = 256 * 2048;
+    static const UINT ClusterSize = 32768;
+    static const DWORD FileSize = 200 * 1024 * 1024;
+    /* A cluster of another file is written after each chunk.*/
+    static const DWORD FragmentSize = 4 * 1024 * 1024;
+    static const char* ImagePath;
+
+    static void SetUpTestCase() {
+        ASSERT_TRUE(imagedisk_open(ImagePath, ImageSectors));
+        ASSERT_EQ(FR_OK, f_mkfs("", 1, ClusterSize));
+        ASSERT_EQ(FR_OK, f_mount(&fs, "", 1));
+
+        FIL audio;
+        FIL other;
+        ASSERT_EQ(FR_OK, f_open(&audio, "audio.mp3", FA_CREATE_ALWAYS | FA_WRITE));
+        ASSERT_EQ(FR_OK, f_open(&other, "other.dat", FA_CREATE_ALWAYS | FA_WRITE));
+        std::vector<BYTE> chunk(ClusterSize, 0x55);
+        UINT written;
+        for (DWORD size = 0; size < FileSize; size += ClusterSize) {
+            ASSERT_EQ(FR_OK, f_write(&audio, &chunk.front(), ClusterSize, &written));
+            if (((size + ClusterSize) % FragmentSize) == 0) {
+                ASSERT_EQ(FR_OK, f_write(&other, &chunk.front(), ClusterSize, &written));
+            }
+        }
+        ASSERT_EQ(FR_OK, f_close(&other));
+        ASSERT_EQ(FR_OK, f_close(&audio));
+    }
+
+    static void TearDownTestCase() {
+        f_mount(NULL, "", 0);
+        imagedisk_close();
+        std::remove(ImagePath);
+    }
+
+    struct Cost {
+        DWORD sectors;
+        double micros;
+    };
+
+    /* Measures the sectors read and the host time since the last Start().*/
+    class Meter {
+     public:
+        void Start() {
+            readBefore = imagedisk_sectors_read;
+            start = Clock::now();
+        }
+
+        void Stop(Cost& cost) const {
+            cost.micros = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+            cost.sectors = imagedisk_sectors_read - readBefore;
+        }
+
+     private:
+        DWORD readBefore = 0;
+        Clock::time_point start;
+    };
+
+    /*
+     * Opens the file so the seek starts from the first cluster, like resume.
+     * With a map it is built right before the seek as the player does.
+     */
+    void Seek(FIL* file, DWORD* map, Cost& build, Cost& seek) {
+        Meter meter;
+        ASSERT_EQ(FR_OK, f_open(file, "audio.mp3", FA_READ));
+        build = Cost();
+        if (map != NULL) {
+            file->cltbl = map;
+            meter.Start();
+            ASSERT_EQ(FR_OK, f_lseek(file, CREATE_LINKMAP));
+            meter.Stop(build);
+        }
+
+        DWORD target = (DWORD)((uint64_t)FileSize * GetParam() / 100) + 417;
+        meter.Start();
+        ASSERT_EQ(FR_OK, f_lseek(file, target));
+        meter.Stop(seek);
+
+        EXPECT_EQ(target, f_tell(file));
+        BYTE data;
+        UINT bytesRead;
+        ASSERT_EQ(FR_OK, f_read(file, &data, 1, &bytesRead));
+        EXPECT_EQ(0x55, data);
+        ASSERT_EQ(FR_OK, f_close(file));
+    }
+
+    static FATFS fs;
+};
+
+const char* FastSeekBenchmark::ImagePath = "./fastseek.img";
+FATFS FastSeekBenchmark::fs;
+
+TEST_P(FastSeekBenchmark, seek) {
+    FIL file;
+    Cost unused;
+    Cost chain;
+    Seek(&file, NULL, unused, chain);
+
+    /* Size of the map as the player builds it.*/
+    uint32_t words[256];
+    tmb_musicplayer::ClusterMapPool pool(words, 256);
+    uint32_t size;
+    DWORD* map = (DWORD*)pool.AllocateLargest(size);
+    map[0] = size;
+    Cost build;
+    Cost fast;
+    Seek(&file, map, build, fast);
+    pool.Shrink((uint32_t*)map, map[0]);
+
+    printf("%3d%%  chain %5u sectors %9.1f us  map build %5u sectors %9.1f us"
+            "  fast seek %2u sectors %7.1f us  map %3u words\n",
+            GetParam(), (unsigned)chain.sectors, chain.micros,
+            (unsigned)build.sectors, build.micros,
+            (unsigned)fast.sectors, fast.micros, (unsigned)map[0]);
+
+    /* Only the data sector at the target is read.*/
+    EXPECT_LE(fast.sectors, 1u);
+    EXPECT_LT(fast.sectors, chain.sectors);
+}
+
+INSTANTIATE_TEST_CASE_P(Positions, FastSeekBenchmark, ::testing::Values(10, 50, 90));
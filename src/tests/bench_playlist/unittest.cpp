@@ -0,0 +1,128 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/*
+ * Host benchmark of the paged playlist, reports the RAM used by the
+ * playlist object and the query latency for different playlist sizes.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "ch.h"
+#include "qhal.h"
+}
+
+#include "common/playlist.h"
+#include "testfile.h"
+
+class PlaylistBenchmark: public ::testing::TestWithParam<int> {
+ protected:
+    typedef std::chrono::steady_clock Clock;
+
+    virtual void SetUp() {
+        std::ofstream m3u(PlaylistPath, std::ios::binary | std::ios::trunc);
+        m3u << "#EXTM3U\r\n";
+        for (int i = 0; i < GetParam(); i++) {
+            m3u << "#EXTINF:1800,chapter" << i << "\r\n";
+            m3u << "/music/04A2B3C4D5E6F7/chapter" << i << ".mp3\r\n";
+        }
+        std::remove(IndexPath);
+    }
+
+    virtual void TearDown() {
+        std::remove(PlaylistPath);
+        std::remove(IndexPath);
+    }
+
+    static double Micros(Clock::time_point start, Clock::time_point end, int count) {
+        return std::chrono::duration<double, std::micro>(end - start).count() / count;
+    }
+
+    void Run(const char* mode, tmb_musicplayer::Playlist& pl, double loadTime) {
+        std::array<char, 256> title;
+        const int count = pl.GetTitleCount();
+        ASSERT_EQ(count, GetParam());
+
+        auto start = Clock::now();
+        for (int i = 0; i < count; i++) {
+            ASSERT_GT(pl.QueryNext(&title.front(), title.size()), (uint32_t)0);
+        }
+        double next = Micros(start, Clock::now(), count);
+
+        start = Clock::now();
+        for (int i = 1; i < count; i++) {
+            ASSERT_GT(pl.QueryPrev(&title.front(), title.size()), (uint32_t)0);
+        }
+        double prev = Micros(start, Clock::now(), count - 1);
+
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> dist(0, count - 1);
+        const int randomQueries = 1000;
+        start = Clock::now();
+        for (int i = 0; i < randomQueries; i++) {
+            ASSERT_GT(pl.Query(dist(rng), &title.front(), title.size()), (uint32_t)0);
+        }
+        double random = Micros(start, Clock::now(), randomQueries);
+
+        printf("%7d titles %-12s RAM %5u bytes  load %10.1f us  next %7.2f us  prev %7.2f us  random %8.2f us\n",
+                count, mode, (unsigned)sizeof(tmb_musicplayer::Playlist), loadTime, next, prev, random);
+    }
+
+    static const char* PlaylistPath;
+    static const char* IndexPath;
+};
+
+const char* PlaylistBenchmark::PlaylistPath = "./benchmark.m3u";
+const char* PlaylistBenchmark::IndexPath = "./benchmark.idx";
+
+TEST_P(PlaylistBenchmark, checkpoints) {
+    TestFile plFile;
+    ASSERT_TRUE(plFile.Open(PlaylistPath));
+    tmb_musicplayer::Playlist pl;
+
+    auto start = Clock::now();
+    EXPECT_TRUE(pl.LoadFromFile(&plFile));
+    Run("checkpoints", pl, Micros(start, Clock::now(), 1));
+}
+
+TEST_P(PlaylistBenchmark, index) {
+    {
+        TestFile plFile;
+        ASSERT_TRUE(plFile.Open(PlaylistPath));
+        TestFile indexFile;
+        tmb_musicplayer::Playlist pl;
+
+        auto start = Clock::now();
+        EXPECT_TRUE(pl.LoadFromFile(&plFile, &indexFile, IndexPath));
+        Run("index cold", pl, Micros(start, Clock::now(), 1));
+    }
+
+    TestFile plFile;
+    ASSERT_TRUE(plFile.Open(PlaylistPath));
+    TestFile indexFile;
+    tmb_musicplayer::Playlist pl;
+
+    auto start = Clock::now();
+    EXPECT_TRUE(pl.LoadFromFile(&plFile, &indexFile, IndexPath));
+    Run("index warm", pl, Micros(start, Clock::now(), 1));
+}
+
+INSTANTIATE_TEST_CASE_P(Sizes, PlaylistBenchmark, ::testing::Values(100, 10000, 100000));
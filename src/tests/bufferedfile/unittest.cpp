@@ -0,0 +1,227 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "ch.h"
+#include "qhal.h"
+}
+
+#include "common/bufferedfile.h"
+#include "common/playlist.h"
+#include "testfile.h"
+
+/*
+ * TestFile which counts the accesses to the underlying file, GetString
+ * reads byte by byte like f_gets does.
+ */
+class CountingFile : public TestFile {
+ public:
+    virtual int32_t Read(void* buffer, uint32_t size) {
+        reads++;
+        return TestFile::Read(buffer, size);
+    }
+
+    virtual bool Seek(int32_t pos) {
+        seeks++;
+        return TestFile::Seek(pos);
+    }
+
+    virtual uint32_t GetString(char* buffer, uint32_t bufferSize) {
+        uint32_t chars = 0;
+        while ((chars + 1) < bufferSize) {
+            char c;
+            if (Read(&c, 1) != 1) {
+                break;
+            }
+            buffer[chars++] = c;
+            if (c == '\n') {
+                break;
+            }
+        }
+        buffer[chars] = 0;
+        return chars;
+    }
+
+    uint32_t reads = 0;
+    uint32_t seeks = 0;
+};
+
+class BufferedFileTest: public ::testing::Test {
+ protected:
+    virtual void SetUp() {
+        // lines of varying length, so lines cross the block boundaries
+        std::ofstream m3u(PlaylistPath, std::ios::binary | std::ios::trunc);
+        m3u << "#EXTM3U\r\n";
+        for (int i = 0; i < TitleCount; i++) {
+            m3u << "#EXTINF:" << i << ",title" << std::string(i % 37, 'x') << "\r\n";
+            m3u << "/music/chapter" << i << ".mp3\r\n";
+        }
+        m3u.close();
+
+        std::ifstream in(PlaylistPath, std::ios::binary);
+        std::stringstream content;
+        content << in.rdbuf();
+        m_content = content.str();
+    }
+
+    virtual void TearDown() {
+        std::remove(PlaylistPath);
+        std::remove(IndexPath);
+    }
+
+    static const int TitleCount = 10000;
+    static const char* PlaylistPath;
+    static const char* IndexPath;
+    std::string m_content;
+};
+
+const int BufferedFileTest::TitleCount;
+const char* BufferedFileTest::PlaylistPath = "./buffered.m3u";
+const char* BufferedFileTest::IndexPath = "./buffered.idx";
+
+TEST_F(BufferedFileTest, getString) {
+    CountingFile file;
+    tmb_musicplayer::BufferedFile buffered(&file);
+    ASSERT_TRUE(buffered.Open(PlaylistPath));
+
+    std::istringstream expected(m_content);
+    std::string line;
+    std::array<char, 256> buffer;
+    while (std::getline(expected, line)) {
+        line += "\n";
+        EXPECT_EQ(buffered.Tell(), (int32_t)expected.tellg() - (int32_t)line.size());
+        uint32_t chars = buffered.GetString(&buffer.front(), buffer.size());
+        ASSERT_EQ(line, std::string(&buffer.front(), chars));
+    }
+    EXPECT_EQ(buffered.GetString(&buffer.front(), buffer.size()), (uint32_t)0);
+    EXPECT_TRUE(buffered.IsEOF());
+
+    // one read per block
+    EXPECT_EQ(file.reads, (m_content.size() + tmb_musicplayer::BufferedFile::BlockSize - 1)
+            / tmb_musicplayer::BufferedFile::BlockSize);
+}
+
+TEST_F(BufferedFileTest, getStringShortBuffer) {
+    CountingFile file;
+    tmb_musicplayer::BufferedFile buffered(&file);
+    ASSERT_TRUE(buffered.Open(PlaylistPath));
+
+    char buffer[5];
+    EXPECT_EQ(buffered.GetString(buffer, sizeof(buffer)), (uint32_t)4);
+    EXPECT_STREQ("#EXT", buffer);
+    EXPECT_EQ(buffered.GetString(buffer, sizeof(buffer)), (uint32_t)4);
+    EXPECT_STREQ("M3U\r", buffer);
+    EXPECT_EQ(buffered.GetString(buffer, sizeof(buffer)), (uint32_t)1);
+    EXPECT_STREQ("\n", buffer);
+}
+
+TEST_F(BufferedFileTest, seekAndRead) {
+    CountingFile file;
+    tmb_musicplayer::BufferedFile buffered(&file);
+    ASSERT_TRUE(buffered.Open(PlaylistPath));
+    EXPECT_EQ(buffered.Size(), (int32_t)m_content.size());
+
+    char buffer[1500];
+    const int32_t positions[] = {0, 511, 512, 1000, 100, 5000, (int32_t)m_content.size() - 10};
+    for (int32_t pos : positions) {
+        ASSERT_TRUE(buffered.Seek(pos));
+        EXPECT_EQ(buffered.Tell(), pos);
+        int32_t expected = std::min<int32_t>(sizeof(buffer), m_content.size() - pos);
+        ASSERT_EQ(buffered.Read(buffer, sizeof(buffer)), expected);
+        EXPECT_EQ(m_content.substr(pos, expected), std::string(buffer, expected));
+        EXPECT_EQ(buffered.Tell(), pos + expected);
+    }
+    EXPECT_FALSE(buffered.Seek(m_content.size() + 1));
+}
+
+TEST_F(BufferedFileTest, seekInsideBlock) {
+    CountingFile file;
+    tmb_musicplayer::BufferedFile buffered(&file);
+    ASSERT_TRUE(buffered.Open(PlaylistPath));
+
+    char buffer[16];
+    ASSERT_TRUE(buffered.Seek(600));
+    buffered.Read(buffer, sizeof(buffer));
+    EXPECT_EQ(file.reads, (uint32_t)1);
+
+    // seeking inside the buffered block does not touch the file
+    ASSERT_TRUE(buffered.Seek(520));
+    buffered.Read(buffer, sizeof(buffer));
+    ASSERT_TRUE(buffered.Seek(1000));
+    buffered.Read(buffer, sizeof(buffer));
+    EXPECT_EQ(file.reads, (uint32_t)1);
+
+    ASSERT_TRUE(buffered.Seek(100));
+    buffered.Read(buffer, sizeof(buffer));
+    EXPECT_EQ(file.reads, (uint32_t)2);
+    EXPECT_EQ(m_content.substr(100, sizeof(buffer)), std::string(buffer, sizeof(buffer)));
+}
+
+TEST_F(BufferedFileTest, playlist) {
+    CountingFile file;
+    tmb_musicplayer::BufferedFile buffered(&file);
+    ASSERT_TRUE(buffered.Open(PlaylistPath));
+
+    tmb_musicplayer::Playlist pl;
+    ASSERT_TRUE(pl.LoadFromFile(&buffered));
+    EXPECT_EQ(pl.GetTitleCount(), TitleCount);
+
+    std::array<char, 256> title;
+    for (int i = 0; i < TitleCount; i++) {
+        uint32_t chars = pl.QueryNext(&title.front(), title.size());
+        ASSERT_EQ("/music/chapter" + std::to_string(i) + ".mp3", std::string(&title.front(), chars));
+    }
+}
+
+TEST_F(BufferedFileTest, benchmark) {
+    typedef std::chrono::steady_clock Clock;
+    struct Result {
+        double loadTime;
+        uint32_t reads;
+    };
+
+    auto measure = [](tmb_musicplayer::File& plFile, CountingFile& file, const char* name) {
+        tmb_musicplayer::Playlist pl;
+        EXPECT_TRUE(plFile.Open(PlaylistPath));
+        auto start = Clock::now();
+        EXPECT_TRUE(pl.LoadFromFile(&plFile));
+        Result result;
+        result.loadTime = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        result.reads = file.reads;
+        EXPECT_EQ(pl.GetTitleCount(), TitleCount);
+        printf("%-24s load %10.1f us  file reads %8u\n", name, result.loadTime, result.reads);
+        return result;
+    };
+
+    TestFile plain;
+    CountingFile unused;
+    measure(plain, unused, "TestFile");
+
+    CountingFile bytewise;
+    Result direct = measure(bytewise, bytewise, "f_gets like");
+
+    CountingFile decorated;
+    tmb_musicplayer::BufferedFile buffered(&decorated);
+    Result block = measure(buffered, decorated, "BufferedFile");
+
+    EXPECT_LT(block.reads * 100, direct.reads);
+}
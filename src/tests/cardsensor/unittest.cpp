@@ -0,0 +1,169 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "ch.h"
+#include "qhal.h"
+}
+
+#include "common/cardsensor.h"
+#include "fakemfrc522.h"
+
+using tmb_musicplayer::CardSensor;
+
+TEST(CardSensorTest, noCardInField) {
+    FakeMFRC522 fake;
+    CardSensor sensor(&fake);
+    sensor.Init();
+    EXPECT_EQ(fake.regs[CardSensor::DivIEnReg], uint8_t(CardSensor::IRQPushPull));
+
+    EXPECT_FALSE(sensor.RequestCard());
+    // the thread did not wait for the timer of the MFRC522
+    EXPECT_EQ(fake.Now(), uint32_t(CardSensor::RequestTimeout));
+    EXPECT_EQ(fake.waits, 1u);
+    // nothing is left asserted on the IRQ line
+    EXPECT_FALSE(fake.IRQAsserted());
+}
+
+TEST(CardSensorTest, cardAnswers) {
+    FakeMFRC522 fake;
+    fake.PlaceCard(0, 1000);
+    CardSensor sensor(&fake);
+    sensor.Init();
+
+    EXPECT_TRUE(sensor.RequestCard());
+    // woken up by the answer and the end of the HLTA, not by the timeout
+    EXPECT_EQ(fake.Now(), uint32_t(2 * FakeMFRC522::AnswerTime));
+    EXPECT_FALSE(fake.IRQAsserted());
+    // the driver finds the card with its first REQA
+    EXPECT_EQ(fake.State(), FakeMFRC522::Idle);
+    EXPECT_EQ(fake.regs[CardSensor::CommandReg], CardSensor::PCD_Idle);
+}
+
+TEST(CardSensorTest, detectionLatency) {
+    const uint32_t pollInterval = 20;
+    const uint32_t presenceInterval = 250;
+    const uint32_t placedAt = 1234;
+    const uint32_t removedAt = 4321;
+
+    FakeMFRC522 fake;
+    fake.PlaceCard(placedAt, removedAt);
+    CardSensor sensor(&fake);
+    sensor.Init();
+    uint32_t initAccesses = fake.registerAccesses;
+
+    while (!sensor.RequestCard()) {
+        ASSERT_LT(fake.Now(), placedAt + pollInterval + CardSensor::RequestTimeout);
+        fake.Advance(pollInterval);
+    }
+    uint32_t latency = fake.Now() - placedAt;
+    EXPECT_LE(latency, pollInterval + CardSensor::RequestTimeout);
+    // a request costs a handful of register writes and one read, there
+    // is no busy polling of ComIrqReg while waiting
+    EXPECT_LE(fake.registerAccesses - initAccesses, fake.requests * 13);
+    EXPECT_EQ(fake.waits, fake.requests);
+
+    const uint8_t uid[] = {0x04, 0xA1, 0xB2, 0xC3};
+    EXPECT_TRUE(fake.SelectCard());
+    sensor.HaltCard();
+    while (sensor.CheckPresence(uid, sizeof(uid))) {
+        ASSERT_LT(fake.Now(), removedAt + presenceInterval + CardSensor::RequestTimeout);
+        fake.Advance(presenceInterval);
+    }
+    EXPECT_GE(fake.Now(), removedAt);
+}
+
+TEST(CardSensorTest, haltedCardIgnoresRequest) {
+    FakeMFRC522 fake;
+    fake.PlaceCard(0, 1000);
+    CardSensor sensor(&fake);
+    sensor.Init();
+
+    EXPECT_TRUE(sensor.RequestCard());
+    EXPECT_TRUE(fake.SelectCard());
+    sensor.HaltCard();
+    EXPECT_EQ(fake.State(), FakeMFRC522::Halt);
+    EXPECT_FALSE(fake.IRQAsserted());
+
+    EXPECT_FALSE(sensor.RequestCard());
+}
+
+TEST(CardSensorTest, presenceCheck) {
+    const uint8_t uid[] = {0x04, 0xA1, 0xB2, 0xC3};
+
+    FakeMFRC522 fake;
+    fake.PlaceCard(0, 1000);
+    CardSensor sensor(&fake);
+    sensor.Init();
+
+    EXPECT_TRUE(sensor.RequestCard());
+    EXPECT_TRUE(fake.SelectCard());
+    sensor.HaltCard();
+
+    for (int i = 0; i < 3; ++i) {
+        fake.Advance(250);
+        EXPECT_TRUE(sensor.CheckPresence(uid, sizeof(uid)));
+        // the card is not left waiting for a select
+        EXPECT_NE(fake.State(), FakeMFRC522::Ready);
+        EXPECT_NE(fake.State(), FakeMFRC522::Active);
+    }
+
+    fake.Advance(250);
+    EXPECT_FALSE(sensor.CheckPresence(uid, sizeof(uid)));
+}
+
+TEST(CardSensorTest, presenceCheckSevenByteUID) {
+    const uint8_t uid[] = {0x04, 0x3D, 0xF3, 0xFA, 0x09, 0x40, 0x81};
+    const uint8_t other[] = {0x04, 0x3D, 0xF3, 0x11, 0x22, 0x33, 0x44};
+
+    FakeMFRC522 fake;
+    fake.PlaceCard(0, 1000, std::vector<uint8_t>(uid, uid + sizeof(uid)));
+    CardSensor sensor(&fake);
+    sensor.Init();
+
+    EXPECT_TRUE(sensor.RequestCard());
+    EXPECT_TRUE(fake.SelectCard());
+    sensor.HaltCard();
+
+    EXPECT_TRUE(sensor.CheckPresence(uid, sizeof(uid)));
+    // only the first cascade level is compared
+    EXPECT_TRUE(sensor.CheckPresence(other, sizeof(other)));
+    EXPECT_FALSE(sensor.CheckPresence(uid, 4));
+}
+
+TEST(CardSensorTest, swappedCard) {
+    const uint8_t first[] = {0x04, 0xA1, 0xB2, 0xC3};
+    const uint8_t second[] = {0x04, 0x11, 0x22, 0x33};
+
+    FakeMFRC522 fake;
+    fake.PlaceCard(0, 500, std::vector<uint8_t>(first, first + sizeof(first)));
+    fake.PlaceCard(500, 1000, std::vector<uint8_t>(second, second + sizeof(second)));
+    CardSensor sensor(&fake);
+    sensor.Init();
+
+    EXPECT_TRUE(sensor.RequestCard());
+    EXPECT_TRUE(fake.SelectCard());
+    sensor.HaltCard();
+    EXPECT_TRUE(sensor.CheckPresence(first, sizeof(first)));
+
+    // swapped faster than the presence check runs
+    fake.Advance(500);
+    EXPECT_FALSE(sensor.CheckPresence(first, sizeof(first)));
+    EXPECT_TRUE(sensor.RequestCard());
+    EXPECT_TRUE(fake.SelectCard());
+    sensor.HaltCard();
+    EXPECT_TRUE(sensor.CheckPresence(second, sizeof(second)));
+}
@@ -0,0 +1,177 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "ch.h"
+#include "qhal.h"
+}
+
+#include "common/cardsession.h"
+#include "common/cardsensor.h"
+#include "fakemfrc522.h"
+
+using tmb_musicplayer::CardSession;
+using tmb_musicplayer::CardSensor;
+
+TEST(CardSessionTest, noGracePeriod) {
+    CardSession session;
+    EXPECT_EQ(session.CardDetected("04A1B2C3", 0), CardSession::Start);
+    EXPECT_TRUE(session.IsActive());
+    EXPECT_EQ(session.CardLost(100), CardSession::Stop);
+    EXPECT_FALSE(session.IsActive());
+    EXPECT_EQ(session.CardDetected("04A1B2C3", 200), CardSession::Start);
+}
+
+TEST(CardSessionTest, sameCardReturns) {
+    CardSession session;
+    session.SetGracePeriod(2000);
+    EXPECT_EQ(session.CardDetected("04A1B2C3", 0), CardSession::Start);
+    EXPECT_EQ(session.CardLost(100), CardSession::None);
+    EXPECT_TRUE(session.IsLost());
+    EXPECT_EQ(session.Update(1000), CardSession::None);
+    EXPECT_EQ(session.CardDetected("04A1B2C3", 1500), CardSession::Continue);
+    EXPECT_FALSE(session.IsLost());
+    // the timer of the first dropout is gone
+    EXPECT_EQ(session.Update(5000), CardSession::None);
+    EXPECT_TRUE(session.IsActive());
+}
+
+TEST(CardSessionTest, graceExpires) {
+    CardSession session;
+    session.SetGracePeriod(2000);
+    session.CardDetected("04A1B2C3", 0);
+    session.CardLost(100);
+    EXPECT_EQ(session.TimeUntilStop(600, 500), 500u);
+    EXPECT_EQ(session.TimeUntilStop(1800, 500), 300u);
+    EXPECT_EQ(session.Update(2099), CardSession::None);
+    EXPECT_EQ(session.Update(2100), CardSession::Stop);
+    // stop is only reported once
+    EXPECT_EQ(session.Update(2200), CardSession::None);
+    EXPECT_FALSE(session.IsActive());
+    EXPECT_EQ(session.CardDetected("04A1B2C3", 3000), CardSession::Start);
+}
+
+TEST(CardSessionTest, otherCardDuringGrace) {
+    CardSession session;
+    session.SetGracePeriod(2000);
+    session.CardDetected("04A1B2C3", 0);
+    session.CardLost(100);
+    EXPECT_EQ(session.CardDetected("043DF3FA094081", 500), CardSession::Start);
+    EXPECT_FALSE(session.IsLost());
+    EXPECT_EQ(session.Update(5000), CardSession::None);
+    // the first card is a new session again
+    session.CardLost(6000);
+    EXPECT_EQ(session.CardDetected("04A1B2C3", 6100), CardSession::Start);
+}
+
+TEST(CardSessionTest, timeWrapsAround) {
+    CardSession session;
+    session.SetGracePeriod(2000);
+    session.CardDetected("04A1B2C3", 0xFFFFFF00u);
+    session.CardLost(0xFFFFFF00u);
+    EXPECT_EQ(session.Update(1000), CardSession::None);
+    EXPECT_EQ(session.Update(0x700), CardSession::Stop);
+}
+
+/*
+ * Runs the RFID polling of the reader against a flaky card and feeds the
+ * events into a session, counting the starts and stops.
+ */
+static void RunFlakyCard(FakeMFRC522& fake, CardSession& session, uint32_t until,
+        uint32_t& starts, uint32_t& stops) {
+    const uint8_t uid[] = {0x04, 0xA1, 0xB2, 0xC3};
+    const uint32_t idlePoll = 20;
+    const uint32_t presencePoll = 250;
+
+    CardSensor sensor(&fake);
+    sensor.Init();
+    bool present = false;
+    starts = 0;
+    stops = 0;
+
+    while (fake.Now() < until) {
+        if (present == false) {
+            if (sensor.RequestCard() && fake.SelectCard()) {
+                sensor.HaltCard();
+                present = true;
+                if (session.CardDetected("04A1B2C3", fake.Now()) == CardSession::Start) {
+                    ++starts;
+                }
+            }
+        } else if (sensor.CheckPresence(uid, sizeof(uid)) == false) {
+            present = false;
+            if (session.CardLost(fake.Now()) == CardSession::Stop) {
+                ++stops;
+            }
+        }
+
+        if (session.Update(fake.Now()) == CardSession::Stop) {
+            ++stops;
+        }
+        fake.Advance(present ? presencePoll : idlePoll);
+    }
+}
+
+TEST(CardSessionTest, flakyCardKeepsPlaying) {
+    FakeMFRC522 fake;
+    // the figurine wobbles on the reader, each dropout is caught by a poll
+    fake.PlaceCard(100, 3000);
+    fake.PlaceCard(3300, 6000);
+    fake.PlaceCard(6400, 9000);
+    fake.PlaceCard(9500, 20000);
+
+    CardSession session;
+    session.SetGracePeriod(2000);
+    uint32_t starts;
+    uint32_t stops;
+    RunFlakyCard(fake, session, 20000, starts, stops);
+    EXPECT_EQ(starts, 1u);
+    EXPECT_EQ(stops, 0u);
+    EXPECT_TRUE(session.IsActive());
+}
+
+TEST(CardSessionTest, flakyCardWithoutGrace) {
+    FakeMFRC522 fake;
+    fake.PlaceCard(100, 3000);
+    fake.PlaceCard(3300, 6000);
+    fake.PlaceCard(6400, 9000);
+    fake.PlaceCard(9500, 20000);
+
+    CardSession session;
+    uint32_t starts;
+    uint32_t stops;
+    RunFlakyCard(fake, session, 20000, starts, stops);
+    // every dropout restarts the playlist from the first title
+    EXPECT_EQ(starts, 4u);
+    EXPECT_EQ(stops, 3u);
+}
+
+TEST(CardSessionTest, removedCardStops) {
+    FakeMFRC522 fake;
+    fake.PlaceCard(100, 3000);
+    fake.PlaceCard(3300, 5000);
+
+    CardSession session;
+    session.SetGracePeriod(2000);
+    uint32_t starts;
+    uint32_t stops;
+    RunFlakyCard(fake, session, 10000, starts, stops);
+    EXPECT_EQ(starts, 1u);
+    EXPECT_EQ(stops, 1u);
+    EXPECT_FALSE(session.IsActive());
+}
@@ -0,0 +1,93 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "ch.h"
+#include "qhal.h"
+}
+
+#include "common/clustermappool.h"
+
+using tmb_musicplayer::ClusterMapPool;
+
+class ClusterMapPoolTest : public ::testing::Test {
+ protected:
+    ClusterMapPoolTest() : pool(words, PoolSize) {
+    }
+
+    static const uint32_t PoolSize = 64;
+    uint32_t words[PoolSize];
+    ClusterMapPool pool;
+};
+
+TEST_F(ClusterMapPoolTest, AllocateLargestTakesEverything) {
+    uint32_t size;
+    uint32_t* block = pool.AllocateLargest(size);
+    ASSERT_EQ(words, block);
+    EXPECT_EQ(uint32_t(PoolSize), size);
+    EXPECT_EQ(0u, pool.LargestFree());
+    EXPECT_EQ(NULL, pool.Allocate(1));
+}
+
+TEST_F(ClusterMapPoolTest, ShrinkReturnsTail) {
+    uint32_t size;
+    uint32_t* first = pool.AllocateLargest(size);
+    pool.Shrink(first, 10);
+    EXPECT_EQ(uint32_t(PoolSize - 10), pool.LargestFree());
+
+    uint32_t* second = pool.AllocateLargest(size);
+    EXPECT_EQ(first + 10, second);
+    EXPECT_EQ(uint32_t(PoolSize - 10), size);
+
+    /* Growing is not possible.*/
+    pool.Shrink(second, PoolSize);
+    EXPECT_EQ(0u, pool.LargestFree());
+}
+
+TEST_F(ClusterMapPoolTest, ReleasedGapIsReused) {
+    uint32_t* a = pool.Allocate(16);
+    uint32_t* b = pool.Allocate(16);
+    uint32_t* c = pool.Allocate(16);
+    ASSERT_NE((uint32_t*)NULL, c);
+    EXPECT_EQ(a + 16, b);
+
+    pool.Release(b);
+    EXPECT_EQ(16u, pool.LargestFree());
+    EXPECT_EQ(b, pool.Allocate(8));
+    EXPECT_EQ(b + 8, pool.Allocate(8));
+    /* The tail is free but all blocks are in use.*/
+    EXPECT_EQ(0u, pool.LargestFree());
+
+    pool.Release(a);
+    pool.Release(c);
+    EXPECT_EQ(c, pool.Allocate(32));
+    EXPECT_EQ(NULL, pool.Allocate(17));
+}
+
+TEST_F(ClusterMapPoolTest, BlockCountIsLimited) {
+    for (uint32_t i = 0; i < ClusterMapPool::MaxBlocks; i++) {
+        EXPECT_NE((uint32_t*)NULL, pool.Allocate(1));
+    }
+    EXPECT_EQ(NULL, pool.Allocate(1));
+    EXPECT_EQ(0u, pool.LargestFree());
+
+    /* Unknown blocks are ignored.*/
+    pool.Release(words + 40);
+    EXPECT_EQ(uint32_t(ClusterMapPool::MaxBlocks), pool.BlockCount());
+
+    pool.Release(words);
+    EXPECT_EQ(words, pool.Allocate(1));
+}
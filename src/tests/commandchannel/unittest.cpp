@@ -0,0 +1,188 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "ch.h"
+#include "qhal.h"
+}
+
+#include "common/commandchannel.h"
+
+using tmb_musicplayer::CommandChannel;
+using tmb_musicplayer::CommandStats;
+using tmb_musicplayer::PlayTarget;
+
+typedef CommandChannel<std::mutex> Channel;
+
+static PlayTarget MakeTarget(uint32_t playlist, int32_t index) {
+    PlayTarget target;
+    target.playlist = playlist;
+    target.index = index;
+    /* derived from the index, a torn target does not match*/
+    target.offset = index * 3;
+    target.decodeTime = index & 0xFFFF;
+    return target;
+}
+
+static uint32_t CountCommands(uint32_t commands) {
+    uint32_t count = 0;
+    for (; commands != 0; commands &= commands - 1) {
+        count++;
+    }
+    return count;
+}
+
+TEST(CommandChannelTest, EmptyChannelFetchesNothing) {
+    Channel channel;
+    PlayTarget play;
+    PlayTarget next;
+    uint8_t volume;
+    EXPECT_EQ(0u, channel.Fetch(play, next, volume));
+}
+
+TEST(CommandChannelTest, VolumeCollapsesToLatest) {
+    Channel channel;
+    for (uint8_t v = 1; v <= 10; v++) {
+        channel.PostVolume(v);
+    }
+
+    PlayTarget play;
+    PlayTarget next;
+    uint8_t volume;
+    EXPECT_EQ(uint32_t(Channel::CommandVolume), channel.Fetch(play, next, volume));
+    EXPECT_EQ(10, volume);
+    EXPECT_EQ(0u, channel.Fetch(play, next, volume));
+
+    CommandStats stats;
+    channel.ReadStats(stats);
+    EXPECT_EQ(10u, stats.posted);
+    EXPECT_EQ(9u, stats.coalesced);
+    EXPECT_EQ(0u, stats.dropped);
+}
+
+TEST(CommandChannelTest, PlayKeepsLatestTarget) {
+    Channel channel;
+    channel.PostPlay(MakeTarget(1, 4));
+    channel.PostPlay(MakeTarget(2, 7));
+
+    PlayTarget play;
+    PlayTarget next;
+    uint8_t volume;
+    EXPECT_EQ(uint32_t(Channel::CommandPlay), channel.Fetch(play, next, volume));
+    EXPECT_EQ(2u, play.playlist);
+    EXPECT_EQ(7, play.index);
+    EXPECT_EQ(21u, play.offset);
+}
+
+TEST(CommandChannelTest, PlayDiscardsQueuedTitle) {
+    Channel channel;
+    channel.PostNext(MakeTarget(1, 5));
+    channel.PostPlay(MakeTarget(1, 8));
+
+    PlayTarget play;
+    PlayTarget next;
+    uint8_t volume;
+    EXPECT_EQ(uint32_t(Channel::CommandPlay), channel.Fetch(play, next, volume));
+
+    /* a title queued after the start is kept*/
+    channel.PostPlay(MakeTarget(1, 2));
+    channel.PostNext(MakeTarget(1, 3));
+    EXPECT_EQ(uint32_t(Channel::CommandPlay | Channel::CommandNext), channel.Fetch(play, next, volume));
+    EXPECT_EQ(2, play.index);
+    EXPECT_EQ(3, next.index);
+
+    CommandStats stats;
+    channel.ReadStats(stats);
+    EXPECT_EQ(4u, stats.posted);
+    EXPECT_EQ(1u, stats.coalesced);
+}
+
+TEST(CommandChannelTest, DropIsCounted) {
+    Channel channel;
+    channel.Drop();
+    channel.Drop();
+    CommandStats stats;
+    channel.ReadStats(stats);
+    EXPECT_EQ(0u, stats.posted);
+    EXPECT_EQ(2u, stats.dropped);
+}
+
+TEST(CommandChannelTest, ConcurrentPostsAreNeverLost) {
+    Channel channel;
+    const uint32_t producers = 4;
+    const int32_t posts = 50000;
+    std::atomic<uint32_t> running(producers);
+
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; p++) {
+        threads.push_back(std::thread([&, p]() {
+            for (int32_t i = 1; i <= posts; i++) {
+                channel.PostPlay(MakeTarget(p, i));
+                channel.PostVolume(i & 0xFF);
+                channel.PostNext(MakeTarget(p, i + 1));
+            }
+            running--;
+        }));
+    }
+
+    /* the latest index seen of every producer, only moves forward*/
+    int32_t lastPlay[producers] = {0};
+    uint32_t delivered = 0;
+    bool finished = false;
+    while (finished == false) {
+        finished = (running == 0);
+
+        PlayTarget play;
+        PlayTarget next;
+        uint8_t volume;
+        uint32_t commands = channel.Fetch(play, next, volume);
+        delivered += CountCommands(commands);
+        /* a failed ASSERT would return with the producers still joinable*/
+        if (commands & Channel::CommandPlay) {
+            EXPECT_LT(play.playlist, producers);
+            EXPECT_EQ(uint32_t(play.index * 3), play.offset);
+            EXPECT_EQ(play.index & 0xFFFF, play.decodeTime);
+            if (play.playlist < producers) {
+                EXPECT_GT(play.index, lastPlay[play.playlist]);
+                lastPlay[play.playlist] = play.index;
+            }
+        }
+        if (commands & Channel::CommandNext) {
+            EXPECT_LT(next.playlist, producers);
+            EXPECT_EQ(uint32_t(next.index * 3), next.offset);
+        }
+        if (HasFailure()) {
+            break;
+        }
+    }
+    for (uint32_t p = 0; p < producers; p++) {
+        threads[p].join();
+    }
+    if (HasFailure()) {
+        return;
+    }
+
+    CommandStats stats;
+    channel.ReadStats(stats);
+    EXPECT_EQ(producers * posts * 3, stats.posted);
+    EXPECT_EQ(stats.posted, delivered + stats.coalesced);
+    EXPECT_EQ(0u, stats.dropped);
+}
@@ -0,0 +1,212 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <algorithm>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "ch.h"
+#include "qhal.h"
+}
+
+#include "common/dreqwait.h"
+
+/*
+ * Codec FIFO on a virtual clock in ticks, drained at a fixed byte rate
+ * like the codec model of the simulator. DREQ is high while the FIFO
+ * takes another burst. With Interrupt the rising edge wakes the waiter
+ * as the EXT callback of the driver does, otherwise the waiter polls.
+ */
+class FakeDREQ {
+ public:
+    static const uint32_t FifoSize = 2048;
+    static const uint32_t Burst = 32;
+    /* The poll interval of the driver without the interrupt, 1 ms.*/
+    static const uint32_t PollInterval = 10;
+
+    enum Mode {
+        Interrupt,
+        Poll,
+    };
+
+    FakeDREQ(Mode wakeup, uint32_t rate)
+        : mode(wakeup), bytesPerTick(rate), now(0), fifoLevel(0),
+          rise(0), blocks(0), otherWriter(0) {
+        port.read = Read;
+        port.block = Block;
+        port.now = Now;
+        port.arg = this;
+    }
+
+    bool Level() const {
+        return (FifoSize - fifoLevel) >= Burst;
+    }
+
+    void Advance(uint32_t ticks) {
+        for (uint32_t i = 0; i < ticks; i++) {
+            bool before = Level();
+            now++;
+            fifoLevel -= std::min(fifoLevel, bytesPerTick);
+            if ((before == false) && Level()) {
+                rise = now;
+            }
+        }
+    }
+
+    void Send(uint32_t bytes) {
+        fifoLevel += bytes;
+    }
+
+    /* Ticks until the FIFO takes a burst again, 0 if never.*/
+    uint32_t TimeToRise() const {
+        if (bytesPerTick == 0) {
+            return 0;
+        }
+        uint32_t missing = fifoLevel - (FifoSize - Burst);
+        return (missing + bytesPerTick - 1) / bytesPerTick;
+    }
+
+    struct dreq_port port;
+    Mode mode;
+    uint32_t bytesPerTick;
+    uint32_t now;
+    uint32_t fifoLevel;
+    /* Time of the last rising edge of DREQ.*/
+    uint32_t rise;
+    uint32_t blocks;
+    /* Bursts another writer sends right after the next wakeups.*/
+    uint32_t otherWriter;
+
+ private:
+    static FakeDREQ* Self(void* arg) {
+        return static_cast<FakeDREQ*>(arg);
+    }
+
+    static bool Read(void* arg) {
+        return Self(arg)->Level();
+    }
+
+    static bool Block(void* arg, uint32_t timeout) {
+        FakeDREQ* self = Self(arg);
+        self->blocks++;
+        if (self->mode == Poll) {
+            self->Advance(std::min(timeout, PollInterval));
+            return true;
+        }
+        uint32_t wait = self->TimeToRise();
+        if ((wait == 0) || (wait > timeout)) {
+            self->Advance(timeout);
+            return false;
+        }
+        self->Advance(wait);
+        if (self->otherWriter > 0) {
+            self->otherWriter--;
+            self->Send(Burst);
+        }
+        return true;
+    }
+
+    static uint32_t Now(void* arg) {
+        return Self(arg)->now;
+    }
+};
+
+const uint32_t FakeDREQ::FifoSize;
+const uint32_t FakeDREQ::Burst;
+const uint32_t FakeDREQ::PollInterval;
+
+/* Feeds bursts for the given time and returns the longest time from a
+ * rising edge of DREQ to the waiter getting it.*/
+static uint32_t MaxWakeupLatency(FakeDREQ& fake, uint32_t duration) {
+    const uint32_t timeout = 1000;
+    uint32_t maxLatency = 0;
+
+    while (fake.now < duration) {
+        bool wasLow = (fake.Level() == false);
+        EXPECT_TRUE(dreq_wait(&fake.port, timeout));
+        if (wasLow) {
+            maxLatency = std::max(maxLatency, fake.now - fake.rise);
+        }
+        fake.Send(FakeDREQ::Burst);
+    }
+    return maxLatency;
+}
+
+TEST(DREQWaitTest, highLevelDoesNotBlock) {
+    FakeDREQ fake(FakeDREQ::Interrupt, 4);
+    EXPECT_TRUE(dreq_wait(&fake.port, 100));
+    EXPECT_EQ(0u, fake.blocks);
+    EXPECT_EQ(0u, fake.now);
+}
+
+TEST(DREQWaitTest, risingEdgeWakesWaiter) {
+    FakeDREQ fake(FakeDREQ::Interrupt, 4);
+    fake.Send(FakeDREQ::FifoSize);
+
+    EXPECT_TRUE(dreq_wait(&fake.port, 100));
+    // woken once at the edge, the FIFO took 32 bytes after 8 ticks
+    EXPECT_EQ(8u, fake.now);
+    EXPECT_EQ(fake.rise, fake.now);
+    EXPECT_EQ(1u, fake.blocks);
+}
+
+TEST(DREQWaitTest, wakeupLatencyOfTheCodecFeed) {
+    // 4 bytes per tick at 10 kHz are 320 kbit/s
+    FakeDREQ fake(FakeDREQ::Interrupt, 4);
+    fake.Send(FakeDREQ::FifoSize);
+
+    // every burst is sent the tick DREQ rises, no dead time per chunk
+    EXPECT_EQ(0u, MaxWakeupLatency(fake, 100000));
+    EXPECT_EQ(fake.now / 8, fake.blocks);
+}
+
+TEST(DREQWaitTest, pollingMissesTheEdge) {
+    // the same feed without the interrupt is what the latency test catches
+    FakeDREQ fake(FakeDREQ::Poll, 4);
+    fake.Send(FakeDREQ::FifoSize);
+
+    uint32_t latency = MaxWakeupLatency(fake, 100000);
+    EXPECT_GT(latency, 0u);
+    EXPECT_LT(latency, FakeDREQ::PollInterval);
+}
+
+TEST(DREQWaitTest, stalledCodecTimesOut) {
+    FakeDREQ fake(FakeDREQ::Interrupt, 0);
+    fake.Send(FakeDREQ::FifoSize);
+
+    EXPECT_FALSE(dreq_wait(&fake.port, 100));
+    EXPECT_EQ(100u, fake.now);
+    EXPECT_EQ(1u, fake.blocks);
+}
+
+TEST(DREQWaitTest, lostWakeupsKeepTheTimeout) {
+    FakeDREQ fake(FakeDREQ::Interrupt, 4);
+    fake.Send(FakeDREQ::FifoSize);
+    // the FIFO space of the first wakeups goes to somebody else
+    fake.otherWriter = 1000;
+
+    EXPECT_FALSE(dreq_wait(&fake.port, 100));
+    EXPECT_EQ(100u, fake.now);
+    EXPECT_EQ(13u, fake.blocks);
+}
+
+TEST(DREQWaitTest, pollingKeepsTheTimeout) {
+    FakeDREQ fake(FakeDREQ::Poll, 0);
+    fake.Send(FakeDREQ::FifoSize);
+
+    EXPECT_FALSE(dreq_wait(&fake.port, 25));
+    EXPECT_EQ(25u, fake.now);
+    EXPECT_EQ(3u, fake.blocks);
+}
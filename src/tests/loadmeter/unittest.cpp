@@ -0,0 +1,115 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <string.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "ch.h"
+#include "qhal.h"
+}
+
+#include "common/loadmeter.h"
+
+using tmb_musicplayer::LoadMeter;
+
+static int threadA;
+static int threadB;
+static int threadC;
+
+TEST(LoadMeterTest, FirstSampleCountsNothing) {
+    LoadMeter<4> meter;
+    meter.Begin(100);
+    EXPECT_EQ(0u, meter.Sample(&threadA, 500));
+    meter.End();
+}
+
+TEST(LoadMeterTest, ShareOfTheInterval) {
+    LoadMeter<4> meter;
+    meter.Begin(0);
+    meter.Sample(&threadA, 10);
+    meter.Sample(&threadB, 20);
+    meter.End();
+
+    meter.Begin(1000);
+    EXPECT_EQ(250u, meter.Sample(&threadA, 260));
+    EXPECT_EQ(705u, meter.Sample(&threadB, 725));
+    meter.End();
+
+    meter.Begin(1500);
+    EXPECT_EQ(0u, meter.Sample(&threadA, 260));
+    EXPECT_EQ(1000u, meter.Sample(&threadB, 1225));
+    meter.End();
+}
+
+TEST(LoadMeterTest, ShareIsLimitedToTheInterval) {
+    LoadMeter<4> meter;
+    meter.Begin(0);
+    meter.Sample(&threadA, 0);
+    meter.End();
+
+    /* The tick of the sample itself may already count for the thread.*/
+    meter.Begin(100);
+    EXPECT_EQ(1000u, meter.Sample(&threadA, 101));
+    meter.End();
+}
+
+TEST(LoadMeterTest, ExitedThreadFreesItsSlot) {
+    LoadMeter<2> meter;
+    meter.Begin(0);
+    meter.Sample(&threadA, 0);
+    meter.Sample(&threadB, 0);
+    /* No slot left.*/
+    EXPECT_EQ(0u, meter.Sample(&threadC, 0));
+    meter.End();
+
+    meter.Begin(100);
+    EXPECT_EQ(100u, meter.Sample(&threadA, 10));
+    meter.End();
+
+    meter.Begin(200);
+    meter.Sample(&threadA, 20);
+    meter.Sample(&threadC, 40);
+    meter.End();
+
+    meter.Begin(300);
+    EXPECT_EQ(100u, meter.Sample(&threadA, 30));
+    EXPECT_EQ(500u, meter.Sample(&threadC, 90));
+    meter.End();
+}
+
+TEST(LoadMeterTest, RestartedThreadCountsFromZero) {
+    LoadMeter<4> meter;
+    meter.Begin(0);
+    meter.Sample(&threadA, 5000);
+    meter.End();
+
+    meter.Begin(100);
+    EXPECT_EQ(300u, meter.Sample(&threadA, 30));
+    meter.End();
+}
+
+TEST(LoadMeterTest, UnusedStackStopsAtFirstUsedByte) {
+    uint8_t stack[64];
+    memset(stack, 0x55, sizeof(stack));
+    stack[sizeof(stack) - 1] = 0;
+    EXPECT_EQ(63u, LoadMeter<1>::UnusedStack(stack, 0x55));
+
+    stack[20] = 0x54;
+    EXPECT_EQ(20u, LoadMeter<1>::UnusedStack(stack, 0x55));
+
+    stack[0] = 0;
+    EXPECT_EQ(0u, LoadMeter<1>::UnusedStack(stack, 0x55));
+}
@@ -0,0 +1,153 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "ch.h"
+#include "qhal.h"
+}
+
+#include "common/metadatatags.h"
+
+using tmb_musicplayer::MetadataTags;
+
+class MetadataTagsTest : public ::testing::Test {
+ protected:
+    static std::vector<uint8_t> ID3v2Header(uint8_t version, uint8_t flags, uint32_t size) {
+        std::vector<uint8_t> header = {'I', 'D', '3', version, 0, flags,
+            (uint8_t)((size >> 21) & 0x7F), (uint8_t)((size >> 14) & 0x7F),
+            (uint8_t)((size >> 7) & 0x7F), (uint8_t)(size & 0x7F)};
+        return header;
+    }
+
+    static std::vector<uint8_t> APEFooter(uint32_t size, bool hasHeader) {
+        std::vector<uint8_t> footer(MetadataTags::APEFooterSize, 0);
+        memcpy(&footer[0], "APETAGEX", 8);
+        footer[8] = 0xD0; // version 2000
+        footer[9] = 0x07;
+        for (int i = 0; i < 4; i++) {
+            footer[12 + i] = (size >> (8 * i)) & 0xFF;
+        }
+        footer[16] = 2; // item count
+        if (hasHeader) {
+            footer[23] = 0x80;
+        }
+        return footer;
+    }
+
+    static std::vector<uint8_t> ID3v1Tag() {
+        std::vector<uint8_t> tag(MetadataTags::ID3v1TagSize, ' ');
+        memcpy(&tag[0], "TAG", 3);
+        return tag;
+    }
+
+    static void Append(std::vector<uint8_t>& data, const std::vector<uint8_t>& part) {
+        data.insert(data.end(), part.begin(), part.end());
+    }
+};
+
+TEST_F(MetadataTagsTest, id3v2Version3) {
+    auto header = ID3v2Header(3, 0, 257);
+    EXPECT_EQ(MetadataTags::ID3v2TagSize(&header[0], header.size()), 267u);
+}
+
+TEST_F(MetadataTagsTest, id3v2LargeAlbumArt) {
+    // 300 kB of embedded cover art use all four synchsafe bytes
+    auto header = ID3v2Header(3, 0, 300 * 1024);
+    EXPECT_EQ(header[7], 0x12);
+    EXPECT_EQ(MetadataTags::ID3v2TagSize(&header[0], header.size()), 300u * 1024 + 10);
+}
+
+TEST_F(MetadataTagsTest, id3v2Version4Footer) {
+    auto header = ID3v2Header(4, 0x10, 1000);
+    EXPECT_EQ(MetadataTags::ID3v2TagSize(&header[0], header.size()), 1020u);
+
+    // the footer flag is not defined before v2.4
+    header = ID3v2Header(3, 0x10, 1000);
+    EXPECT_EQ(MetadataTags::ID3v2TagSize(&header[0], header.size()), 1010u);
+}
+
+TEST_F(MetadataTagsTest, id3v2Unsynchronisation) {
+    // unsynchronisation and extended header change the content only
+    auto header = ID3v2Header(3, 0x80 | 0x40, 4096);
+    EXPECT_EQ(MetadataTags::ID3v2TagSize(&header[0], header.size()), 4106u);
+
+    header = ID3v2Header(2, 0x80, 4096);
+    EXPECT_EQ(MetadataTags::ID3v2TagSize(&header[0], header.size()), 4106u);
+}
+
+TEST_F(MetadataTagsTest, id3v2Invalid) {
+    // mpeg frame sync
+    const uint8_t frame[10] = {0xFF, 0xFB, 0x90, 0x64, 0, 0, 0, 0, 0, 0};
+    EXPECT_EQ(MetadataTags::ID3v2TagSize(frame, sizeof(frame)), 0u);
+
+    auto header = ID3v2Header(3, 0, 100);
+    EXPECT_EQ(MetadataTags::ID3v2TagSize(&header[0], 9), 0u);
+
+    header[6] = 0x80;
+    EXPECT_EQ(MetadataTags::ID3v2TagSize(&header[0], header.size()), 0u);
+
+    header = ID3v2Header(5, 0, 100);
+    EXPECT_EQ(MetadataTags::ID3v2TagSize(&header[0], header.size()), 0u);
+
+    header = ID3v2Header(3, 0, 100);
+    header[4] = 0xFF;
+    EXPECT_EQ(MetadataTags::ID3v2TagSize(&header[0], header.size()), 0u);
+}
+
+TEST_F(MetadataTagsTest, trailingNoTags) {
+    std::vector<uint8_t> tail(MetadataTags::TrailerSize, 0x55);
+    EXPECT_EQ(MetadataTags::TrailingTagSize(&tail[0], tail.size()), 0u);
+}
+
+TEST_F(MetadataTagsTest, trailingID3v1) {
+    std::vector<uint8_t> data(500, 0x55);
+    Append(data, ID3v1Tag());
+    const uint8_t* tail = &data[data.size() - MetadataTags::TrailerSize];
+    EXPECT_EQ(MetadataTags::TrailingTagSize(tail, MetadataTags::TrailerSize), 128u);
+}
+
+TEST_F(MetadataTagsTest, trailingAPEWithHeaderAndID3v1) {
+    // APEv2 with header, items and footer followed by an ID3v1 tag
+    std::vector<uint8_t> data(500, 0x55);
+    Append(data, APEFooter(100 + 32, true));
+    data.insert(data.end(), 100, 'x');
+    Append(data, APEFooter(100 + 32, true));
+    Append(data, ID3v1Tag());
+    const uint8_t* tail = &data[data.size() - MetadataTags::TrailerSize];
+    EXPECT_EQ(MetadataTags::TrailingTagSize(tail, MetadataTags::TrailerSize), 128u + 32 + 100 + 32);
+    EXPECT_EQ(data.size() - MetadataTags::TrailingTagSize(tail, MetadataTags::TrailerSize), 500u);
+}
+
+TEST_F(MetadataTagsTest, trailingAPEv1) {
+    // APEv1 has no header
+    std::vector<uint8_t> data(500, 0x55);
+    data.insert(data.end(), 60, 'x');
+    Append(data, APEFooter(60 + 32, false));
+    const uint8_t* tail = &data[data.size() - MetadataTags::TrailerSize];
+    EXPECT_EQ(MetadataTags::TrailingTagSize(tail, MetadataTags::TrailerSize), 92u);
+}
+
+TEST_F(MetadataTagsTest, trailingShortFile) {
+    auto tag = ID3v1Tag();
+    EXPECT_EQ(MetadataTags::TrailingTagSize(&tag[0], tag.size()), 128u);
+    EXPECT_EQ(MetadataTags::TrailingTagSize(&tag[0], 64), 0u);
+
+    auto footer = APEFooter(16, false);
+    EXPECT_EQ(MetadataTags::TrailingTagSize(&footer[0], footer.size()), 0u);
+}
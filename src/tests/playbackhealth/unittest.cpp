@@ -0,0 +1,113 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "ch.h"
+#include "qhal.h"
+}
+
+#include "common/playbackhealth.h"
+
+using tmb_musicplayer::PlaybackCounters;
+using tmb_musicplayer::PlaybackHealth;
+using tmb_musicplayer::PlaybackStats;
+
+TEST(PlaybackHealthTest, StartsEmpty) {
+    PlaybackHealth health;
+    const PlaybackStats& stats = health.Update(0);
+    EXPECT_EQ(0u, stats.current.bytes);
+    EXPECT_EQ(0u, stats.total.sends);
+    EXPECT_EQ(0u, stats.titles);
+}
+
+TEST(PlaybackHealthTest, CountsSendsAndReads) {
+    PlaybackHealth health;
+    health.StartTrack(100);
+    health.Sent(32, 2, 128);
+    health.Sent(32, 5, 128);
+    health.ReadDone(3);
+    health.ReadDone(1);
+
+    const PlaybackStats& stats = health.Update(150);
+    EXPECT_EQ(64u, stats.current.bytes);
+    EXPECT_EQ(2u, stats.current.sends);
+    EXPECT_EQ(7u, stats.current.hungryTotal);
+    EXPECT_EQ(5u, stats.current.hungryMax);
+    EXPECT_EQ(2u, stats.current.reads);
+    EXPECT_EQ(4u, stats.current.readTotal);
+    EXPECT_EQ(3u, stats.current.readMax);
+    EXPECT_EQ(50u, stats.current.duration);
+    EXPECT_EQ(0u, stats.current.underruns);
+}
+
+TEST(PlaybackHealthTest, HungerBeyondTheFifoIsAnUnderrun) {
+    PlaybackHealth health;
+    health.StartTrack(0);
+    health.Sent(32, 128, 128);
+    health.Sent(32, 140, 128);
+    health.Sent(32, 200, 128);
+
+    const PlaybackStats& stats = health.Update(1000);
+    EXPECT_EQ(2u, stats.current.underruns);
+    EXPECT_EQ(12u + 72u, stats.current.stallTotal);
+}
+
+TEST(PlaybackHealthTest, UnknownByteRateCountsNoUnderrun) {
+    PlaybackHealth health;
+    health.StartTrack(0);
+    health.Sent(32, 5000, 0);
+
+    const PlaybackStats& stats = health.Update(6000);
+    EXPECT_EQ(0u, stats.current.underruns);
+    EXPECT_EQ(5000u, stats.current.hungryMax);
+}
+
+TEST(PlaybackHealthTest, EndTrackKeepsLastAndSumsTotal) {
+    PlaybackHealth health;
+    health.StartTrack(0);
+    health.Sent(1000, 0, 100);
+    health.EndTrack(500);
+    health.Sent(200, 300, 100);
+    health.ReadDone(7);
+    health.EndTrack(700);
+
+    const PlaybackStats& stats = health.Update(700);
+    EXPECT_EQ(2u, stats.titles);
+    EXPECT_EQ(0u, stats.current.bytes);
+    EXPECT_EQ(0u, stats.current.duration);
+    EXPECT_EQ(200u, stats.last.bytes);
+    EXPECT_EQ(200u, stats.last.duration);
+    EXPECT_EQ(1u, stats.last.underruns);
+    EXPECT_EQ(1u, stats.last.reads);
+    EXPECT_EQ(1200u, stats.total.bytes);
+    EXPECT_EQ(700u, stats.total.duration);
+    EXPECT_EQ(1u, stats.total.underruns);
+    EXPECT_EQ(300u, stats.total.hungryMax);
+}
+
+TEST(PlaybackHealthTest, BytesPerSecond) {
+    PlaybackCounters counters = PlaybackCounters();
+    EXPECT_EQ(0u, PlaybackHealth::BytesPerSecond(counters, 1000));
+
+    counters.bytes = 160000;
+    counters.duration = 10000;
+    EXPECT_EQ(16000u, PlaybackHealth::BytesPerSecond(counters, 1000));
+
+    /* Does not overflow for long titles at a fine tick.*/
+    counters.bytes = 400000000;
+    counters.duration = 250000000;
+    EXPECT_EQ(16000u, PlaybackHealth::BytesPerSecond(counters, 10000));
+}
@@ -15,6 +15,7 @@
 #include <iostream>
 #include <fstream>
 #include <cstring>
+#include <cstdio>
 
 #include "gtest/gtest.h"
 
@@ -23,109 +24,244 @@ extern "C" {
 #include "qhal.h"
 }
 
-#include "common/file.h"
 #include "common/playlist.h"
+#include "testfile.h"
 
-class TestFile : public tmb_musicplayer::File {
- public:
-    TestFile() {
+class PlaylistTest: public ::testing::Test {
+ protected:
+    virtual void SetUp() {
     }
 
-    virtual bool Open(const char* path) {
-        m_file.open(path,  std::ios::binary);
-        if (m_file.fail()) {
-            return false;
-        }
+    virtual void TearDown() {
+    }
+};
 
-        // read size
-        m_file.seekg(0, std::ios::end);
+TEST_F(PlaylistTest, load) {
+    std::array<char, 256> title;
 
-        m_size = m_file.tellg();
+    TestFile plFile;
+    plFile.Open("./playlist.m3u");
 
-        m_file.seekg(0, std::ios::beg);
+    tmb_musicplayer::Playlist pl;
+    bool loaded = pl.LoadFromFile(&plFile);
+    EXPECT_TRUE(loaded);
 
-        return true;
-    }
-    virtual bool Close() {
-        m_file.close();
-        return true;
-    }
-    virtual bool Sync() {
-        return true;
+    EXPECT_EQ(pl.GetTitleCount(), 6);
+
+    uint32_t firstTitleChars = pl.QueryNext(&title.front(), title.size());
+    EXPECT_GT(firstTitleChars, (uint32_t)0);
+
+    std::string strTitle(title.begin(), title.begin() + firstTitleChars);
+
+    EXPECT_STREQ("/titel1.mp3", strTitle.c_str());
+}
+
+TEST_F(PlaylistTest, peekNext) {
+    std::array<char, 256> title;
+
+    TestFile plFile;
+    plFile.Open("./playlist.m3u");
+
+    tmb_musicplayer::Playlist pl;
+    EXPECT_TRUE(pl.LoadFromFile(&plFile));
+
+    uint32_t chars = pl.PeekNext(&title.front(), title.size());
+    EXPECT_STREQ("/titel1.mp3", std::string(title.begin(), title.begin() + chars).c_str());
+
+    chars = pl.QueryNext(&title.front(), title.size());
+    EXPECT_STREQ("/titel1.mp3", std::string(title.begin(), title.begin() + chars).c_str());
+
+    chars = pl.PeekNext(&title.front(), title.size());
+    EXPECT_STREQ("/titel2.mp3", std::string(title.begin(), title.begin() + chars).c_str());
+
+    /* peeking does not advance the playlist */
+    chars = pl.QueryNext(&title.front(), title.size());
+    EXPECT_STREQ("/titel2.mp3", std::string(title.begin(), title.begin() + chars).c_str());
+
+    for (int i = 2; i < pl.GetTitleCount(); i++) {
+        EXPECT_GT(pl.QueryNext(&title.front(), title.size()), (uint32_t)0);
     }
-    virtual bool Create(const char* path) {
-        return false;
+    EXPECT_EQ(pl.PeekNext(&title.front(), title.size()), (uint32_t)0);
+}
+
+TEST_F(PlaylistTest, indexFile) {
+    static const char* indexPath = "./playlist.idx";
+    std::array<char, 256> title;
+    std::remove(indexPath);
+
+    // the first load parses the playlist and writes the index
+    TestFile plFile;
+    plFile.Open("./playlist.m3u");
+    TestFile indexFile;
+    tmb_musicplayer::Playlist pl;
+    EXPECT_TRUE(pl.LoadFromFile(&plFile, &indexFile, indexPath));
+    EXPECT_EQ(pl.GetTitleCount(), 6);
+    EXPECT_GT(plFile.getStringCalls, (uint32_t)0);
+
+    // the second load only reads the index
+    TestFile plFile2;
+    plFile2.Open("./playlist.m3u");
+    TestFile indexFile2;
+    tmb_musicplayer::Playlist pl2;
+    EXPECT_TRUE(pl2.LoadFromFile(&plFile2, &indexFile2, indexPath));
+    EXPECT_EQ(plFile2.getStringCalls, (uint32_t)0);
+    EXPECT_EQ(pl2.GetTitleCount(), 6);
+
+    for (int i = 0; i < pl.GetTitleCount(); i++) {
+        uint32_t chars = pl.QueryNext(&title.front(), title.size());
+        std::string expected(title.begin(), title.begin() + chars);
+        chars = pl2.QueryNext(&title.front(), title.size());
+        EXPECT_STREQ(expected.c_str(), std::string(title.begin(), title.begin() + chars).c_str());
     }
 
-    virtual uint32_t GetString(char* buffer, uint32_t bufferSize) {
-        if (IsEOF()) {
-            return false;
+    // a modified playlist invalidates the index
+    TestFile plFile3;
+    plFile3.Open("./playlist.m3u");
+    plFile3.timestamp++;
+    TestFile indexFile3;
+    tmb_musicplayer::Playlist pl3;
+    EXPECT_TRUE(pl3.LoadFromFile(&plFile3, &indexFile3, indexPath));
+    EXPECT_GT(plFile3.getStringCalls, (uint32_t)0);
+    EXPECT_EQ(pl3.GetTitleCount(), 6);
+    uint32_t chars = pl3.QueryNext(&title.front(), title.size());
+    EXPECT_STREQ("/titel1.mp3", std::string(title.begin(), title.begin() + chars).c_str());
+
+    std::remove(indexPath);
+}
+
+TEST_F(PlaylistTest, indexOfShrunkPlaylist) {
+    static const char* playlistPath = "./shrink.m3u";
+    static const char* indexPath = "./shrink.idx";
+    std::remove(indexPath);
+
+    auto writePlaylist = [](int titles) {
+        std::ofstream m3u(playlistPath, std::ios::binary | std::ios::trunc);
+        for (int i = 0; i < titles; i++) {
+            m3u << "/titel" << i << ".mp3\r\n";
         }
-        std::string line;
-        if (std::getline(m_file, line)) {
-            if (line.size() < bufferSize) {
-                std::copy(line.begin(), line.end(), buffer);
-                return line.size();
+    };
+    auto load = [](uint32_t& getStringCalls) {
+        TestFile plFile;
+        plFile.Open(playlistPath);
+        TestFile indexFile;
+        tmb_musicplayer::Playlist pl;
+        pl.LoadFromFile(&plFile, &indexFile, indexPath);
+        getStringCalls = plFile.getStringCalls;
+        return pl.GetTitleCount();
+    };
+
+    uint32_t getStringCalls;
+    writePlaylist(10);
+    EXPECT_EQ(10, load(getStringCalls));
+
+    // the rewritten index is not longer than the new playlist needs
+    writePlaylist(4);
+    EXPECT_EQ(4, load(getStringCalls));
+    EXPECT_GT(getStringCalls, (uint32_t)0);
+    EXPECT_EQ(4, load(getStringCalls));
+    EXPECT_EQ(getStringCalls, (uint32_t)0);
+
+    std::remove(playlistPath);
+    std::remove(indexPath);
+}
+
+class LargePlaylistTest: public ::testing::Test {
+ protected:
+    static const int TitleCount = 5000;
+
+    virtual void SetUp() {
+        // more titles than checkpoints * page size, with comments in between
+        std::ofstream m3u(PlaylistPath, std::ios::binary | std::ios::trunc);
+        m3u << "#EXTM3U\r\n";
+        for (int i = 0; i < TitleCount; i++) {
+            if (i % 3 == 0) {
+                m3u << "#EXTINF:235,titel" << i << "\r\n";
             }
+            m3u << "/music/chapter" << i << ".mp3\r\n";
         }
-        return 0;
+        std::remove(IndexPath);
     }
 
-    virtual int32_t WriteString(const char* str) {
-        return 0;
+    virtual void TearDown() {
+        std::remove(PlaylistPath);
+        std::remove(IndexPath);
     }
 
-    virtual int32_t Tell() {
-        return m_file.tellg();
+    static std::string Title(int i) {
+        return "/music/chapter" + std::to_string(i) + ".mp3";
     }
 
-    virtual bool Seek(int32_t pos) {
-        m_file.clear();
-        return m_file.seekg(pos, std::ios::beg) ? true : false;
-    }
+    static void CheckAccess(tmb_musicplayer::Playlist& pl) {
+        std::array<char, 256> title;
+        ASSERT_EQ(pl.GetTitleCount(), TitleCount);
 
-    virtual int32_t Size() {
-        return m_size;
-    }
+        for (int i = 0; i < TitleCount; i++) {
+            uint32_t chars = pl.QueryNext(&title.front(), title.size());
+            ASSERT_EQ(Title(i), std::string(title.begin(), title.begin() + chars));
+        }
+        EXPECT_EQ(pl.QueryNext(&title.front(), title.size()), (uint32_t)0);
 
-    virtual bool Error() {
-        return m_file.fail();
-    }
+        for (int i = TitleCount - 1; i >= 0; i--) {
+            uint32_t chars = pl.QueryPrev(&title.front(), title.size());
+            ASSERT_EQ(Title(i), std::string(title.begin(), title.begin() + chars));
+        }
 
-    virtual bool IsEOF() {
-        return  m_file.eof();
-    }
+        const int indices[] = {4999, 0, 4096, 17, 2500, 4095, 31, 32};
+        for (int i : indices) {
+            uint32_t chars = pl.Query(i, &title.front(), title.size());
+            EXPECT_EQ(Title(i), std::string(title.begin(), title.begin() + chars));
+            EXPECT_EQ(pl.GetCurrentIndex(), i);
+        }
 
- private:
-    std::ifstream m_file;
-    int32_t m_size;
-};
+        uint32_t chars = pl.QueryNext(&title.front(), title.size());
+        EXPECT_EQ(Title(33), std::string(title.begin(), title.begin() + chars));
+        EXPECT_EQ(pl.Query(TitleCount, &title.front(), title.size()), (uint32_t)0);
 
-class PlaylistTest: public ::testing::Test {
- protected:
-    virtual void SetUp() {
-    }
+        /* reading by index leaves the current title alone*/
+        chars = pl.QueryTitle(4000, &title.front(), title.size());
+        EXPECT_EQ(Title(4000), std::string(title.begin(), title.begin() + chars));
+        EXPECT_EQ(pl.GetCurrentIndex(), 33);
+        EXPECT_EQ(pl.QueryTitle(TitleCount, &title.front(), title.size()), (uint32_t)0);
 
-    virtual void TearDown() {
+        EXPECT_TRUE(pl.SelectNext());
+        EXPECT_EQ(pl.GetCurrentIndex(), 34);
+        EXPECT_TRUE(pl.SelectPrev());
+        EXPECT_EQ(pl.GetCurrentIndex(), 33);
+        EXPECT_TRUE(pl.Select(TitleCount - 1));
+        EXPECT_FALSE(pl.SelectNext());
+        EXPECT_FALSE(pl.Select(-1));
+        EXPECT_EQ(pl.GetCurrentIndex(), TitleCount);
     }
+
+    static const char* PlaylistPath;
+    static const char* IndexPath;
 };
 
-TEST_F(PlaylistTest, load) {
-    std::array<char, 256> title;
+const int LargePlaylistTest::TitleCount;
+const char* LargePlaylistTest::PlaylistPath = "./large.m3u";
+const char* LargePlaylistTest::IndexPath = "./large.idx";
 
+TEST_F(LargePlaylistTest, withoutIndex) {
     TestFile plFile;
-    plFile.Open("./playlist.m3u");
-
+    ASSERT_TRUE(plFile.Open(PlaylistPath));
     tmb_musicplayer::Playlist pl;
-    bool loaded = pl.LoadFromFile(&plFile);
-    EXPECT_TRUE(loaded);
-
-    EXPECT_EQ(pl.GetTitleCount(), 6);
-
-    uint32_t firstTitleChars = pl.QueryNext(&title.front(), title.size());
-    EXPECT_GT(firstTitleChars, (uint32_t)0);
+    EXPECT_TRUE(pl.LoadFromFile(&plFile));
+    CheckAccess(pl);
+}
 
-    std::string strTitle(title.begin(), title.begin() + firstTitleChars);
+TEST_F(LargePlaylistTest, withIndex) {
+    TestFile plFile;
+    ASSERT_TRUE(plFile.Open(PlaylistPath));
+    TestFile indexFile;
+    tmb_musicplayer::Playlist pl;
+    EXPECT_TRUE(pl.LoadFromFile(&plFile, &indexFile, IndexPath));
+    CheckAccess(pl);
 
-    EXPECT_STREQ("/titel1.mp3", strTitle.c_str());
+    TestFile plFile2;
+    ASSERT_TRUE(plFile2.Open(PlaylistPath));
+    TestFile indexFile2;
+    tmb_musicplayer::Playlist pl2;
+    EXPECT_TRUE(pl2.LoadFromFile(&plFile2, &indexFile2, IndexPath));
+    EXPECT_EQ(plFile2.getStringCalls, (uint32_t)0);
+    CheckAccess(pl2);
 }
@@ -0,0 +1,197 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "ch.h"
+#include "qhal.h"
+}
+
+#include "common/resumetable.h"
+#include "testfile.h"
+
+using tmb_musicplayer::ResumeTable;
+using tmb_musicplayer::ResumePosition;
+
+/*
+ * Backup SRAM stand in, counts the bytes written.
+ */
+class TestStorage : public tmb_musicplayer::ResumeStorage {
+ public:
+    explicit TestStorage(uint32_t size) : memory(size, 0xA5) {
+    }
+
+    virtual bool Read(uint32_t offset, void* data, uint32_t size) {
+        if (offset + size > memory.size()) {
+            return false;
+        }
+        memcpy(data, &memory[offset], size);
+        return true;
+    }
+
+    virtual bool Write(uint32_t offset, const void* data, uint32_t size) {
+        if (offset + size > memory.size()) {
+            return false;
+        }
+        memcpy(&memory[offset], data, size);
+        bytesWritten += size;
+        return true;
+    }
+
+    std::vector<uint8_t> memory;
+    uint32_t bytesWritten = 0;
+};
+
+static const uint8_t UID1[] = {0x04, 0xA1, 0xB2, 0xC3};
+static const uint8_t UID2[] = {0x04, 0x3D, 0xF3, 0xFA, 0x09, 0x40, 0x81};
+static const uint8_t UID3[] = {0x04, 0x11, 0x22, 0x33};
+static const uint8_t UID4[] = {0x04, 0x44, 0x55, 0x66};
+
+static ResumePosition Position(int32_t index, uint32_t offset) {
+    ResumePosition pos = {0x4A8B6000, index, offset, offset / 16000};
+    return pos;
+}
+
+TEST(ResumeTableTest, storeAndFind) {
+    TestStorage storage(ResumeTable::StorageSize(4));
+    ResumeTable table(&storage, 4);
+    EXPECT_TRUE(table.Init());
+
+    ResumePosition pos;
+    EXPECT_FALSE(table.Find(UID1, sizeof(UID1), pos));
+
+    EXPECT_TRUE(table.Store(UID1, sizeof(UID1), Position(3, 123456)));
+    EXPECT_TRUE(table.Store(UID2, sizeof(UID2), Position(7, 42)));
+
+    EXPECT_TRUE(table.Find(UID1, sizeof(UID1), pos));
+    EXPECT_EQ(pos.titleIndex, 3);
+    EXPECT_EQ(pos.offset, 123456u);
+    EXPECT_EQ(pos.decodeTime, 7u);
+    EXPECT_EQ(pos.playlistStamp, 0x4A8B6000u);
+
+    EXPECT_TRUE(table.Find(UID2, sizeof(UID2), pos));
+    EXPECT_EQ(pos.titleIndex, 7);
+
+    // a prefix of a longer UID is another card
+    EXPECT_FALSE(table.Find(UID2, 4, pos));
+
+    table.Remove(UID1, sizeof(UID1));
+    EXPECT_FALSE(table.Find(UID1, sizeof(UID1), pos));
+}
+
+TEST(ResumeTableTest, survivesRestart) {
+    TestStorage storage(ResumeTable::StorageSize(4));
+    {
+        ResumeTable table(&storage, 4);
+        EXPECT_TRUE(table.Init());
+        table.Store(UID1, sizeof(UID1), Position(3, 123456));
+    }
+
+    ResumeTable table(&storage, 4);
+    EXPECT_TRUE(table.Init());
+    ResumePosition pos;
+    EXPECT_TRUE(table.Find(UID1, sizeof(UID1), pos));
+    EXPECT_EQ(pos.offset, 123456u);
+
+    // another layout starts from scratch
+    ResumeTable other(&storage, 2);
+    EXPECT_TRUE(other.Init());
+    EXPECT_FALSE(other.Find(UID1, sizeof(UID1), pos));
+}
+
+TEST(ResumeTableTest, incrementalWrites) {
+    TestStorage storage(ResumeTable::StorageSize(16));
+    ResumeTable table(&storage, 16);
+    EXPECT_TRUE(table.Init());
+    table.Store(UID1, sizeof(UID1), Position(0, 1000));
+
+    // an update only touches the one entry
+    storage.bytesWritten = 0;
+    table.Store(UID1, sizeof(UID1), Position(0, 2000));
+    EXPECT_EQ(storage.bytesWritten, sizeof(ResumeTable::Entry));
+
+    // an unchanged position is not written at all
+    storage.bytesWritten = 0;
+    table.Store(UID1, sizeof(UID1), Position(0, 2000));
+    EXPECT_EQ(storage.bytesWritten, 0u);
+}
+
+TEST(ResumeTableTest, overflowWithoutSpillFile) {
+    TestStorage storage(ResumeTable::StorageSize(2));
+    ResumeTable table(&storage, 2);
+    EXPECT_TRUE(table.Init());
+
+    table.Store(UID1, sizeof(UID1), Position(1, 100));
+    table.Store(UID2, sizeof(UID2), Position(2, 200));
+    ResumePosition pos;
+    // UID1 is the most recently used now
+    EXPECT_TRUE(table.Find(UID1, sizeof(UID1), pos));
+    table.Store(UID3, sizeof(UID3), Position(3, 300));
+
+    EXPECT_TRUE(table.Find(UID1, sizeof(UID1), pos));
+    EXPECT_FALSE(table.Find(UID2, sizeof(UID2), pos));
+    EXPECT_TRUE(table.Find(UID3, sizeof(UID3), pos));
+}
+
+TEST(ResumeTableTest, spillFile) {
+    static const char* spillPath = "./resume.dat";
+    std::remove(spillPath);
+    TestFile spillFile;
+    ASSERT_TRUE(spillFile.Create(spillPath));
+
+    TestStorage storage(ResumeTable::StorageSize(2));
+    ResumeTable table(&storage, 2);
+    EXPECT_TRUE(table.Init());
+    table.SetSpillFile(&spillFile);
+
+    table.Store(UID1, sizeof(UID1), Position(1, 100));
+    table.Store(UID2, sizeof(UID2), Position(2, 200));
+    // both older entries go to the SD card
+    table.Store(UID3, sizeof(UID3), Position(3, 300));
+    table.Store(UID4, sizeof(UID4), Position(4, 400));
+
+    // every card is still found and swapped back into the table
+    ResumePosition pos;
+    EXPECT_TRUE(table.Find(UID1, sizeof(UID1), pos));
+    EXPECT_EQ(pos.titleIndex, 1);
+    EXPECT_EQ(pos.offset, 100u);
+    EXPECT_TRUE(table.Find(UID2, sizeof(UID2), pos));
+    EXPECT_EQ(pos.titleIndex, 2);
+    EXPECT_TRUE(table.Find(UID3, sizeof(UID3), pos));
+    EXPECT_EQ(pos.titleIndex, 3);
+    EXPECT_TRUE(table.Find(UID4, sizeof(UID4), pos));
+    EXPECT_EQ(pos.titleIndex, 4);
+
+    // updating a spilled entry brings it back as well
+    table.Store(UID1, sizeof(UID1), Position(5, 500));
+    EXPECT_TRUE(table.Find(UID1, sizeof(UID1), pos));
+    EXPECT_EQ(pos.titleIndex, 5);
+
+    // swapping reuses the records, the file does not grow
+    spillFile.Seek(0);
+    uint8_t record[sizeof(ResumeTable::Entry)];
+    int records = 0;
+    while (spillFile.Read(record, sizeof(record)) == sizeof(record)) {
+        ++records;
+    }
+    EXPECT_EQ(records, 2);
+
+    spillFile.Close();
+    std::remove(spillPath);
+}
@@ -0,0 +1,133 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <stdint.h>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "ch.h"
+#include "qhal.h"
+}
+
+#include "common/ringbuffer.h"
+
+using tmb_musicplayer::RingBuffer;
+
+TEST(RingBufferTest, EmptyBuffer) {
+    RingBuffer<16> buffer;
+    uint32_t contiguous;
+
+    EXPECT_EQ(0u, buffer.Level());
+    EXPECT_EQ(16u, buffer.Free());
+    buffer.ReadPointer(contiguous);
+    EXPECT_EQ(0u, contiguous);
+    buffer.WritePointer(contiguous);
+    EXPECT_EQ(16u, contiguous);
+}
+
+TEST(RingBufferTest, LevelAccounting) {
+    RingBuffer<16> buffer;
+    uint32_t contiguous;
+
+    buffer.WritePointer(contiguous);
+    buffer.Commit(10);
+    EXPECT_EQ(10u, buffer.Level());
+    EXPECT_EQ(6u, buffer.Free());
+
+    buffer.Consume(4);
+    EXPECT_EQ(6u, buffer.Level());
+    EXPECT_EQ(10u, buffer.Free());
+
+    buffer.WritePointer(contiguous);
+    buffer.Commit(10);
+    EXPECT_EQ(16u, buffer.Level());
+    EXPECT_EQ(0u, buffer.Free());
+    buffer.WritePointer(contiguous);
+    EXPECT_EQ(0u, contiguous);
+
+    buffer.Reset();
+    EXPECT_EQ(0u, buffer.Level());
+    EXPECT_EQ(16u, buffer.Free());
+}
+
+TEST(RingBufferTest, ContiguousPartsStopAtTheEnd) {
+    RingBuffer<16> buffer;
+    uint32_t contiguous;
+
+    buffer.WritePointer(contiguous);
+    buffer.Commit(12);
+    buffer.Consume(8);
+
+    /* 4 bytes left until the end, 4 more in front of the read index.*/
+    uint8_t* dst = buffer.WritePointer(contiguous);
+    EXPECT_EQ(4u, contiguous);
+    buffer.Commit(contiguous);
+    uint8_t* wrapped = buffer.WritePointer(contiguous);
+    EXPECT_EQ(8u, contiguous);
+    EXPECT_EQ(dst - 12, wrapped);
+
+    const uint8_t* src = buffer.ReadPointer(contiguous);
+    EXPECT_EQ(8u, contiguous);
+    buffer.Consume(contiguous);
+    EXPECT_EQ(wrapped, buffer.ReadPointer(contiguous));
+    EXPECT_EQ(0u, contiguous);
+    EXPECT_EQ(src - 8, wrapped);
+}
+
+TEST(RingBufferTest, DataSurvivesWrapAround) {
+    RingBuffer<16> buffer;
+    uint8_t next = 0;
+    uint8_t expected = 0;
+
+    /* Odd sized chunks move the indices across the end many times.*/
+    for (int round = 0; round < 100; round++) {
+        uint32_t contiguous;
+        uint8_t* dst = buffer.WritePointer(contiguous);
+        uint32_t chunk = (contiguous < 7) ? contiguous : 7;
+        for (uint32_t i = 0; i < chunk; i++) {
+            dst[i] = next++;
+        }
+        buffer.Commit(chunk);
+
+        const uint8_t* src = buffer.ReadPointer(contiguous);
+        chunk = (contiguous < 5) ? contiguous : 5;
+        for (uint32_t i = 0; i < chunk; i++) {
+            ASSERT_EQ(expected++, src[i]);
+        }
+        buffer.Consume(chunk);
+        ASSERT_EQ((uint8_t)(next - expected), buffer.Level());
+    }
+}
+
+TEST(RingBufferTest, IndicesWrapAround) {
+    RingBuffer<16> buffer;
+    uint32_t contiguous;
+
+    /* The free running indices overflow after 4 GiB of stream data.*/
+    buffer.Commit(UINT32_MAX - 5);
+    buffer.Consume(UINT32_MAX - 5);
+    EXPECT_EQ(0u, buffer.Level());
+
+    buffer.Commit(10);
+    EXPECT_EQ(10u, buffer.Level());
+    EXPECT_EQ(6u, buffer.Free());
+    buffer.ReadPointer(contiguous);
+    EXPECT_EQ(6u, contiguous);
+    buffer.Consume(contiguous);
+    buffer.ReadPointer(contiguous);
+    EXPECT_EQ(4u, contiguous);
+    buffer.Consume(contiguous);
+    EXPECT_EQ(0u, buffer.Level());
+}
@@ -0,0 +1,96 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <atomic>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "ch.h"
+#include "qhal.h"
+}
+
+#include "common/snapshot.h"
+
+using tmb_musicplayer::Snapshot;
+
+/* Every field carries the same value, a torn read mixes two of them.*/
+struct Bands {
+    uint32_t values[15];
+    uint8_t count;
+};
+
+static Bands MakeBands(uint32_t value) {
+    Bands bands;
+    for (uint32_t i = 0; i < 15; i++) {
+        bands.values[i] = value;
+    }
+    bands.count = value & 0xFF;
+    return bands;
+}
+
+TEST(SnapshotTest, InitialValueIsZero) {
+    Snapshot<Bands> snapshot;
+    Bands bands = MakeBands(7);
+    snapshot.Read(bands);
+    EXPECT_EQ(0u, bands.values[0]);
+    EXPECT_EQ(0, bands.count);
+    EXPECT_EQ(0u, snapshot.Sequence());
+}
+
+TEST(SnapshotTest, ReadReturnsLastPublished) {
+    Snapshot<Bands> snapshot;
+    Bands bands;
+    for (uint32_t i = 1; i <= 3; i++) {
+        snapshot.Publish(MakeBands(i));
+        snapshot.Read(bands);
+        EXPECT_EQ(i, bands.values[14]);
+        EXPECT_EQ(i, snapshot.Sequence());
+    }
+}
+
+TEST(SnapshotTest, ConcurrentReadsAreNeverTorn) {
+    Snapshot<Bands> snapshot;
+    std::atomic<bool> done(false);
+    const uint32_t writes = 200000;
+
+    std::thread writer([&]() {
+        for (uint32_t i = 1; i <= writes; i++) {
+            snapshot.Publish(MakeBands(i));
+        }
+        done = true;
+    });
+
+    uint32_t reads = 0;
+    uint32_t last = 0;
+    while (done == false) {
+        Bands bands;
+        snapshot.Read(bands);
+        for (uint32_t i = 1; i < 15; i++) {
+            ASSERT_EQ(bands.values[0], bands.values[i]);
+        }
+        ASSERT_EQ(bands.values[0] & 0xFF, bands.count);
+        /* Values only move forward.*/
+        ASSERT_GE(bands.values[0], last);
+        last = bands.values[0];
+        reads++;
+    }
+    writer.join();
+
+    Bands bands;
+    snapshot.Read(bands);
+    EXPECT_EQ(writes, bands.values[0]);
+    EXPECT_GT(reads, 0u);
+}
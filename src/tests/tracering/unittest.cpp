@@ -0,0 +1,126 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "ch.h"
+#include "qhal.h"
+}
+
+#include "common/tracering.h"
+
+using tmb_musicplayer::TraceRecord;
+using tmb_musicplayer::TraceRing;
+
+TEST(TraceRingTest, EmptyRingReadsNothing) {
+    TraceRing<8> ring;
+    TraceRecord record;
+    EXPECT_FALSE(ring.Read(record));
+    EXPECT_EQ(0u, ring.Dropped());
+}
+
+TEST(TraceRingTest, ReadsInWriteOrder) {
+    TraceRing<8> ring;
+    for (uint32_t i = 0; i < 5; i++) {
+        EXPECT_TRUE(ring.Write(100 + i, i, i * 2, i * 3));
+    }
+    for (uint32_t i = 0; i < 5; i++) {
+        TraceRecord record;
+        ASSERT_TRUE(ring.Read(record));
+        EXPECT_EQ(100 + i, record.time);
+        EXPECT_EQ(i, record.event);
+        EXPECT_EQ(i * 2, record.arg0);
+        EXPECT_EQ(i * 3, record.arg1);
+    }
+    TraceRecord record;
+    EXPECT_FALSE(ring.Read(record));
+}
+
+TEST(TraceRingTest, FullRingDropsNewRecords) {
+    TraceRing<4> ring;
+    for (uint32_t i = 0; i < 6; i++) {
+        EXPECT_EQ(i < 4, ring.Write(0, i, 0, 0));
+    }
+    EXPECT_EQ(2u, ring.Dropped());
+
+    TraceRecord record;
+    ASSERT_TRUE(ring.Read(record));
+    EXPECT_EQ(0u, record.event);
+    /* The freed slot takes the next record.*/
+    EXPECT_TRUE(ring.Write(0, 9, 0, 0));
+    for (uint32_t expected : {1u, 2u, 3u, 9u}) {
+        ASSERT_TRUE(ring.Read(record));
+        EXPECT_EQ(expected, record.event);
+    }
+    EXPECT_FALSE(ring.Read(record));
+}
+
+TEST(TraceRingTest, WrapsAroundManyTimes) {
+    TraceRing<4> ring;
+    for (uint32_t i = 0; i < 1000; i++) {
+        ASSERT_TRUE(ring.Write(i, i, 0, 0));
+        TraceRecord record;
+        ASSERT_TRUE(ring.Read(record));
+        ASSERT_EQ(i, record.event);
+    }
+}
+
+TEST(TraceRingTest, ConcurrentWritersLoseNothingButDrops) {
+    TraceRing<64> ring;
+    const uint32_t writers = 4;
+    const uint32_t records = 50000;
+    std::atomic<uint32_t> finished(0);
+    std::vector<std::thread> threads;
+
+    for (uint32_t w = 0; w < writers; w++) {
+        threads.push_back(std::thread([&ring, &finished, w, records]() {
+            for (uint32_t i = 0; i < records; i++) {
+                /* Both arguments are derived from the event, a torn record does not match.*/
+                ring.Write(i, w, i, i ^ 0x5A5A5A5A);
+            }
+            finished++;
+        }));
+    }
+
+    std::vector<uint32_t> last(writers, 0);
+    std::vector<bool> seen(writers, false);
+    uint32_t read = 0;
+    while (true) {
+        bool done = (finished == writers);
+        TraceRecord record;
+        if (ring.Read(record)) {
+            ASSERT_LT(record.event, writers);
+            ASSERT_EQ(record.arg0 ^ 0x5A5A5A5A, record.arg1);
+            /* Records of one writer keep their order.*/
+            if (seen[record.event]) {
+                ASSERT_GT(record.arg0, last[record.event]);
+            }
+            seen[record.event] = true;
+            last[record.event] = record.arg0;
+            read++;
+        } else if (done) {
+            break;
+        }
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(writers * records, read + ring.Dropped());
+}
@@ -0,0 +1,75 @@
+/*
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include <cstdio>
+#include <string>
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "ch.h"
+#include "qhal.h"
+}
+
+#include "common/uidindex.h"
+
+TEST(UIDIndexTest, findDirectories) {
+    tmb_musicplayer::UIDIndex<8> index;
+    EXPECT_TRUE(index.Add("043DF3FA094081", "043DF3~1"));
+    EXPECT_TRUE(index.Add("04A1B2C3", "04A1B2C3"));
+    EXPECT_TRUE(index.Add("043df3fa094080", "043DF3~2"));
+    EXPECT_EQ(index.Count(), 3u);
+
+    EXPECT_STREQ(index.Find("043DF3FA094081"), "043DF3~1");
+    EXPECT_STREQ(index.Find("043DF3FA094080"), "043DF3~2");
+    // the case of the hex digits does not matter
+    EXPECT_STREQ(index.Find("04a1b2c3"), "04A1B2C3");
+    EXPECT_EQ(index.Find("043DF3FA094082"), nullptr);
+    // leading zeros are part of the UID
+    EXPECT_EQ(index.Find("0004A1B2C3"), nullptr);
+}
+
+TEST(UIDIndexTest, ignoreOtherNames) {
+    tmb_musicplayer::UIDIndex<8> index;
+    EXPECT_FALSE(index.Add("System Volume Information", "SYSTEM~1"));
+    EXPECT_FALSE(index.Add("ABC", "ABC"));
+    EXPECT_FALSE(index.Add("", ""));
+    EXPECT_FALSE(index.Add("0102030405060708090A0B", "0102~1"));
+    EXPECT_TRUE(index.Add("0102030405060708090A", "0102~1"));
+    EXPECT_FALSE(index.Add("0102030405060708090a", "0102~2"));
+    EXPECT_EQ(index.Count(), 1u);
+    EXPECT_TRUE(index.IsComplete());
+    EXPECT_EQ(index.Find("xyz"), nullptr);
+}
+
+TEST(UIDIndexTest, capacity) {
+    tmb_musicplayer::UIDIndex<64> index;
+    char name[16];
+    for (int i = 63; i >= 0; i--) {
+        snprintf(name, sizeof(name), "04%08X", i * 7919);
+        EXPECT_TRUE(index.Add(name, name + 2));
+    }
+    EXPECT_TRUE(index.IsComplete());
+    EXPECT_FALSE(index.Add("0401020304", "01020304"));
+    EXPECT_FALSE(index.IsComplete());
+
+    for (int i = 0; i < 64; i++) {
+        snprintf(name, sizeof(name), "04%08X", i * 7919);
+        EXPECT_STREQ(index.Find(name), name + 2);
+    }
+
+    index.Clear();
+    EXPECT_EQ(index.Count(), 0u);
+    EXPECT_TRUE(index.IsComplete());
+}